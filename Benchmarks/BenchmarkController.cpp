@@ -0,0 +1,114 @@
+// Copyright 2010-2015 Fabric Software Inc. All rights reserved.
+
+#include <FabricUI/Benchmarks/BenchmarkController.h>
+#include <FabricUI/GraphView/Graph.h>
+#include <FabricUI/GraphView/Node.h>
+#include <FabricUI/GraphView/BackDropNode.h>
+
+using namespace FabricUI;
+using namespace FabricUI::Benchmarks;
+
+BenchmarkController::BenchmarkController(GraphView::Graph * graph)
+  : GraphView::Controller(graph)
+{
+  resetCounters();
+}
+
+void BenchmarkController::resetCounters()
+{
+  m_moveCommandCount = 0;
+  m_removeCommandCount = 0;
+}
+
+bool BenchmarkController::gvcDoRemoveNodes(
+  FTL::ArrayRef<GraphView::Node *> nodes
+  )
+{
+  if(nodes.empty())
+    return false;
+
+  m_removeCommandCount++;
+
+  beginInteraction();
+  for(size_t i=0;i<nodes.size();i++)
+    graph()->removeNode(nodes[i]);
+  endInteraction();
+  return true;
+}
+
+bool BenchmarkController::gvcDoAddConnection(
+  GraphView::ConnectionTarget * src,
+  GraphView::ConnectionTarget * dst
+  )
+{
+  return graph()->addConnection(src, dst) != NULL;
+}
+
+bool BenchmarkController::gvcDoRemoveConnection(
+  GraphView::ConnectionTarget * src,
+  GraphView::ConnectionTarget * dst
+  )
+{
+  return graph()->removeConnection(src, dst);
+}
+
+bool BenchmarkController::gvcDoAddInstFromPreset(
+  FTL::CStrRef presetPath,
+  QPointF pos
+  )
+{
+  return false;
+}
+
+void BenchmarkController::gvcDoAddPort(
+  FTL::CStrRef desiredPortName,
+  GraphView::PortType portType,
+  FTL::CStrRef typeSpec,
+  GraphView::ConnectionTarget *connectWith,
+  FTL::StrRef extDep,
+  FTL::CStrRef metaData
+  )
+{
+}
+
+void BenchmarkController::gvcDoSetNodeCommentExpanded(
+  GraphView::Node *node,
+  bool expanded
+  )
+{
+}
+
+void BenchmarkController::gvcDoMoveNodes(
+  std::vector<GraphView::Node *> const &nodes,
+  QPointF delta,
+  bool allowUndo
+  )
+{
+  if(allowUndo)
+    m_moveCommandCount++;
+
+  for(size_t i=0;i<nodes.size();i++)
+  {
+    GraphView::Node * node = nodes[i];
+    node->setTopLeftGraphPos(node->topLeftGraphPos() + delta);
+  }
+}
+
+void BenchmarkController::gvcDoResizeBackDropNode(
+  GraphView::BackDropNode *backDropNode,
+  QPointF posDelta,
+  QSizeF sizeDelta,
+  bool allowUndo
+  )
+{
+}
+
+unsigned int BenchmarkController::persistCanvasState(
+  bool zoomChanged,
+  float zoom,
+  bool panChanged,
+  QPointF pan
+  )
+{
+  return (zoomChanged ? 1 : 0) + (panChanged ? 1 : 0);
+}
@@ -0,0 +1,97 @@
+// Copyright 2010-2015 Fabric Software Inc. All rights reserved.
+
+#ifndef __UI_Benchmarks_BenchmarkController__
+#define __UI_Benchmarks_BenchmarkController__
+
+#include <FabricUI/GraphView/Controller.h>
+
+namespace FabricUI
+{
+
+  namespace Benchmarks
+  {
+
+    // A GraphView::Controller without a Fabric Core binding.  Edits are
+    // applied to the graph directly, the way the DFG controller's
+    // notifications would apply them, and the undoable ones are counted
+    // in place of the commands the DFG controller would issue.
+    class BenchmarkController : public GraphView::Controller
+    {
+    public:
+
+      BenchmarkController(GraphView::Graph * graph);
+      virtual ~BenchmarkController() {}
+
+      virtual bool gvcDoRemoveNodes(
+        FTL::ArrayRef<GraphView::Node *> nodes
+        );
+
+      virtual bool gvcDoAddConnection(
+        GraphView::ConnectionTarget * src,
+        GraphView::ConnectionTarget * dst
+        );
+
+      virtual bool gvcDoRemoveConnection(
+        GraphView::ConnectionTarget * src,
+        GraphView::ConnectionTarget * dst
+        );
+
+      virtual bool gvcDoAddInstFromPreset(
+        FTL::CStrRef presetPath,
+        QPointF pos
+        );
+
+      virtual void gvcDoAddPort(
+        FTL::CStrRef desiredPortName,
+        GraphView::PortType portType,
+        FTL::CStrRef typeSpec = FTL::CStrRef(),
+        GraphView::ConnectionTarget *connectWith = 0,
+        FTL::StrRef extDep = FTL::StrRef(),
+        FTL::CStrRef metaData = FTL::CStrRef()
+        );
+
+      virtual void gvcDoSetNodeCommentExpanded(
+        GraphView::Node *node,
+        bool expanded
+        );
+
+      virtual void gvcDoMoveNodes(
+        std::vector<GraphView::Node *> const &nodes,
+        QPointF delta,
+        bool allowUndo
+        );
+
+      virtual void gvcDoResizeBackDropNode(
+        GraphView::BackDropNode *backDropNode,
+        QPointF posDelta,
+        QSizeF sizeDelta,
+        bool allowUndo
+        );
+
+      // the number of undoable edits since the last resetCounters
+      unsigned int moveCommandCount() const { return m_moveCommandCount; }
+      unsigned int removeCommandCount() const { return m_removeCommandCount; }
+      void resetCounters();
+
+    protected:
+
+      // counts one write per changed value, as the DFG controller writes
+      // one metadata entry each
+      virtual unsigned int persistCanvasState(
+        bool zoomChanged,
+        float zoom,
+        bool panChanged,
+        QPointF pan
+        );
+
+    private:
+
+      unsigned int m_moveCommandCount;
+      unsigned int m_removeCommandCount;
+    };
+
+  };
+
+};
+
+#endif // __UI_Benchmarks_BenchmarkController__
@@ -0,0 +1,881 @@
+// Copyright 2010-2015 Fabric Software Inc. All rights reserved.
+
+// Offscreen scale benchmark of the GraphView.
+//
+// Builds graphs of the requested sizes through a Core-free controller,
+// renders them into a QImage through QGraphicsScene::render and prints
+// the timings as JSON.  Pixmaps use the raster graphics system, so no GPU
+// is needed; Qt 4 still needs an X display for a QApplication, use
+// xvfb-run on headless machines.
+//
+// usage: GraphViewBenchmark [--nodes 1000,10000,50000] [--fan-in 2]
+//          [--fan-out 2] [--width 1280] [--height 800] [--frames 30]
+//          [--drag-nodes 1000] [--pan-events 500]
+//          [--adjacency-queries 1000]
+//          [--no-compare] [--notifications recording.txt]
+//          [--output results.json]
+
+#include <QtGui/QApplication>
+#include <QtGui/QImage>
+#include <QtGui/QPainter>
+#include <QtGui/QGraphicsSceneMouseEvent>
+
+#include <FabricUI/Benchmarks/BenchmarkController.h>
+#include <FabricUI/GraphView/Graph.h>
+#include <FabricUI/GraphView/GraphViewWidget.h>
+#include <FabricUI/GraphView/Node.h>
+#include <FabricUI/GraphView/Pin.h>
+#include <FabricUI/GraphView/Connection.h>
+#include <FabricUI/DFG/DFGNotificationDescTable.h>
+#include <FabricUI/DFG/DFGNotificationJSON.h>
+#include <FabricUI/DFG/DFGNotificationPlayer.h>
+#include <FabricUI/Util/Ticks.h>
+
+#include <FTL/JSONValue.h>
+#include <FTL/OwnedPtr.h>
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+using namespace FabricUI;
+using namespace FabricUI::Benchmarks;
+
+class BenchmarkOptions
+{
+public:
+
+  BenchmarkOptions()
+  {
+    nodeCounts.push_back(1000);
+    nodeCounts.push_back(10000);
+    nodeCounts.push_back(50000);
+    fanIn = 2;
+    fanOut = 2;
+    width = 1280;
+    height = 800;
+    frames = 30;
+    dragNodes = 1000;
+    panEvents = 500;
+    adjacencyQueries = 1000;
+    compare = true;
+  }
+
+  bool parse(int argc, char ** argv)
+  {
+    for(int i=1;i<argc;i++)
+    {
+      std::string arg = argv[i];
+      if(arg == "--no-compare")
+      {
+        compare = false;
+        continue;
+      }
+      if(i + 1 >= argc)
+      {
+        fprintf(stderr, "GraphViewBenchmark: missing value for '%s'\n", arg.c_str());
+        return false;
+      }
+      char const * value = argv[++i];
+      if(arg == "--nodes")
+      {
+        nodeCounts.clear();
+        for(char const * p = value; *p; )
+        {
+          char * end = NULL;
+          long count = strtol(p, &end, 10);
+          if(end == p || count <= 0)
+          {
+            fprintf(stderr, "GraphViewBenchmark: invalid node counts '%s'\n", value);
+            return false;
+          }
+          nodeCounts.push_back(size_t(count));
+          p = *end == ',' ? end + 1 : end;
+        }
+      }
+      else if(arg == "--fan-in")
+        fanIn = atoi(value);
+      else if(arg == "--fan-out")
+        fanOut = atoi(value);
+      else if(arg == "--width")
+        width = atoi(value);
+      else if(arg == "--height")
+        height = atoi(value);
+      else if(arg == "--frames")
+        frames = atoi(value);
+      else if(arg == "--drag-nodes")
+        dragNodes = size_t(atoi(value));
+      else if(arg == "--pan-events")
+        panEvents = atoi(value);
+      else if(arg == "--adjacency-queries")
+        adjacencyQueries = size_t(atoi(value));
+      else if(arg == "--notifications")
+        notificationsPath = value;
+      else if(arg == "--output")
+        outputPath = value;
+      else
+      {
+        fprintf(stderr, "GraphViewBenchmark: unknown option '%s'\n", arg.c_str());
+        return false;
+      }
+    }
+
+    if(fanIn < 0 || fanOut < 0 || width <= 0 || height <= 0 || frames <= 0 || panEvents <= 0)
+    {
+      fprintf(stderr, "GraphViewBenchmark: invalid options\n");
+      return false;
+    }
+    return true;
+  }
+
+  std::vector<size_t> nodeCounts;
+  int fanIn;
+  int fanOut;
+  int width;
+  int height;
+  int frames;
+  size_t dragNodes;
+  int panEvents;
+  size_t adjacencyQueries;
+  // also build every graph without a bulk build bracket
+  bool compare;
+  std::string notificationsPath;
+  std::string outputPath;
+};
+
+class BenchmarkClock
+{
+public:
+
+  BenchmarkClock()
+  {
+    restart();
+  }
+
+  void restart()
+  {
+    m_begin = Util::GetCurrentTicks();
+  }
+
+  double elapsedMS() const
+  {
+    return Util::GetSecondsBetweenTicks(m_begin, Util::GetCurrentTicks()) * 1e3;
+  }
+
+private:
+
+  uint64_t m_begin;
+};
+
+// a graph with its scene and (never shown) view
+class BenchmarkScene
+{
+public:
+
+  BenchmarkScene(BenchmarkOptions const & options)
+    : m_options(options)
+  {
+    GraphView::GraphConfig config;
+    config.useOpenGL = false;
+
+    m_graph = new GraphView::Graph(NULL, config);
+    m_controller = new BenchmarkController(m_graph);
+    m_graph->initialize();
+    m_view = new GraphView::GraphViewWidget(NULL, config, m_graph);
+
+    // the view is never shown, so it does not get resize events
+    m_view->setSceneRect(0, 0, options.width, options.height);
+    m_graph->setGeometry(0, 0, options.width, options.height);
+    m_graph->updateOverlays(options.width, options.height);
+
+    m_image = QImage(options.width, options.height, QImage::Format_ARGB32_Premultiplied);
+    m_connectionCount = 0;
+  }
+
+  ~BenchmarkScene()
+  {
+    QGraphicsScene * scene = m_view->scene();
+    delete m_view;
+    // the scene owns the graph
+    delete scene;
+    delete m_controller;
+  }
+
+  GraphView::Graph * graph() { return m_graph; }
+  BenchmarkController * controller() { return m_controller; }
+  size_t connectionCount() const { return m_connectionCount; }
+
+  // nodes are laid out on a square grid.  each node has fanIn input pins
+  // and one output, which feeds the inputs of the next fanOut nodes.
+  void populate(size_t nodeCount, bool bulk)
+  {
+    int fanIn = m_options.fanIn;
+    int fanOut = m_options.fanOut;
+    size_t columns = size_t(ceil(sqrt(double(nodeCount))));
+    QColor pinColor(249, 157, 28);
+
+    size_t connectionHint = nodeCount * size_t(fanIn < fanOut ? fanIn : fanOut);
+    GraphView::Graph::BulkBuildBracket bracket(
+      bulk ? m_graph : NULL, nodeCount, connectionHint
+      );
+
+    std::vector<GraphView::Pin *> outputs;
+    std::vector<GraphView::Pin *> inputs;
+    outputs.reserve(nodeCount);
+    inputs.reserve(nodeCount * size_t(fanIn));
+
+    char name[64];
+    for(size_t i=0;i<nodeCount;i++)
+    {
+      sprintf(name, "node%u", unsigned(i));
+      GraphView::Node * node = m_graph->addNode(name, name);
+      node->setTopLeftGraphPos(QPointF(double(i % columns) * 240.0, double(i / columns) * 160.0));
+
+      for(int j=0;j<fanIn;j++)
+      {
+        sprintf(name, "in%d", j);
+        inputs.push_back(node->addPin(new GraphView::Pin(node, name, GraphView::PortType_Input, pinColor)));
+      }
+      outputs.push_back(node->addPin(new GraphView::Pin(node, "out", GraphView::PortType_Output, pinColor)));
+    }
+
+    std::vector<int> usedInputs(nodeCount, 0);
+    for(size_t i=0;i<nodeCount;i++)
+    {
+      for(int k=1;k<=fanOut;k++)
+      {
+        size_t j = i + size_t(k);
+        if(j >= nodeCount)
+          break;
+        if(usedInputs[j] >= fanIn)
+          continue;
+        GraphView::Pin * input = inputs[j * size_t(fanIn) + size_t(usedInputs[j]++)];
+        if(m_graph->addConnection(outputs[i], input))
+          m_connectionCount++;
+      }
+    }
+  }
+
+  // delivers the posted events and runs the deferred passes (layouts,
+  // connection paths, virtualization)
+  void flush()
+  {
+    for(int i=0;i<2;i++)
+    {
+      QApplication::sendPostedEvents();
+      QApplication::processEvents();
+    }
+  }
+
+  void render()
+  {
+    m_image.fill(0);
+    QPainter painter(&m_image);
+    painter.setRenderHint(QPainter::Antialiasing);
+    painter.setRenderHint(QPainter::TextAntialiasing);
+    m_view->scene()->render(&painter, QRectF(m_image.rect()), QRectF(m_image.rect()));
+  }
+
+private:
+
+  BenchmarkOptions const & m_options;
+  GraphView::Graph * m_graph;
+  BenchmarkController * m_controller;
+  GraphView::GraphViewWidget * m_view;
+  QImage m_image;
+  size_t m_connectionCount;
+};
+
+class JSONWriter
+{
+public:
+
+  JSONWriter(FILE * file)
+  {
+    m_file = file;
+    m_first = true;
+    m_depth = 0;
+  }
+
+  void beginObject(char const * key = NULL)
+  {
+    writeKey(key);
+    fputc('{', m_file);
+    m_first = true;
+    m_depth++;
+  }
+
+  void endObject()
+  {
+    m_depth--;
+    newLine();
+    fputc('}', m_file);
+    m_first = false;
+  }
+
+  void beginArray(char const * key)
+  {
+    writeKey(key);
+    fputc('[', m_file);
+    m_first = true;
+    m_depth++;
+  }
+
+  void endArray()
+  {
+    m_depth--;
+    newLine();
+    fputc(']', m_file);
+    m_first = false;
+  }
+
+  void write(char const * key, double value)
+  {
+    writeKey(key);
+    fprintf(m_file, "%.4f", value);
+  }
+
+  void write(char const * key, size_t value)
+  {
+    writeKey(key);
+    fprintf(m_file, "%lu", (unsigned long)value);
+  }
+
+  void write(char const * key, char const * value)
+  {
+    writeKey(key);
+    fputc('"', m_file);
+    for(char const * p = value; *p; p++)
+    {
+      if(*p == '"' || *p == '\\')
+        fputc('\\', m_file);
+      fputc(*p, m_file);
+    }
+    fputc('"', m_file);
+  }
+
+  void finish()
+  {
+    fputc('\n', m_file);
+  }
+
+private:
+
+  void writeKey(char const * key)
+  {
+    if(!m_first)
+      fputc(',', m_file);
+    m_first = false;
+    if(m_depth > 0)
+      newLine();
+    if(key)
+      fprintf(m_file, "\"%s\": ", key);
+  }
+
+  void newLine()
+  {
+    fputc('\n', m_file);
+    for(int i=0;i<m_depth;i++)
+      fputs("  ", m_file);
+  }
+
+  FILE * m_file;
+  bool m_first;
+  int m_depth;
+};
+
+// construction and deletion one item at a time, the way graphs were
+// built before Graph::beginBulkBuild
+static void BenchmarkUnbracketedConstruction(
+  BenchmarkOptions const & options,
+  size_t nodeCount,
+  JSONWriter & json
+  )
+{
+  BenchmarkScene scene(options);
+  BenchmarkClock clock;
+  scene.populate(nodeCount, false);
+  scene.flush();
+  double constructMS = clock.elapsedMS();
+
+  // tearing the scene down is part of what a user waits for when
+  // navigating away from a large exec
+  clock.restart();
+  std::vector<GraphView::Node *> nodes = scene.graph()->nodes();
+  scene.controller()->gvcDoRemoveNodes(nodes);
+  scene.flush();
+
+  json.write("construct_unbracketed_ms", constructMS);
+  json.write("delete_unbracketed_ms", clock.elapsedMS());
+}
+
+static void BenchmarkGraph(
+  BenchmarkOptions const & options,
+  size_t nodeCount,
+  JSONWriter & json
+  )
+{
+  json.beginObject();
+  json.write("nodes", nodeCount);
+
+  if(options.compare)
+    BenchmarkUnbracketedConstruction(options, nodeCount, json);
+
+  BenchmarkScene scene(options);
+  GraphView::Graph * graph = scene.graph();
+  BenchmarkController * controller = scene.controller();
+  BenchmarkClock clock;
+
+  scene.populate(nodeCount, true);
+  scene.flush();
+  json.write("construct_ms", clock.elapsedMS());
+  json.write("connections", scene.connectionCount());
+
+  int frames = options.frames;
+
+  // the whole graph, fit to the view
+  controller->frameAllNodes();
+  scene.flush();
+  clock.restart();
+  for(int i=0;i<3;i++)
+    scene.render();
+  json.write("full_render_ms", clock.elapsedMS() / 3.0);
+  json.write("full_render_materialized_nodes", graph->materializedNodeCount());
+
+  // panning at zoom 1, one rendered frame per step
+  controller->zoomCanvas(1.0f);
+  controller->panCanvas(QPointF(0, 0));
+  scene.flush();
+  scene.render();
+  {
+    clock.restart();
+    QPointF pan(0, 0);
+    for(int i=0;i<frames;i++)
+    {
+      pan -= QPointF(40, 25);
+      controller->panCanvas(pan);
+      scene.flush();
+      scene.render();
+    }
+    double totalMS = clock.elapsedMS();
+    json.beginObject("pan");
+    json.write("frames", size_t(frames));
+    json.write("total_ms", totalMS);
+    json.write("frame_ms", totalMS / double(frames));
+    json.write("materialized_nodes", graph->materializedNodeCount());
+    json.endObject();
+  }
+
+  // zooming out to 1/20 and back in, one rendered frame per step
+  {
+    GraphView::NodePixmapCache & cache = graph->pixmapCache();
+    cache.resetCounters();
+    int steps = frames < 2 ? 2 : frames;
+    clock.restart();
+    for(int i=0;i<steps;i++)
+    {
+      // a triangle wave over the log of the zoom
+      float t = float(i) / float(steps - 1);
+      t = t < 0.5f ? t * 2.0f : 2.0f - t * 2.0f;
+      controller->zoomCanvas(powf(0.05f, t));
+      scene.flush();
+      scene.render();
+    }
+    double totalMS = clock.elapsedMS();
+    json.beginObject("zoom");
+    json.write("frames", size_t(steps));
+    json.write("total_ms", totalMS);
+    json.write("frame_ms", totalMS / double(steps));
+    json.write("cache_hits", cache.hits());
+    json.write("cache_misses", cache.misses());
+    json.write("cache_evictions", cache.evictions());
+    json.write("cache_bytes", cache.usedBytes());
+    json.endObject();
+  }
+
+  controller->zoomCanvas(1.0f);
+  controller->panCanvas(QPointF(0, 0));
+  scene.flush();
+
+  // selecting everything at once
+  controller->clearSelection();
+  scene.flush();
+  clock.restart();
+  graph->selectAllNodes();
+  scene.flush();
+  json.write("select_all_ms", clock.elapsedMS());
+
+  // dragging a block of selected nodes with the mouse, through the same
+  // press / move / release events the scene delivers
+  {
+    std::vector<GraphView::Node *> nodes = graph->nodes();
+    size_t dragCount = options.dragNodes < nodes.size() ? options.dragNodes : nodes.size();
+    nodes.resize(dragCount);
+    graph->setSelection(nodes);
+    scene.flush();
+
+    controller->resetCounters();
+    GraphView::Node * node = nodes.size() > 0 ? nodes[0] : NULL;
+    double totalMS = 0.0;
+    if(node)
+    {
+      clock.restart();
+      QPointF pos = node->mapToScene(node->boundingRect().center());
+
+      QGraphicsSceneMouseEvent press(QEvent::GraphicsSceneMousePress);
+      press.setButton(Qt::LeftButton);
+      press.setButtons(Qt::LeftButton);
+      press.setScenePos(pos);
+      press.setLastScenePos(pos);
+      node->mousePressEvent(&press);
+
+      for(int i=0;i<frames;i++)
+      {
+        QGraphicsSceneMouseEvent move(QEvent::GraphicsSceneMouseMove);
+        move.setButtons(Qt::LeftButton);
+        move.setLastScenePos(pos);
+        pos += QPointF(3, 2);
+        move.setScenePos(pos);
+        node->mouseMoveEvent(&move);
+        scene.flush();
+        scene.render();
+      }
+
+      QGraphicsSceneMouseEvent release(QEvent::GraphicsSceneMouseRelease);
+      release.setButton(Qt::LeftButton);
+      release.setScenePos(pos);
+      release.setLastScenePos(pos);
+      node->mouseReleaseEvent(&release);
+      scene.flush();
+      totalMS = clock.elapsedMS();
+    }
+    json.beginObject("drag_move");
+    json.write("nodes", dragCount);
+    json.write("frames", size_t(frames));
+    json.write("total_ms", totalMS);
+    json.write("frame_ms", totalMS / double(frames));
+    json.write("move_commands", size_t(controller->moveCommandCount()));
+    json.endObject();
+  }
+
+  // panning with alt + left drag on the main panel, the canvas state is
+  // expected to be written once, on release
+  {
+    GraphView::MainPanel * mainPanel = graph->mainPanel();
+    controller->flushCanvasState();
+    controller->resetCanvasCounters();
+    clock.restart();
+
+    QPointF pos = mainPanel->mapToScene(mainPanel->boundingRect().center());
+    QGraphicsSceneMouseEvent press(QEvent::GraphicsSceneMousePress);
+    press.setButton(Qt::LeftButton);
+    press.setButtons(Qt::LeftButton);
+    press.setModifiers(Qt::AltModifier);
+    press.setScenePos(pos);
+    press.setLastScenePos(pos);
+    mainPanel->mousePressEvent(&press);
+
+    for(int i=0;i<options.panEvents;i++)
+    {
+      QGraphicsSceneMouseEvent move(QEvent::GraphicsSceneMouseMove);
+      move.setButtons(Qt::LeftButton);
+      move.setModifiers(Qt::AltModifier);
+      move.setLastScenePos(pos);
+      pos += QPointF(i % 2 ? 1 : -1, 1);
+      move.setScenePos(pos);
+      mainPanel->mouseMoveEvent(&move);
+      scene.flush();
+    }
+    size_t writesDuringPan = controller->canvasWriteCount();
+
+    QGraphicsSceneMouseEvent release(QEvent::GraphicsSceneMouseRelease);
+    release.setButton(Qt::LeftButton);
+    release.setModifiers(Qt::AltModifier);
+    release.setScenePos(pos);
+    release.setLastScenePos(pos);
+    mainPanel->mouseReleaseEvent(&release);
+    scene.flush();
+    double totalMS = clock.elapsedMS();
+
+    json.beginObject("mouse_pan");
+    json.write("events", size_t(options.panEvents));
+    json.write("total_ms", totalMS);
+    json.write("canvas_changes", size_t(controller->canvasChangeCount()));
+    json.write("canvas_writes_during_pan", writesDuringPan);
+    json.write("canvas_writes", size_t(controller->canvasWriteCount()));
+    json.endObject();
+  }
+
+  // isConnected through the per target connection lists, against a scan
+  // of the graph's connection list as it was done before those lists
+  {
+    std::vector<GraphView::Node *> nodes = graph->nodes();
+    std::vector<GraphView::Pin *> pins;
+    for(size_t i=0;i<nodes.size() && pins.size() < options.adjacencyQueries;i++)
+    {
+      for(unsigned int j=0;j<nodes[i]->pinCount() && pins.size() < options.adjacencyQueries;j++)
+        pins.push_back(nodes[i]->pin(j));
+    }
+
+    size_t indexedHits = 0;
+    clock.restart();
+    for(size_t i=0;i<pins.size();i++)
+    {
+      if(graph->isConnected(pins[i]))
+        indexedHits++;
+    }
+    double indexedMS = clock.elapsedMS();
+
+    size_t linearHits = 0;
+    clock.restart();
+    std::vector<GraphView::Connection *> connections = graph->connections();
+    for(size_t i=0;i<pins.size();i++)
+    {
+      for(size_t j=0;j<connections.size();j++)
+      {
+        if(connections[j]->src() == pins[i] || connections[j]->dst() == pins[i])
+        {
+          linearHits++;
+          break;
+        }
+      }
+    }
+    double linearMS = clock.elapsedMS();
+
+    json.beginObject("adjacency");
+    json.write("queries", pins.size());
+    json.write("indexed_ms", indexedMS);
+    json.write("linear_ms", linearMS);
+    json.write("consistent", indexedHits == linearHits ? "yes" : "no");
+    json.endObject();
+  }
+
+  // deleting everything at once
+  {
+    graph->clearSelection();
+    std::vector<GraphView::Node *> nodes = graph->nodes();
+    clock.restart();
+    controller->gvcDoRemoveNodes(nodes);
+    scene.flush();
+    json.write("delete_ms", clock.elapsedMS());
+  }
+
+  json.endObject();
+}
+
+// the notification front end: a DOM decode of each recorded notification
+// (what the router did before DFGNotificationJSON) against the in place
+// scan.  the router itself needs a Core binding, so its handlers are not
+// part of this benchmark.
+// the descs handled by the router, in the order the string comparison
+// chain DFGNotificationRouter::callback used before its dispatch table
+static char const * const s_routerDescs[] =
+{
+  "nodeInserted",
+  "nodeRemoved",
+  "nodePortInserted",
+  "nodePortRemoved",
+  "execPortInserted",
+  "execPortRemoved",
+  "portsConnected",
+  "portsDisconnected",
+  "nodeMetadataChanged",
+  "instExecTitleChanged",
+  "nodeRenamed",
+  "execPortRenamed",
+  "nodePortRenamed",
+  "execMetadataChanged",
+  "extDepAdded",
+  "extDepRemoved",
+  "nodeCacheRuleChanged",
+  "execCacheRuleChanged",
+  "execPortResolvedTypeChanged",
+  "execPortTypeSpecChanged",
+  "nodePortResolvedTypeChanged",
+  "nodePortMetadataChanged",
+  "execPortMetadataChanged",
+  "execPortTypeChanged",
+  "nodePortTypeChanged",
+  "refVarPathChanged",
+  "funcCodeChanged",
+  "execTitleChanged",
+  "extDepsChanged",
+  "execPortDefaultValuesChanged",
+  "nodePortDefaultValuesChanged",
+  "removedFromOwner",
+  "execPortsReordered",
+  "nodePortsReordered",
+  "execDidAttachPreset",
+  "instExecDidAttachPreset",
+  "execWillDetachPreset",
+  "instExecWillDetachPreset",
+  "execEditWouldSplitFromPresetMayHaveChanged",
+  "instExecEditWouldSplitFromPresetMayHaveChanged"
+};
+static const size_t s_routerDescCount =
+  sizeof(s_routerDescs) / sizeof(s_routerDescs[0]);
+
+// the former dispatch: one comparison per desc until one matches
+static int FindDescByComparison(FTL::StrRef desc)
+{
+  for(size_t i=0;i<s_routerDescCount;i++)
+  {
+    if(desc == FTL::StrRef(s_routerDescs[i]))
+      return int(i);
+  }
+  return -1;
+}
+
+static void BenchmarkNotifications(
+  BenchmarkOptions const & options,
+  JSONWriter & json
+  )
+{
+  DFG::DFGNotificationPlayer player;
+  if(!player.load(options.notificationsPath.c_str()))
+    return;
+
+  std::vector<DFG::DFGNotificationPlayer::Notification> const & notifications =
+    player.notifications();
+
+  size_t domFailures = 0;
+  size_t descBytes = 0;
+  BenchmarkClock clock;
+  for(size_t i=0;i<notifications.size();i++)
+  {
+    try
+    {
+      FTL::StrRef jsonStr(notifications[i].json.data(), notifications[i].json.size());
+      FTL::JSONStrWithLoc jsonStrWithLoc(jsonStr);
+      FTL::OwnedPtr<FTL::JSONObject> jsonObject(
+        FTL::JSONValue::Decode(jsonStrWithLoc)->cast<FTL::JSONObject>()
+        );
+      descBytes += jsonObject->getString(FTL_STR("desc")).size();
+    }
+    catch(FTL::JSONException e)
+    {
+      domFailures++;
+    }
+  }
+  double domMS = clock.elapsedMS();
+
+  size_t scanFailures = 0;
+  clock.restart();
+  for(size_t i=0;i<notifications.size();i++)
+  {
+    try
+    {
+      FTL::StrRef jsonStr(notifications[i].json.data(), notifications[i].json.size());
+      DFG::DFGNotificationJSON notification(jsonStr);
+      descBytes += notification.getDesc().size();
+    }
+    catch(FTL::JSONException e)
+    {
+      scanFailures++;
+    }
+  }
+  double scanMS = clock.elapsedMS();
+
+  // finding the handler of each desc, through the comparison chain and
+  // through the router's table, over enough passes to be measurable
+  std::vector<std::string> descs;
+  for(size_t i=0;i<notifications.size();i++)
+  {
+    try
+    {
+      FTL::StrRef jsonStr(notifications[i].json.data(), notifications[i].json.size());
+      DFG::DFGNotificationJSON notification(jsonStr);
+      FTL::CStrRef desc = notification.getDesc();
+      descs.push_back(std::string(desc.data(), desc.size()));
+    }
+    catch(FTL::JSONException e)
+    {
+    }
+  }
+
+  DFG::DFGNotificationDescTable descTable;
+  for(size_t i=0;i<s_routerDescCount;i++)
+    descTable.insert(FTL::StrRef(s_routerDescs[i]));
+
+  const size_t dispatchPasses = 100;
+  size_t comparisonSum = 0;
+  clock.restart();
+  for(size_t pass=0;pass<dispatchPasses;pass++)
+  {
+    for(size_t i=0;i<descs.size();i++)
+      comparisonSum += size_t(FindDescByComparison(descs[i]) + 1);
+  }
+  double comparisonMS = clock.elapsedMS();
+
+  size_t tableSum = 0;
+  clock.restart();
+  for(size_t pass=0;pass<dispatchPasses;pass++)
+  {
+    for(size_t i=0;i<descs.size();i++)
+      tableSum += size_t(descTable.find(descs[i]) + 1);
+  }
+  double tableMS = clock.elapsedMS();
+
+  json.beginObject("notifications");
+  json.write("count", notifications.size());
+  json.write("dom_ms", domMS);
+  json.write("scan_ms", scanMS);
+  json.write("dom_failures", domFailures);
+  json.write("scan_failures", scanFailures);
+  json.write("dispatch_passes", dispatchPasses);
+  json.write("dispatch_comparison_ms", comparisonMS);
+  json.write("dispatch_table_ms", tableMS);
+  json.write("dispatch_consistent", comparisonSum == tableSum ? "yes" : "no");
+  // keeps the lookups from being optimized away
+  json.write("desc_bytes", descBytes);
+  json.endObject();
+}
+
+int main(int argc, char ** argv)
+{
+  BenchmarkOptions options;
+  if(!options.parse(argc, argv))
+    return 1;
+
+  // image backed pixmaps, the benchmark must not depend on a GPU
+  QApplication::setGraphicsSystem("raster");
+  QApplication app(argc, argv);
+
+  FILE * output = stdout;
+  if(options.outputPath.length() > 0)
+  {
+    output = fopen(options.outputPath.c_str(), "wb");
+    if(!output)
+    {
+      fprintf(stderr, "GraphViewBenchmark: unable to open '%s'\n", options.outputPath.c_str());
+      return 1;
+    }
+  }
+
+  JSONWriter json(output);
+  json.beginObject();
+  json.write("benchmark", "GraphView");
+  json.write("qt", qVersion());
+  json.write("fan_in", size_t(options.fanIn));
+  json.write("fan_out", size_t(options.fanOut));
+  json.write("width", size_t(options.width));
+  json.write("height", size_t(options.height));
+
+  json.beginArray("graphs");
+  for(size_t i=0;i<options.nodeCounts.size();i++)
+    BenchmarkGraph(options, options.nodeCounts[i], json);
+  json.endArray();
+
+  if(options.notificationsPath.length() > 0)
+    BenchmarkNotifications(options, json);
+
+  json.endObject();
+  json.finish();
+
+  if(output != stdout)
+    fclose(output);
+  return 0;
+}
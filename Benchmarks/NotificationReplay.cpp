@@ -0,0 +1,174 @@
+// Copyright 2010-2015 Fabric Software Inc. All rights reserved.
+
+// Replays a notification recording made with DFGNotificationRecorder
+// through a DFGNotificationRouter and prints the timings as JSON.
+//
+// The router's queries about the exec are answered from the recording,
+// so no binding or Core client is needed: each run builds the recorded
+// exec into an empty, never shown graph and applies the notifications
+// to it.  Qt 4 still needs an X display for a QApplication, use xvfb-run
+// on headless machines.
+//
+// usage: NotificationReplay recording.txt [--runs 5]
+//          [--output results.json]
+
+#include <QtGui/QApplication>
+
+#include <FabricUI/DFG/DFGConfig.h>
+#include <FabricUI/DFG/DFGController.h>
+#include <FabricUI/DFG/DFGNotificationPlayer.h>
+#include <FabricUI/DFG/DFGNotificationRouter.h>
+#include <FabricUI/GraphView/Graph.h>
+#include <FabricUI/GraphView/GraphViewWidget.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+#include <vector>
+
+using namespace FabricUI;
+
+class ReplayOptions
+{
+public:
+
+  ReplayOptions()
+  {
+    runs = 5;
+  }
+
+  bool parse(int argc, char ** argv)
+  {
+    for(int i=1;i<argc;i++)
+    {
+      std::string arg = argv[i];
+      if(arg.size() < 2 || arg[0] != '-' || arg[1] != '-')
+      {
+        if(recordingPath.length() > 0)
+          return usage();
+        recordingPath = arg;
+        continue;
+      }
+      if(i + 1 >= argc)
+        return usage();
+      std::string value = argv[++i];
+      if(arg == "--runs")
+        runs = atoi(value.c_str());
+      else if(arg == "--output")
+        outputPath = value;
+      else
+        return usage();
+    }
+    if(recordingPath.length() == 0 || runs <= 0)
+      return usage();
+    return true;
+  }
+
+  std::string recordingPath;
+  int runs;
+  std::string outputPath;
+
+private:
+
+  bool usage()
+  {
+    fprintf(stderr, "usage: NotificationReplay recording.txt [--runs 5] [--output results.json]\n");
+    return false;
+  }
+};
+
+// the state of the graph after a run, to check that all runs agree
+struct ReplayResult
+{
+  double seconds;
+  size_t nodeCount;
+  size_t connectionCount;
+};
+
+static ReplayResult Replay(DFG::DFGNotificationPlayer const & player)
+{
+  DFG::DFGConfig config;
+  config.graphConfig.useOpenGL = false;
+
+  // a controller without a binding or exec, the player answers for it
+  GraphView::Graph * graph = new GraphView::Graph(NULL, config.graphConfig);
+  FabricCore::Client client;
+  DFG::DFGController * controller =
+    new DFG::DFGController(graph, NULL, client, NULL, NULL, false);
+  graph->initialize();
+  // the canvas zoom is applied through the (never shown) view
+  GraphView::GraphViewWidget * view =
+    new GraphView::GraphViewWidget(NULL, config.graphConfig, graph);
+  DFG::DFGNotificationRouter * router =
+    new DFG::DFGNotificationRouter(controller, config);
+
+  ReplayResult result;
+  result.seconds = player.replay(router);
+  result.nodeCount = graph->nodes().size();
+  result.connectionCount = graph->connections().size();
+
+  delete router;
+  QGraphicsScene * scene = view->scene();
+  delete view;
+  // the scene owns the graph
+  delete scene;
+  delete controller;
+  return result;
+}
+
+int main(int argc, char ** argv)
+{
+  ReplayOptions options;
+  if(!options.parse(argc, argv))
+    return 1;
+
+  // image backed pixmaps, the replay must not depend on a GPU
+  QApplication::setGraphicsSystem("raster");
+  QApplication app(argc, argv);
+
+  DFG::DFGNotificationPlayer player;
+  if(!player.load(options.recordingPath.c_str()))
+    return 1;
+
+  std::vector<ReplayResult> results;
+  for(int i=0;i<options.runs;i++)
+    results.push_back(Replay(player));
+
+  bool consistent = true;
+  double minSeconds = results[0].seconds;
+  double totalSeconds = 0.0;
+  for(size_t i=0;i<results.size();i++)
+  {
+    if(results[i].nodeCount != results[0].nodeCount
+      || results[i].connectionCount != results[0].connectionCount)
+      consistent = false;
+    if(results[i].seconds < minSeconds)
+      minSeconds = results[i].seconds;
+    totalSeconds += results[i].seconds;
+  }
+
+  FILE * output = stdout;
+  if(options.outputPath.length() > 0)
+  {
+    output = fopen(options.outputPath.c_str(), "wb");
+    if(!output)
+    {
+      fprintf(stderr, "NotificationReplay: unable to open '%s'\n", options.outputPath.c_str());
+      return 1;
+    }
+  }
+
+  fprintf(output, "{\n");
+  fprintf(output, "  \"notifications\": %u,\n", unsigned(player.notifications().size()));
+  fprintf(output, "  \"runs\": %u,\n", unsigned(results.size()));
+  fprintf(output, "  \"min_ms\": %.3f,\n", minSeconds * 1000.0);
+  fprintf(output, "  \"mean_ms\": %.3f,\n", totalSeconds * 1000.0 / double(results.size()));
+  fprintf(output, "  \"nodes\": %u,\n", unsigned(results[0].nodeCount));
+  fprintf(output, "  \"connections\": %u,\n", unsigned(results[0].connectionCount));
+  fprintf(output, "  \"consistent\": \"%s\"\n", consistent ? "yes" : "no");
+  fprintf(output, "}\n");
+
+  if(output != stdout)
+    fclose(output);
+  return consistent ? 0 : 1;
+}
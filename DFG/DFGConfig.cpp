@@ -32,6 +32,8 @@ DFGConfig::DFGConfig()
   klEditorConfig.codeBackgroundColor = defaultFontColor;
   klEditorConfig.codeFontColor = defaultBackgroundColor;
 
+  asyncGraphBuildThreshold = 1024 * 1024;
+
   registerDataTypeColor("", QColor(40, 40, 40));
   registerDataTypeColor("Boolean", QColor(240, 78, 35));
   registerDataTypeColor("Scalar", QColor(128, 195, 66));
@@ -116,3 +118,12 @@ QColor DFGConfig::getColorForDataType(FTL::StrRef dataType, FabricCore::DFGExec
   }
   return QColor(0, 0, 0);
 }
+
+std::set<std::string> DFGConfig::getColorTypes() const
+{
+  std::set<std::string> colorTypes;
+  for(std::map<std::string, QColor>::const_iterator it = colorForDataType.begin();
+    it != colorForDataType.end(); it++)
+    colorTypes.insert(colorTypes.end(), it->first);
+  return colorTypes;
+}
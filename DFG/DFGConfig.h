@@ -8,6 +8,7 @@
 #include <QtGui/QTextCharFormat>
 #include <string>
 #include <map>
+#include <set>
 #include <FabricUI/KLEditor/EditorConfig.h>
 #include <FabricUI/GraphView/GraphConfig.h>
 #include <FTL/StrRef.h>
@@ -43,10 +44,16 @@ namespace FabricUI
       KLEditor::EditorConfig klEditorConfig;
       GraphView::GraphConfig graphConfig;
 
+      // exec descriptions of at least this many bytes are parsed on a
+      // worker thread when the exec is set, 0 to always parse inline
+      unsigned asyncGraphBuildThreshold;
+
       DFGConfig();
 
       void registerDataTypeColor(FTL::StrRef dataType, QColor color);
       QColor getColorForDataType(FTL::StrRef dataType, FabricCore::DFGExec * exec = NULL, char const * portName = NULL);
+      // the base types that have a color registered
+      std::set<std::string> getColorTypes() const;
     };
 
   };
@@ -3,6 +3,7 @@
 #include <iostream>
 #include <QtCore/QDebug>
 #include <QtCore/QRegExp>
+#include <QtCore/QTimer>
 #include <QtGui/QApplication>
 #include <QtGui/QClipboard>
 #include <QtGui/QGraphicsScene>
@@ -43,11 +44,15 @@ DFGController::DFGController(
   , m_logFunc(0)
   , m_overTakeBindingNotifications( overTakeBindingNotifications )
   , m_updateSignalBlockCount( 0 )
+  , m_notificationBracketCount( 0 )
+  , m_notificationRecorder( 0 )
   , m_varsChangedPending( false )
   , m_argsChangedPending( false )
   , m_argValuesChangedPending( false )
   , m_defaultValuesChangedPending( false )
   , m_dirtyPending( false )
+  , m_allErrorsDirty( true )
+  , m_errorUpdatePending( false )
 {
   m_router = NULL;
   m_logFunc = NULL;
@@ -84,6 +89,9 @@ void DFGController::setBindingExec(
 {
   m_binding = binding;
 
+  // later on, args are only rebound as their types change
+  bindUnboundRTVals();
+
   setExec( execPath, exec );
 
   emit bindingChanged( m_binding );
@@ -94,11 +102,21 @@ void DFGController::setExec(
   FabricCore::DFGExec &exec
   )
 {
+  // the pending canvas state belongs to the exec being left
+  if ( m_exec.isValid() )
+    flushCanvasState();
+
   m_execPath = execPath;
   m_exec = exec;
 
   m_presetDictsUpToDate = false;
 
+  m_execErrors.clear();
+  m_nodeErrors.clear();
+  m_dirtyErrorNodes.clear();
+  m_allErrorsDirty = true;
+  scheduleErrorUpdate();
+
   emit execChanged();
 }
 
@@ -192,6 +210,7 @@ void DFGController::cmdAddBackDrop(
     return;
 
   UpdateSignalBlocker blocker( this );
+  NotificationBracket bracket( this );
   
   m_cmdHandler->dfgDoAddBackDrop(
     getBinding(),
@@ -210,6 +229,7 @@ void DFGController::cmdSetTitle(
     return;
 
   UpdateSignalBlocker blocker( this );
+  NotificationBracket bracket( this );
   
   return m_cmdHandler->dfgDoSetTitle(
     getBinding(),
@@ -230,6 +250,7 @@ std::string DFGController::cmdEditNode(
     return oldName;
 
   UpdateSignalBlocker blocker( this );
+  NotificationBracket bracket( this );
   
   return m_cmdHandler->dfgDoEditNode(
     getBinding(),
@@ -251,6 +272,7 @@ void DFGController::cmdSetNodeComment(
     return;
 
   UpdateSignalBlocker blocker( this );
+  NotificationBracket bracket( this );
   
   m_cmdHandler->dfgDoSetNodeComment(
     getBinding(),
@@ -347,6 +369,7 @@ std::string DFGController::cmdRenameExecPort(
     return "";
 
   UpdateSignalBlocker blocker( this );
+  NotificationBracket bracket( this );
 
   std::string result = m_cmdHandler->dfgDoRenamePort(
     getBinding(),
@@ -412,6 +435,7 @@ void DFGController::cmdSetCode( FTL::CStrRef code )
     return;
 
   UpdateSignalBlocker blocker( this );
+  NotificationBracket bracket( this );
   
   m_cmdHandler->dfgDoSetCode(
     getBinding(),
@@ -482,6 +506,7 @@ void DFGController::cmdSetArgType(
     return;
 
   UpdateSignalBlocker blocker( this );
+  NotificationBracket bracket( this );
   
   m_cmdHandler->dfgDoSetArgType(
     getBinding(),
@@ -490,62 +515,61 @@ void DFGController::cmdSetArgType(
     );
 }
 
-bool DFGController::zoomCanvas(
-  float zoom
+unsigned int DFGController::persistCanvasState(
+  bool zoomChanged,
+  float zoom,
+  bool panChanged,
+  QPointF pan
   )
 {
+  unsigned int writeCount = 0;
   try
   {
     FabricCore::DFGExec &exec = getExec();
+    if ( !exec.isValid() )
+      return 0;
 
-    std::string json;
+    if ( zoomChanged )
     {
-      FTL::JSONEnc<> enc( json );
-      FTL::JSONObjectEnc<> objEnc( enc );
+      std::string json;
       {
-        FTL::JSONEnc<> zoomEnc( objEnc, FTL_STR("value") );
-        FTL::JSONFloat64Enc<> zoomS32Enc( zoomEnc, zoom );
+        FTL::JSONEnc<> enc( json );
+        FTL::JSONObjectEnc<> objEnc( enc );
+        {
+          FTL::JSONEnc<> zoomEnc( objEnc, FTL_STR("value") );
+          FTL::JSONFloat64Enc<> zoomS32Enc( zoomEnc, zoom );
+        }
       }
-    }
-
-    exec.setMetadata("uiGraphZoom", json.c_str(), false, false);
-  }
-  catch(FabricCore::Exception e)
-  {
-    logError(e.getDesc_cstr());
-    return false;
-  }
-  return true;
-}
 
-bool DFGController::panCanvas(QPointF pan)
-{
-  try
-  {
-    FabricCore::DFGExec &exec = getExec();
+      exec.setMetadata("uiGraphZoom", json.c_str(), false, false);
+      writeCount++;
+    }
 
-    std::string json;
+    if ( panChanged )
     {
-      FTL::JSONEnc<> enc( json );
-      FTL::JSONObjectEnc<> objEnc( enc );
+      std::string json;
       {
-        FTL::JSONEnc<> xEnc( objEnc, FTL_STR("x") );
-        FTL::JSONFloat64Enc<> xS32Enc( xEnc, pan.x() );
-      }
-      {
-        FTL::JSONEnc<> yEnc( objEnc, FTL_STR("y") );
-        FTL::JSONFloat64Enc<> yS32Enc( yEnc, pan.y() );
+        FTL::JSONEnc<> enc( json );
+        FTL::JSONObjectEnc<> objEnc( enc );
+        {
+          FTL::JSONEnc<> xEnc( objEnc, FTL_STR("x") );
+          FTL::JSONFloat64Enc<> xS32Enc( xEnc, pan.x() );
+        }
+        {
+          FTL::JSONEnc<> yEnc( objEnc, FTL_STR("y") );
+          FTL::JSONFloat64Enc<> yS32Enc( yEnc, pan.y() );
+        }
       }
-    }
 
-    exec.setMetadata("uiGraphPan", json.c_str(), false, false);
+      exec.setMetadata("uiGraphPan", json.c_str(), false, false);
+      writeCount++;
+    }
   }
   catch(FabricCore::Exception e)
   {
     logError(e.getDesc_cstr());
-    return false;
   }
-  return true;
+  return writeCount;
 }
 
 bool DFGController::relaxNodes(QStringList paths)
@@ -793,6 +817,7 @@ void DFGController::cmdPaste()
     return;
 
   UpdateSignalBlocker blocker( this );
+  NotificationBracket bracket( this );
   
   try
   {
@@ -808,11 +833,15 @@ void DFGController::cmdPaste()
       if (zoom != 0)  pos /= zoom;
 
       // paste.
-      std::vector<std::string> pastedNodes = m_cmdHandler->dfgDoPaste(getBinding(),
-                                                                      getExecPath(),
-                                                                      getExec(),
-                                                                      clipboard->text().toUtf8().constData(),
-                                                                      pos);
+      std::vector<std::string> pastedNodes;
+      {
+        NotificationBracket bracket( this );
+        pastedNodes = m_cmdHandler->dfgDoPaste(getBinding(),
+                                               getExecPath(),
+                                               getExec(),
+                                               clipboard->text().toUtf8().constData(),
+                                               pos);
+      }
 
       // clear the current selection.
       graph()->clearSelection();
@@ -885,58 +914,165 @@ bool DFGController::reloadExtensionDependencies(char const * path)
 
 void DFGController::checkErrors()
 {
+  m_allErrorsDirty = true;
+  updateErrors();
+}
+
+void DFGController::markNodeErrorsDirty( FTL::StrRef nodeName )
+{
+  if ( !m_allErrorsDirty )
+    m_dirtyErrorNodes.insert( nodeName );
+  scheduleErrorUpdate();
+}
+
+void DFGController::markExecErrorsDirty()
+{
+  scheduleErrorUpdate();
+}
+
+void DFGController::scheduleErrorUpdate()
+{
+  if ( m_errorUpdatePending )
+    return;
+  m_errorUpdatePending = true;
+  // inside a notification bracket the router flush updates the errors
+  if ( !isInNotificationBracket() )
+    QTimer::singleShot( 0, this, SLOT(updateErrors()) );
+}
+
+void DFGController::updateErrors()
+{
+  if ( !m_errorUpdatePending && !m_allErrorsDirty )
+    return;
+  m_errorUpdatePending = false;
+
+  if ( !m_exec )
+  {
+    m_dirtyErrorNodes.clear();
+    return;
+  }
+
+  std::vector<std::string> execErrors;
   unsigned errorCount = m_exec.getErrorCount();
   for(unsigned i=0;i<errorCount;i++)
+    execErrors.push_back( m_exec.getError(i) );
+  if ( execErrors != m_execErrors )
   {
-    std::string prefixedError = m_execPath;
-    prefixedError += " : ";
-    prefixedError += m_exec.getError(i);
-    logError( prefixedError.c_str() );
+    for ( size_t i = 0; i < execErrors.size(); ++i )
+    {
+      std::string prefixedError = m_execPath;
+      prefixedError += " : ";
+      prefixedError += execErrors[i];
+      logError( prefixedError.c_str() );
+    }
+    m_execErrors.swap( execErrors );
   }
 
   if(m_exec.getType() == FabricCore::DFGExecType_Graph)
   {
-    unsigned nodeCount = m_exec.getNodeCount();
-    for(size_t j=0;j<nodeCount;j++)
+    if ( m_allErrorsDirty )
     {
-      char const *nodeName = m_exec.getNodeName(j);
-
-      if ( !graph() )
-        continue;
-      GraphView::Node *uiNode = NULL;
-      if ( graph() )
+      // drop the errors of nodes that are gone
+      std::map<std::string, std::string> nodeErrors;
+      unsigned nodeCount = m_exec.getNodeCount();
+      for(unsigned j=0;j<nodeCount;j++)
       {
-        uiNode = graph()->nodeFromPath( nodeName );
-        if ( uiNode )
-          uiNode->clearError();
+        char const *nodeName = m_exec.getNodeName(j);
+        std::map<std::string, std::string>::iterator it =
+          m_nodeErrors.find( nodeName );
+        if ( it != m_nodeErrors.end() )
+          nodeErrors.insert( *it );
       }
+      m_nodeErrors.swap( nodeErrors );
 
-      if ( m_exec.getNodeType(j) == FabricCore::DFGNodeType_Inst )
-      {
-        FabricCore::DFGExec instExec = m_exec.getSubExec( nodeName );
+      for(unsigned j=0;j<nodeCount;j++)
+        updateNodeErrors( m_exec.getNodeName(j) );
+    }
+    else
+    {
+      std::set<std::string> dirtyErrorNodes;
+      dirtyErrorNodes.swap( m_dirtyErrorNodes );
+      for ( std::set<std::string>::const_iterator it =
+        dirtyErrorNodes.begin(); it != dirtyErrorNodes.end(); ++it )
+        updateNodeErrors( *it );
+    }
+  }
+
+  if ( m_allErrorsDirty )
+    upgradeBackDrops();
 
-        unsigned errorCount = instExec.getErrorCount();
-        if ( errorCount > 0 )
+  m_allErrorsDirty = false;
+  m_dirtyErrorNodes.clear();
+}
+
+void DFGController::updateNodeErrors( FTL::CStrRef nodeName )
+{
+  std::string errorComposed;
+  try
+  {
+    if ( m_exec.getNodeType( nodeName.c_str() ) == FabricCore::DFGNodeType_Inst )
+    {
+      FabricCore::DFGExec instExec = m_exec.getSubExec( nodeName.c_str() );
+
+      unsigned errorCount = instExec.getErrorCount();
+      if ( errorCount > 0 )
+      {
+        errorComposed += nodeName;
+        errorComposed += " : ";
+        for(unsigned i=0;i<errorCount;i++)
         {
-          std::string errorComposed;
-          errorComposed += nodeName;
-          errorComposed += " : ";
-          for(size_t i=0;i<errorCount;i++)
-          {
-            if(i > 0)
-              errorComposed += "\n";
-            errorComposed += instExec.getError(i);
-          }
-    
-          logError( errorComposed.c_str() );
-          if ( uiNode )
-            uiNode->setError(errorComposed.c_str());
+          if(i > 0)
+            errorComposed += "\n";
+          errorComposed += instExec.getError(i);
         }
-
       }
     }
   }
+  catch ( FabricCore::Exception e )
+  {
+    // the node was removed since it was marked dirty
+    m_nodeErrors.erase( nodeName );
+    return;
+  }
+
+  // the cache records what the node shows, so it is only written once
+  // the error has been applied to a built node; a node whose view is
+  // not built yet (eg. during an async graph build) is left uncached and
+  // picked up by the pass that follows the build
+  GraphView::Node *uiNode = NULL;
+  if ( graph() )
+  {
+    uiNode = graph()->nodeFromPath( nodeName );
+    if ( !uiNode )
+      return;
+  }
 
+  std::map<std::string, std::string>::iterator it =
+    m_nodeErrors.find( nodeName );
+  std::string const &previousError =
+    it != m_nodeErrors.end()? it->second: std::string();
+  if ( errorComposed == previousError )
+    return;
+
+  if ( !errorComposed.empty() )
+    logError( errorComposed.c_str() );
+
+  if ( uiNode )
+  {
+    if ( errorComposed.empty() )
+      uiNode->clearError();
+    else
+      uiNode->setError( errorComposed.c_str() );
+  }
+
+  if ( errorComposed.empty() )
+    m_nodeErrors.erase( nodeName );
+  else
+    m_nodeErrors[nodeName] = errorComposed;
+}
+
+void DFGController::upgradeBackDrops()
+{
   // [pzion 20150701] Upgrade old backdrops scheme
   static bool upgradingBackDrops = false;
   if ( !upgradingBackDrops )
@@ -1148,6 +1284,7 @@ bool DFGController::cmdSetDefaultValue(
     || !currentDefaultValue.isExEQTo( value ) )
   {
     UpdateSignalBlocker blocker( this );
+    NotificationBracket bracket( this );
     
     m_cmdHandler->dfgDoSetPortDefaultValue(
       binding,
@@ -1174,6 +1311,7 @@ void DFGController::cmdSetArgValue(
     || !currentValue.isExEQTo( value ) )
   {
     UpdateSignalBlocker blocker( this );
+    NotificationBracket bracket( this );
   
     m_cmdHandler->dfgDoSetArgValue(
       m_binding,
@@ -1198,6 +1336,7 @@ void DFGController::cmdSetRefVarPath(
   if ( currentVarPath != varPath )
   {
     UpdateSignalBlocker blocker( this );
+    NotificationBracket bracket( this );
     
     m_cmdHandler->dfgDoSetRefVarPath(
       binding,
@@ -1220,6 +1359,7 @@ void DFGController::cmdReorderPorts(
     return;
 
   UpdateSignalBlocker blocker( this );
+  NotificationBracket bracket( this );
   
   m_cmdHandler->dfgDoReorderPorts(
     binding,
@@ -1237,6 +1377,7 @@ void DFGController::cmdSetExtDeps(
     return;
 
   UpdateSignalBlocker blocker( this );
+  NotificationBracket bracket( this );
   
   m_cmdHandler->dfgDoSetExtDeps(
     getBinding(),
@@ -1249,6 +1390,7 @@ void DFGController::cmdSetExtDeps(
 void DFGController::cmdSplitFromPreset()
 {
   UpdateSignalBlocker blocker( this );
+  NotificationBracket bracket( this );
   
   m_cmdHandler->dfgDoSplitFromPreset(
     getBinding(),
@@ -1330,6 +1472,7 @@ void DFGController::onValueItemInteractionDelta( ValueEditor::ValueItem *valueIt
 void DFGController::onValueItemInteractionLeave( ValueEditor::ValueItem *valueItem )
 {
   UpdateSignalBlocker blocker( this );
+  NotificationBracket bracket( this );
 
   try
   {
@@ -1416,6 +1559,41 @@ bool DFGController::bindUnboundRTVals()
   return bindUnboundRTVals(m_client, m_binding);
 }
 
+// returns true if the arg was given a new default value; throws
+// FabricCore::Exception if the exec has no such port
+static bool BindUnboundRTVal(
+  FabricCore::Client &client,
+  FabricCore::DFGBinding &binding,
+  FabricCore::DFGExec &rootExec,
+  FTL::CStrRef argName
+  )
+{
+  FTL::CStrRef dataTypeToCheck =
+    rootExec.getExecPortResolvedType( argName.c_str() );
+  if ( dataTypeToCheck.empty() )
+    return false;
+
+  // if there is already a bound value, make sure it has the right type
+  FabricCore::RTVal value;
+  try
+  {
+    value = binding.getArgValue( argName.c_str() );
+  }
+  catch ( FabricCore::Exception e )
+  {
+    return false;
+  }
+  if ( !!value && value.hasType( dataTypeToCheck.c_str() ) )
+    return false;
+
+  binding.setArgValue(
+    argName.c_str(),
+    DFGCreateDefaultValue( client.getContext(), dataTypeToCheck ),
+    false
+    );
+  return true;
+}
+
 bool DFGController::bindUnboundRTVals(FabricCore::Client &client, FabricCore::DFGBinding &binding)
 {
   bool argsHaveChanged = false;
@@ -1425,30 +1603,10 @@ bool DFGController::bindUnboundRTVals(FabricCore::Client &client, FabricCore::DF
     unsigned argCount = rootExec.getExecPortCount();
     for ( unsigned i = 0; i < argCount; ++i )
     {
-      FTL::CStrRef dataTypeToCheck = rootExec.getExecPortResolvedType( i );
-      if ( dataTypeToCheck.empty() )
-        continue;
-
-      // if there is already a bound value, make sure it has the right type
-      FabricCore::RTVal value;
-      try
-      {
-        value = binding.getArgValue( i );
-      }
-      catch ( FabricCore::Exception e )
-      {
-        continue;
-      }
-      if ( !!value && value.hasType( dataTypeToCheck.c_str() ) )
-        continue;
-
-      binding.setArgValue(
-        i,
-        DFGCreateDefaultValue( client.getContext(), dataTypeToCheck ),
-        false
-        );
-
-      argsHaveChanged = true;
+      if ( BindUnboundRTVal(
+        client, binding, rootExec, rootExec.getExecPortName( i )
+        ) )
+        argsHaveChanged = true;
     }
   }
   catch ( FabricCore::Exception e )
@@ -1458,6 +1616,29 @@ bool DFGController::bindUnboundRTVals(FabricCore::Client &client, FabricCore::DF
   return argsHaveChanged;
 }
 
+bool DFGController::bindUnboundRTVal( FTL::CStrRef argName )
+{
+  return bindUnboundRTVal( m_client, m_binding, argName );
+}
+
+bool DFGController::bindUnboundRTVal(
+  FabricCore::Client &client,
+  FabricCore::DFGBinding &binding,
+  FTL::CStrRef argName
+  )
+{
+  try
+  {
+    FabricCore::DFGExec rootExec = binding.getExec();
+    return BindUnboundRTVal( client, binding, rootExec, argName );
+  }
+  catch ( FabricCore::Exception e )
+  {
+    // logError( e.getDesc_cstr() );
+  }
+  return false;
+}
+
 bool DFGController::canConnectTo(
   char const *pathA,
   char const *pathB,
@@ -1522,10 +1703,18 @@ void DFGController::bindingNotificationCallback( FTL::CStrRef jsonStr )
       emitDirty();
     }
     else if ( descStr == FTL_STR("argTypeChanged")
-      || descStr == FTL_STR("argInserted")
-      || descStr == FTL_STR("argRemoved") )
+      || descStr == FTL_STR("argInserted") )
+    {
+      // only the arg named by the notification can need a new value
+      FTL::CStrRef argName;
+      if ( jsonObject->maybeGetString( FTL_STR("name"), argName ) )
+        bindUnboundRTVal( argName );
+      else
+        bindUnboundRTVals();
+      emitArgsChanged();
+    }
+    else if ( descStr == FTL_STR("argRemoved") )
     {
-      bindUnboundRTVals();
       emitArgsChanged();
     }
     else if ( descStr == FTL_STR("argChanged") )
@@ -1777,6 +1966,7 @@ void DFGController::cmdRemoveNodes(
     return;
 
   UpdateSignalBlocker blocker( this );
+  NotificationBracket bracket( this );
   
   m_cmdHandler->dfgDoRemoveNodes(
     getBinding(),
@@ -1795,6 +1985,7 @@ void DFGController::cmdConnect(
     return;
 
   UpdateSignalBlocker blocker( this );
+  NotificationBracket bracket( this );
   
   m_cmdHandler->dfgDoConnect(
     getBinding(),
@@ -1814,6 +2005,7 @@ void DFGController::cmdDisconnect(
     return;
 
   UpdateSignalBlocker blocker( this );
+  NotificationBracket bracket( this );
   
   m_cmdHandler->dfgDoDisconnect(
     getBinding(),
@@ -1833,6 +2025,7 @@ std::string DFGController::cmdAddInstWithEmptyGraph(
     return "";
 
   UpdateSignalBlocker blocker( this );
+  NotificationBracket bracket( this );
   return m_cmdHandler->dfgDoAddGraph(
     getBinding(),
     getExecPath(),
@@ -1852,6 +2045,7 @@ std::string DFGController::cmdAddInstWithEmptyFunc(
     return "";
 
   UpdateSignalBlocker blocker( this );
+  NotificationBracket bracket( this );
   return m_cmdHandler->dfgDoAddFunc(
     getBinding(),
     getExecPath(),
@@ -1871,6 +2065,7 @@ std::string DFGController::cmdAddInstFromPreset(
     return "";
 
   UpdateSignalBlocker blocker( this );
+  NotificationBracket bracket( this );
   return m_cmdHandler->dfgDoInstPreset(
     getBinding(),
     getExecPath(),
@@ -1891,6 +2086,7 @@ std::string DFGController::cmdAddVar(
     return "";
 
   UpdateSignalBlocker blocker( this );
+  NotificationBracket bracket( this );
   return m_cmdHandler->dfgDoAddVar(
     getBinding(),
     getExecPath(),
@@ -1912,6 +2108,7 @@ std::string DFGController::cmdAddGet(
     return "";
 
   UpdateSignalBlocker blocker( this );
+  NotificationBracket bracket( this );
   return m_cmdHandler->dfgDoAddGet(
     getBinding(),
     getExecPath(),
@@ -1932,6 +2129,7 @@ std::string DFGController::cmdAddSet(
     return "";
 
   UpdateSignalBlocker blocker( this );
+  NotificationBracket bracket( this );
   
   return m_cmdHandler->dfgDoAddSet(
     getBinding(),
@@ -1956,6 +2154,7 @@ std::string DFGController::cmdAddPort(
     return "";
 
   UpdateSignalBlocker blocker( this );
+  NotificationBracket bracket( this );
   
   return m_cmdHandler->dfgDoAddPort(
     getBinding(),
@@ -1982,6 +2181,7 @@ std::string DFGController::cmdEditPort(
     return "";
 
   UpdateSignalBlocker blocker( this );
+  NotificationBracket bracket( this );
   
   return m_cmdHandler->dfgDoEditPort(
     getBinding(),
@@ -2003,6 +2203,7 @@ void DFGController::cmdRemovePort(
     return;
 
   UpdateSignalBlocker blocker( this );
+  NotificationBracket bracket( this );
   
   m_cmdHandler->dfgDoRemovePort(
     getBinding(),
@@ -2018,6 +2219,7 @@ void DFGController::cmdMoveNodes(
   )
 {
   UpdateSignalBlocker blocker( this );
+  NotificationBracket bracket( this );
   
   m_cmdHandler->dfgDoMoveNodes(
     getBinding(),
@@ -2035,6 +2237,7 @@ void DFGController::cmdResizeBackDropNode(
   )
 {
   UpdateSignalBlocker blocker( this );
+  NotificationBracket bracket( this );
   
   m_cmdHandler->dfgDoResizeBackDrop(
     getBinding(),
@@ -2055,6 +2258,7 @@ std::string DFGController::cmdImplodeNodes(
     return "";
 
   UpdateSignalBlocker blocker( this );
+  NotificationBracket bracket( this );
 
   return m_cmdHandler->dfgDoImplodeNodes(
     getBinding(),
@@ -2073,6 +2277,7 @@ std::vector<std::string> DFGController::cmdExplodeNode(
     return std::vector<std::string>();
 
   UpdateSignalBlocker blocker( this );
+  NotificationBracket bracket( this );
   
   return m_cmdHandler->dfgDoExplodeNode(
     getBinding(),
@@ -2102,39 +2307,21 @@ void DFGController::gvcDoMoveNodes(
       newTopLeftPoss.push_back( node->topLeftGraphPos() + delta );
     }
 
+    // show the new positions right away; the uiGraphPos notifications
+    // the command echoes back then find the nodes in place
+    for ( size_t i = 0; i < nodes.size(); ++i )
+      nodes[i]->setTopLeftGraphPos( newTopLeftPoss[i] );
+
     cmdMoveNodes( nodeNames, newTopLeftPoss );
   }
   else
   {
+    // previews stay in the view, the exec only sees the final move
     for ( std::vector<GraphView::Node *>::const_iterator it = nodes.begin();
       it != nodes.end(); ++it )
     {
       GraphView::Node *node = *it;
-      FTL::CStrRef nodeName = node->name();
-
-      QPointF newPos = node->topLeftGraphPos() + delta;
-
-      std::string newPosJSON;
-      {
-        FTL::JSONEnc<> enc( newPosJSON );
-        FTL::JSONObjectEnc<> objEnc( enc );
-        {
-          FTL::JSONEnc<> xEnc( objEnc, FTL_STR("x") );
-          FTL::JSONFloat64Enc<> xS32Enc( xEnc, newPos.x() );
-        }
-        {
-          FTL::JSONEnc<> yEnc( objEnc, FTL_STR("y") );
-          FTL::JSONFloat64Enc<> yS32Enc( yEnc, newPos.y() );
-        }
-      }
-
-      getExec().setNodeMetadata(
-        nodeName.c_str(),
-        "uiGraphPos",
-        newPosJSON.c_str(),
-        false,
-        false
-        );
+      node->setTopLeftGraphPos( node->topLeftGraphPos() + delta );
     }
   }
 }
@@ -2218,15 +2405,44 @@ void DFGController::setBlockCompilations( bool blockCompilations )
   }
 }
 
+void DFGController::beginNotificationBracket()
+{
+  ++m_notificationBracketCount;
+}
+
+void DFGController::endNotificationBracket()
+{
+  assert( m_notificationBracketCount > 0 );
+  if ( --m_notificationBracketCount > 0 )
+    return;
+  if ( m_router )
+    m_router->flushNotifications();
+  if ( m_errorUpdatePending )
+    updateErrors();
+}
+
 void DFGController::emitNodeRenamed(
   FTL::CStrRef oldNodeName,
   FTL::CStrRef newNodeName
   )
 {
+  std::map<std::string, std::string>::iterator it =
+    m_nodeErrors.find( oldNodeName );
+  if ( it != m_nodeErrors.end() )
+  {
+    m_nodeErrors[newNodeName] = it->second;
+    m_nodeErrors.erase( it );
+  }
+  if ( m_dirtyErrorNodes.erase( oldNodeName ) > 0 )
+    m_dirtyErrorNodes.insert( newNodeName );
+
   emit nodeRenamed( m_execPath, oldNodeName, newNodeName );
 }
 
 void DFGController::emitNodeRemoved( FTL::CStrRef nodeName )
 {
+  m_nodeErrors.erase( nodeName );
+  m_dirtyErrorNodes.erase( nodeName );
+
   emit nodeRemoved( m_execPath, nodeName );
 }
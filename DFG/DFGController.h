@@ -11,7 +11,10 @@
 #include <FabricUI/GraphView/Port.h>
 #include <FabricUI/GraphView/BackDropNode.h>
 #include <FabricUI/ValueEditor/ValueItem.h>
+#include <FabricUI/DFG/DFGNotificationProfiler.h>
 #include <SplitSearch/SplitSearch.hpp>
+#include <map>
+#include <set>
 #include <vector>
 #include <ASTWrapper/KLASTManager.h>
 
@@ -25,6 +28,7 @@ namespace FabricUI
 
     class DFGUICmdHandler;
     class DFGNotificationRouter;
+    class DFGNotificationRecorder;
     class DFGWidget;
 
     class DFGController : public GraphView::Controller
@@ -311,8 +315,6 @@ namespace FabricUI
 
       virtual std::string reloadCode();
 
-      virtual bool zoomCanvas(float zoom);
-      virtual bool panCanvas(QPointF pan);
       virtual bool relaxNodes(QStringList paths = QStringList());
       virtual bool setNodeColor(const char * nodeName, const char * key, QColor color);
       /// Sets the collapse state of the selected node.
@@ -332,6 +334,13 @@ namespace FabricUI
 
       bool bindUnboundRTVals();
       static bool bindUnboundRTVals(FabricCore::Client &client, FabricCore::DFGBinding &binding);
+      // same as bindUnboundRTVals for a single arg of the binding
+      bool bindUnboundRTVal( FTL::CStrRef argName );
+      static bool bindUnboundRTVal(
+        FabricCore::Client &client,
+        FabricCore::DFGBinding &binding,
+        FTL::CStrRef argName
+        );
 
       virtual bool canConnectTo(
         char const *pathA,
@@ -439,6 +448,56 @@ namespace FabricUI
         DFGController *m_controller;
       };
 
+      // Core notifications received while a bracket is open are queued
+      // by the router and applied in a single pass when it closes.  every
+      // cmd* entry point opens one, so the graph is up to date when it
+      // returns; outside of brackets the router coalesces per event loop
+      // tick instead.
+      class NotificationBracket
+      {
+      public:
+
+        NotificationBracket( DFGController *controller )
+          : m_controller( controller )
+        {
+          m_controller->beginNotificationBracket();
+        }
+
+        ~NotificationBracket()
+        {
+          m_controller->endNotificationBracket();
+        }
+
+      private:
+
+        DFGController *m_controller;
+      };
+
+      void beginNotificationBracket();
+      void endNotificationBracket();
+      bool isInNotificationBracket() const
+        { return m_notificationBracketCount > 0; }
+
+      // When set, every notification received by the router is written
+      // to the recorder.  It is kept here rather than on the router so
+      // that a recording spans exec changes; the controller does not
+      // take ownership.
+      void setNotificationRecorder( DFGNotificationRecorder *recorder )
+        { m_notificationRecorder = recorder; }
+      DFGNotificationRecorder *notificationRecorder() const
+        { return m_notificationRecorder; }
+
+      // Latency histograms of the notifications handled by the router,
+      // disabled by default; see DFGNotificationProfiler.
+      DFGNotificationProfiler &notificationProfiler()
+        { return m_notificationProfiler; }
+
+      // Errors are tracked per node: notifications mark the nodes they
+      // touch as dirty and a single deferred updateErrors() pass
+      // re-queries only those.  Errors are logged when they change.
+      void markNodeErrorsDirty( FTL::StrRef nodeName );
+      void markExecErrorsDirty();
+
       void emitNodeRenamed(
         FTL::CStrRef oldNodeName,
         FTL::CStrRef newNodeName
@@ -478,10 +537,23 @@ namespace FabricUI
       void onValueItemInteractionDelta( ValueItem *valueItem );
       void onValueItemInteractionLeave( ValueItem *valueItem );
 
+      // re-queries the errors of every node
       void checkErrors();
+      // re-queries the errors of the exec and of the dirty nodes
+      void updateErrors();
       void onVariablesChanged();
       virtual void onNodeHeaderButtonTriggered(FabricUI::GraphView::NodeHeaderButton * button);
 
+    protected:
+
+      // writes the exec's uiGraphZoom / uiGraphPan metadata
+      virtual unsigned int persistCanvasState(
+        bool zoomChanged,
+        float zoom,
+        bool panChanged,
+        QPointF pan
+        );
+
     private:
 
       void bindingNotificationCallback( FTL::CStrRef jsonStr );
@@ -498,6 +570,10 @@ namespace FabricUI
 
       void updatePresetPathDB();
 
+      void scheduleErrorUpdate();
+      void updateNodeErrors( FTL::CStrRef nodeName );
+      void upgradeBackDrops();
+
       DFGWidget *m_dfgWidget;
       FabricCore::Client m_client;
       FabricCore::DFGHost m_host;
@@ -516,11 +592,20 @@ namespace FabricUI
       bool m_presetDictsUpToDate;
 
       uint32_t m_updateSignalBlockCount;
+      uint32_t m_notificationBracketCount;
+      DFGNotificationRecorder *m_notificationRecorder;
+      DFGNotificationProfiler m_notificationProfiler;
       bool m_varsChangedPending;
       bool m_argsChangedPending;
       bool m_argValuesChangedPending;
       bool m_defaultValuesChangedPending;
       bool m_dirtyPending;
+
+      std::vector<std::string> m_execErrors;
+      std::map<std::string, std::string> m_nodeErrors;
+      std::set<std::string> m_dirtyErrorNodes;
+      bool m_allErrorsDirty;
+      bool m_errorUpdatePending;
     };
 
   };
@@ -0,0 +1,430 @@
+// Copyright 2010-2015 Fabric Software Inc. All rights reserved.
+
+#include <FabricUI/DFG/DFGExecBuildPlan.h>
+#include <CodeCompletion/KLTypeDesc.h>
+#include <FTL/OwnedPtr.h>
+
+#include <stdio.h>
+
+using namespace FabricServices;
+using namespace FabricUI;
+using namespace FabricUI::DFG;
+
+static void Assign( std::string &str, FTL::StrRef strRef )
+{
+  str.assign( strRef.data(), strRef.size() );
+}
+
+FabricCore::DFGExecType DFGExecBuildCoreSource::getExecType()
+{
+  return m_exec.getType();
+}
+
+FabricCore::DFGNodeType DFGExecBuildCoreSource::getNodeType(
+  FTL::CStrRef nodeName
+  )
+{
+  return m_exec.getNodeType( nodeName.c_str() );
+}
+
+bool DFGExecBuildCoreSource::instExecIsPreset( FTL::CStrRef nodeName )
+{
+  return m_exec.instExecIsPreset( nodeName.c_str() );
+}
+
+std::string DFGExecBuildCoreSource::getRefVarPath( FTL::CStrRef nodeName )
+{
+  return m_exec.getRefVarPath( nodeName.c_str() );
+}
+
+std::string DFGExecBuildCoreSource::getNodeMetadata(
+  FTL::CStrRef nodeName,
+  FTL::CStrRef key
+  )
+{
+  return m_exec.getNodeMetadata( nodeName.c_str(), key.c_str() );
+}
+
+std::string DFGExecBuildCoreSource::getInstExecMetadata(
+  FTL::CStrRef nodeName,
+  FTL::CStrRef key
+  )
+{
+  return getSubExec( nodeName ).getMetadata( key.c_str() );
+}
+
+std::string DFGExecBuildCoreSource::getInstExecPortMetadata(
+  FTL::CStrRef nodeName,
+  FTL::CStrRef portName,
+  FTL::CStrRef key
+  )
+{
+  return getSubExec( nodeName ).getExecPortMetadata(
+    portName.c_str(),
+    key.c_str()
+    );
+}
+
+std::string DFGExecBuildCoreSource::getExecPortMetadata(
+  FTL::CStrRef portName,
+  FTL::CStrRef key
+  )
+{
+  return m_exec.getExecPortMetadata( portName.c_str(), key.c_str() );
+}
+
+std::string DFGExecBuildCoreSource::getInstExecTitle( FTL::CStrRef nodeName )
+{
+  return getSubExec( nodeName ).getTitle();
+}
+
+unsigned DFGExecBuildCoreSource::getExecPortCount()
+{
+  return m_exec.getExecPortCount();
+}
+
+std::string DFGExecBuildCoreSource::getExecPortName( unsigned index )
+{
+  return m_exec.getExecPortName( index );
+}
+
+FabricCore::DFGPortType DFGExecBuildCoreSource::getExecPortType(
+  unsigned index
+  )
+{
+  return m_exec.getExecPortType( index );
+}
+
+unsigned DFGExecBuildCoreSource::getInstExecPortCount(
+  FTL::CStrRef nodeName
+  )
+{
+  return getSubExec( nodeName ).getExecPortCount();
+}
+
+std::string DFGExecBuildCoreSource::getInstExecPortName(
+  FTL::CStrRef nodeName,
+  unsigned index
+  )
+{
+  return getSubExec( nodeName ).getExecPortName( index );
+}
+
+FabricCore::DFGExec &DFGExecBuildCoreSource::getSubExec(
+  FTL::CStrRef nodeName
+  )
+{
+  if ( !m_subExec
+    || FTL::StrRef( m_subExecNodeName.data(), m_subExecNodeName.size() )
+      != nodeName )
+  {
+    m_subExec = m_exec.getSubExec( nodeName.c_str() );
+    m_subExecNodeName.assign( nodeName.data(), nodeName.size() );
+  }
+  return m_subExec;
+}
+
+DFGExecBuildPlan::DFGExecBuildPlan()
+  : m_isGraph( false )
+{
+}
+
+QSharedPointer<DFGExecBuildPlan> DFGExecBuildPlan::Build(
+  QSharedPointer<DFGExecBuildSource> source,
+  std::string desc,
+  std::set<std::string> colorTypes,
+  DFGExecBuildToken token
+  )
+{
+  QSharedPointer<DFGExecBuildPlan> plan( new DFGExecBuildPlan );
+  try
+  {
+    if ( !plan->resolve( *source, desc, colorTypes, token ) )
+      return QSharedPointer<DFGExecBuildPlan>();
+  }
+  catch ( FTL::JSONException je )
+  {
+    printf( "Caught JSONException: %s\n", je.getDescCStr() );
+    return QSharedPointer<DFGExecBuildPlan>();
+  }
+  catch ( FabricCore::Exception e )
+  {
+    // the exec changed under the plan, the caller starts over
+    printf(
+      "DFGExecBuildPlan::Build: caught Core exception: %s\n",
+      e.getDesc_cstr()
+      );
+    return QSharedPointer<DFGExecBuildPlan>();
+  }
+  return plan;
+}
+
+bool DFGExecBuildPlan::NeedsUIColor(
+  FTL::CStrRef dataType,
+  std::set<std::string> const &colorTypes
+  )
+{
+  if ( dataType.empty() || dataType.data()[0] == '$' )
+    return false;
+  std::string baseType =
+    CodeCompletion::KLTypeDesc( dataType ).getBaseType();
+  return colorTypes.find( baseType ) == colorTypes.end();
+}
+
+void DFGExecBuildPlan::ResolveExecPort(
+  DFGExecBuildSource &source,
+  FTL::CStrRef portName,
+  FTL::JSONObject const *portObject,
+  std::set<std::string> const &colorTypes,
+  Port &port
+  )
+{
+  FTL::CStrRef dataType = portObject->getStringOrEmpty( FTL_STR("type") );
+  Assign( port.name, portName );
+  Assign( port.dataType, dataType );
+  Assign(
+    port.portType,
+    portObject->getStringOrEmpty( FTL_STR("execPortType") )
+    );
+  if ( NeedsUIColor( dataType, colorTypes ) )
+    port.uiColor = source.getExecPortMetadata( portName, "uiColor" );
+}
+
+void DFGExecBuildPlan::ResolveNodePort(
+  DFGExecBuildSource &source,
+  FTL::CStrRef nodeName,
+  FabricCore::DFGNodeType nodeType,
+  FTL::CStrRef portName,
+  FTL::JSONObject const *portObject,
+  std::set<std::string> const &colorTypes,
+  Port &port
+  )
+{
+  FTL::CStrRef dataType = portObject->getStringOrEmpty( FTL_STR("type") );
+  Assign( port.name, portName );
+  Assign( port.dataType, dataType );
+  Assign(
+    port.portType,
+    portObject->getStringOrEmpty( FTL_STR("nodePortType") )
+    );
+  // only the ports of insts carry a color of their own
+  if ( nodeType == FabricCore::DFGNodeType_Inst
+    && NeedsUIColor( dataType, colorTypes ) )
+  {
+    port.uiColor = source.getInstExecPortMetadata(
+      nodeName,
+      portName,
+      "uiColor"
+      );
+  }
+}
+
+void DFGExecBuildPlan::ResolveNode(
+  DFGExecBuildSource &source,
+  FTL::CStrRef nodeName,
+  FTL::JSONObject const *nodeObject,
+  std::set<std::string> const &colorTypes,
+  Node &node
+  )
+{
+  Assign( node.name, nodeName );
+  node.type = source.getNodeType( nodeName );
+  node.titleSuffixAsterisk = false;
+
+  if ( node.type == FabricCore::DFGNodeType_Inst )
+  {
+    if ( source.instExecIsPreset( nodeName ) )
+      Assign(
+        node.title,
+        nodeObject->getStringOrEmpty( FTL_STR("execTitle") )
+        );
+    else
+    {
+      Assign( node.title, nodeName );
+      node.titleSuffixAsterisk = true;
+    }
+  }
+  else if ( node.type == FabricCore::DFGNodeType_Var )
+    Assign( node.title, nodeObject->getStringOrEmpty( FTL_STR("name") ) );
+  else if ( node.type == FabricCore::DFGNodeType_Get )
+    node.title = "get " + source.getRefVarPath( nodeName );
+  else if ( node.type == FabricCore::DFGNodeType_Set )
+    node.title = "set " + source.getRefVarPath( nodeName );
+
+  FTL::JSONArray const *portsArray =
+    nodeObject->get( FTL_STR("ports") )->cast<FTL::JSONArray>();
+  node.pins.resize( portsArray->size() );
+  for ( size_t i = 0; i < portsArray->size(); ++i )
+  {
+    FTL::JSONObject const *portObject =
+      portsArray->get( i )->cast<FTL::JSONObject>();
+    ResolveNodePort(
+      source,
+      nodeName,
+      node.type,
+      portObject->getString( FTL_STR("name") ),
+      portObject,
+      colorTypes,
+      node.pins[i]
+      );
+  }
+
+  // the ui metadata of the instantiated exec comes first, the node's own
+  // metadata overrides it
+  if ( node.type == FabricCore::DFGNodeType_Inst )
+  {
+    static char const * const instExecKeys[] =
+    {
+      "uiNodeColor",
+      "uiHeaderColor",
+      "uiTextColor",
+      "uiTooltip",
+      "uiAlwaysShowDaisyChainPorts",
+      "uiCollapsedState",
+    };
+    for ( size_t i = 0;
+      i < sizeof( instExecKeys ) / sizeof( instExecKeys[0] ); ++i )
+    {
+      Metadata metadata;
+      metadata.value = source.getInstExecMetadata( nodeName, instExecKeys[i] );
+      if ( metadata.value.empty() )
+        continue;
+      metadata.key = instExecKeys[i];
+      node.metadata.push_back( metadata );
+    }
+  }
+  else if ( node.type == FabricCore::DFGNodeType_User )
+  {
+    static char const * const userKeys[] =
+    {
+      "uiNodeColor",
+      "uiHeaderColor",
+      "uiTextColor",
+    };
+    for ( size_t i = 0;
+      i < sizeof( userKeys ) / sizeof( userKeys[0] ); ++i )
+    {
+      Metadata metadata;
+      metadata.value = source.getNodeMetadata( nodeName, userKeys[i] );
+      if ( metadata.value.empty() )
+        continue;
+      metadata.key = userKeys[i];
+      node.metadata.push_back( metadata );
+    }
+  }
+
+  if ( FTL::JSONValue const *metadataValue =
+    nodeObject->maybeGet( FTL_STR("metadata") ) )
+  {
+    FTL::JSONObject const *metadataObject =
+      metadataValue->cast<FTL::JSONObject>();
+    for ( FTL::JSONObject::const_iterator it = metadataObject->begin();
+      it != metadataObject->end(); ++it )
+    {
+      Metadata metadata;
+      Assign( metadata.key, it->first );
+      Assign(
+        metadata.value,
+        it->second->cast<FTL::JSONString>()->getValue()
+        );
+      node.metadata.push_back( metadata );
+    }
+  }
+}
+
+bool DFGExecBuildPlan::resolve(
+  DFGExecBuildSource &source,
+  FTL::CStrRef desc,
+  std::set<std::string> const &colorTypes,
+  DFGExecBuildToken const &token
+  )
+{
+  if ( token.isCancelled() )
+    return false;
+
+  FTL::JSONStrWithLoc jsonSrcWithLoc( desc );
+  FTL::OwnedPtr<FTL::JSONValue const> rootValue(
+    FTL::JSONValue::Decode( jsonSrcWithLoc )
+    );
+
+  if ( token.isCancelled() )
+    return false;
+
+  FTL::JSONObject const *rootObject = rootValue->cast<FTL::JSONObject>();
+
+  FTL::JSONArray const *portsArray =
+    rootObject->get( FTL_STR("ports") )->cast<FTL::JSONArray>();
+  m_ports.resize( portsArray->size() );
+  for ( size_t i = 0; i < portsArray->size(); ++i )
+  {
+    FTL::JSONObject const *portObject =
+      portsArray->get( i )->cast<FTL::JSONObject>();
+    ResolveExecPort(
+      source,
+      portObject->getString( FTL_STR("name") ),
+      portObject,
+      colorTypes,
+      m_ports[i]
+      );
+  }
+
+  m_isGraph =
+    rootObject->getString( FTL_STR("objectType") ) == FTL_STR("Graph");
+  if ( m_isGraph )
+  {
+    FTL::JSONArray const *nodesArray =
+      rootObject->get( FTL_STR("nodes") )->cast<FTL::JSONArray>();
+    m_nodes.resize( nodesArray->size() );
+    for ( size_t i = 0; i < nodesArray->size(); ++i )
+    {
+      if ( ( i & 255 ) == 0 && token.isCancelled() )
+        return false;
+      FTL::JSONObject const *nodeObject =
+        nodesArray->get( i )->cast<FTL::JSONObject>();
+      ResolveNode(
+        source,
+        nodeObject->getString( FTL_STR("name") ),
+        nodeObject,
+        colorTypes,
+        m_nodes[i]
+        );
+    }
+
+    FTL::JSONObject const *connectionsObject =
+      rootObject->get( FTL_STR("connections") )->cast<FTL::JSONObject>();
+    for ( FTL::JSONObject::const_iterator it = connectionsObject->begin();
+      it != connectionsObject->end(); ++it )
+    {
+      FTL::JSONArray const *dstsArray = it->second->cast<FTL::JSONArray>();
+      for ( FTL::JSONArray::const_iterator jt = dstsArray->begin();
+        jt != dstsArray->end(); ++jt )
+      {
+        m_connections.push_back( Connection() );
+        Connection &connection = m_connections.back();
+        Assign( connection.srcPath, it->first );
+        Assign( connection.dstPath, (*jt)->getStringValue() );
+      }
+    }
+  }
+
+  if ( token.isCancelled() )
+    return false;
+
+  FTL::JSONValue const *metadatasValue =
+    rootObject->maybeGet( FTL_STR("metadata") );
+  if ( metadatasValue )
+  {
+    FTL::JSONObject const *metadatasObject =
+      metadatasValue->cast<FTL::JSONObject>();
+    for ( FTL::JSONObject::const_iterator it = metadatasObject->begin();
+      it != metadatasObject->end(); ++it )
+    {
+      Metadata metadata;
+      Assign( metadata.key, it->first );
+      Assign( metadata.value, it->second->getStringValue() );
+      m_metadata.push_back( metadata );
+    }
+  }
+
+  return true;
+}
@@ -0,0 +1,262 @@
+// Copyright 2010-2015 Fabric Software Inc. All rights reserved.
+
+#ifndef __UI_DFG_DFGExecBuildPlan__
+#define __UI_DFG_DFGExecBuildPlan__
+
+#include <FabricCore.h>
+#include <FTL/CStrRef.h>
+#include <FTL/JSONValue.h>
+
+#include <QtCore/QAtomicInt>
+#include <QtCore/QSharedPointer>
+
+#include <set>
+#include <string>
+#include <vector>
+
+namespace FabricUI
+{
+
+  namespace DFG
+  {
+
+    // Shared flag used to drop a build plan that is no longer wanted,
+    // eg. when the user moves on to another exec before it is ready.
+    class DFGExecBuildToken
+    {
+    public:
+
+      DFGExecBuildToken()
+        : m_cancelled( new QAtomicInt( 0 ) )
+        {}
+
+      void cancel() const
+        { m_cancelled->fetchAndStoreOrdered( 1 ); }
+      bool isCancelled() const
+        { return int( *m_cancelled ) != 0; }
+
+    private:
+
+      QSharedPointer<QAtomicInt> m_cancelled;
+    };
+
+    // What a build plan, and the router's notification handlers, need
+    // to know about the exec beyond its description.  The calls are made
+    // from the thread preparing the plan and may throw
+    // FabricCore::Exception, eg. when a node was removed since the
+    // description was taken.
+    class DFGExecBuildSource
+    {
+    public:
+
+      virtual ~DFGExecBuildSource() {}
+
+      virtual FabricCore::DFGExecType getExecType() = 0;
+      virtual FabricCore::DFGNodeType getNodeType(
+        FTL::CStrRef nodeName
+        ) = 0;
+      virtual bool instExecIsPreset( FTL::CStrRef nodeName ) = 0;
+      virtual std::string getRefVarPath( FTL::CStrRef nodeName ) = 0;
+      virtual std::string getNodeMetadata(
+        FTL::CStrRef nodeName,
+        FTL::CStrRef key
+        ) = 0;
+      // metadata of the exec instantiated by an inst node
+      virtual std::string getInstExecMetadata(
+        FTL::CStrRef nodeName,
+        FTL::CStrRef key
+        ) = 0;
+      virtual std::string getInstExecPortMetadata(
+        FTL::CStrRef nodeName,
+        FTL::CStrRef portName,
+        FTL::CStrRef key
+        ) = 0;
+      virtual std::string getExecPortMetadata(
+        FTL::CStrRef portName,
+        FTL::CStrRef key
+        ) = 0;
+      virtual std::string getInstExecTitle( FTL::CStrRef nodeName ) = 0;
+
+      // the ports of the exec and of the exec instantiated by an inst
+      // node, in order
+      virtual unsigned getExecPortCount() = 0;
+      virtual std::string getExecPortName( unsigned index ) = 0;
+      virtual FabricCore::DFGPortType getExecPortType( unsigned index ) = 0;
+      virtual unsigned getInstExecPortCount( FTL::CStrRef nodeName ) = 0;
+      virtual std::string getInstExecPortName(
+        FTL::CStrRef nodeName,
+        unsigned index
+        ) = 0;
+    };
+
+    // Answers the queries of a build plan from a live exec.
+    class DFGExecBuildCoreSource : public DFGExecBuildSource
+    {
+    public:
+
+      DFGExecBuildCoreSource( FabricCore::DFGExec const &exec )
+        : m_exec( exec )
+        {}
+
+      virtual FabricCore::DFGExecType getExecType();
+      virtual FabricCore::DFGNodeType getNodeType( FTL::CStrRef nodeName );
+      virtual bool instExecIsPreset( FTL::CStrRef nodeName );
+      virtual std::string getRefVarPath( FTL::CStrRef nodeName );
+      virtual std::string getNodeMetadata(
+        FTL::CStrRef nodeName,
+        FTL::CStrRef key
+        );
+      virtual std::string getInstExecMetadata(
+        FTL::CStrRef nodeName,
+        FTL::CStrRef key
+        );
+      virtual std::string getInstExecPortMetadata(
+        FTL::CStrRef nodeName,
+        FTL::CStrRef portName,
+        FTL::CStrRef key
+        );
+      virtual std::string getExecPortMetadata(
+        FTL::CStrRef portName,
+        FTL::CStrRef key
+        );
+      virtual std::string getInstExecTitle( FTL::CStrRef nodeName );
+      virtual unsigned getExecPortCount();
+      virtual std::string getExecPortName( unsigned index );
+      virtual FabricCore::DFGPortType getExecPortType( unsigned index );
+      virtual unsigned getInstExecPortCount( FTL::CStrRef nodeName );
+      virtual std::string getInstExecPortName(
+        FTL::CStrRef nodeName,
+        unsigned index
+        );
+
+    private:
+
+      // the queries come in runs per node, so the last sub exec is kept
+      FabricCore::DFGExec &getSubExec( FTL::CStrRef nodeName );
+
+      FabricCore::DFGExec m_exec;
+      std::string m_subExecNodeName;
+      FabricCore::DFGExec m_subExec;
+    };
+
+    // Everything needed to build the graph of an exec: its ports, nodes
+    // with their pins and ui metadata, connections and metadata, resolved
+    // from the description and a DFGExecBuildSource.  It owns all its
+    // data and is immutable once built, so it can be prepared on a worker
+    // thread and turned into the view on the GUI thread without further
+    // queries.
+    class DFGExecBuildPlan
+    {
+    public:
+
+      struct Port
+      {
+        std::string name;
+        std::string dataType;
+        // the execPortType or nodePortType: "In", "Out" or "IO"
+        std::string portType;
+        // only fetched for data types without a registered color
+        std::string uiColor;
+      };
+
+      struct Metadata
+      {
+        std::string key;
+        std::string value;
+      };
+
+      struct Node
+      {
+        std::string name;
+        FabricCore::DFGNodeType type;
+        // empty to keep the name as title
+        std::string title;
+        bool titleSuffixAsterisk;
+        std::vector<Port> pins;
+        // applied in order, later entries win
+        std::vector<Metadata> metadata;
+      };
+
+      struct Connection
+      {
+        std::string srcPath;
+        std::string dstPath;
+      };
+
+      // returns a null pointer if the token got cancelled, or if the
+      // description could not be parsed or the source threw; colorTypes
+      // are the base types whose pins need no uiColor lookup
+      static QSharedPointer<DFGExecBuildPlan> Build(
+        QSharedPointer<DFGExecBuildSource> source,
+        std::string desc,
+        std::set<std::string> colorTypes,
+        DFGExecBuildToken token
+        );
+
+      // resolve a single item, for the nodes and ports inserted once the
+      // graph is built; these throw like the source does
+      static void ResolveNode(
+        DFGExecBuildSource &source,
+        FTL::CStrRef nodeName,
+        FTL::JSONObject const *nodeObject,
+        std::set<std::string> const &colorTypes,
+        Node &node
+        );
+      static void ResolveNodePort(
+        DFGExecBuildSource &source,
+        FTL::CStrRef nodeName,
+        FabricCore::DFGNodeType nodeType,
+        FTL::CStrRef portName,
+        FTL::JSONObject const *portObject,
+        std::set<std::string> const &colorTypes,
+        Port &port
+        );
+      static void ResolveExecPort(
+        DFGExecBuildSource &source,
+        FTL::CStrRef portName,
+        FTL::JSONObject const *portObject,
+        std::set<std::string> const &colorTypes,
+        Port &port
+        );
+      // whether a port of this data type needs its uiColor looked up
+      static bool NeedsUIColor(
+        FTL::CStrRef dataType,
+        std::set<std::string> const &colorTypes
+        );
+
+      bool isGraph() const
+        { return m_isGraph; }
+      std::vector<Port> const &ports() const
+        { return m_ports; }
+      std::vector<Node> const &nodes() const
+        { return m_nodes; }
+      std::vector<Connection> const &connections() const
+        { return m_connections; }
+      std::vector<Metadata> const &metadata() const
+        { return m_metadata; }
+
+    private:
+
+      DFGExecBuildPlan();
+      DFGExecBuildPlan( DFGExecBuildPlan const & );
+      DFGExecBuildPlan &operator=( DFGExecBuildPlan const & );
+
+      bool resolve(
+        DFGExecBuildSource &source,
+        FTL::CStrRef desc,
+        std::set<std::string> const &colorTypes,
+        DFGExecBuildToken const &token
+        );
+
+      bool m_isGraph;
+      std::vector<Port> m_ports;
+      std::vector<Node> m_nodes;
+      std::vector<Connection> m_connections;
+      std::vector<Metadata> m_metadata;
+    };
+
+  };
+
+};
+
+#endif // __UI_DFG_DFGExecBuildPlan__
@@ -6,6 +6,7 @@
 #include "Dialogs/DFGNewVariableDialog.h"
 #include "DFGUICmdHandler.h"
 #include <FabricCore.h>
+#include <FabricUI/Util/Ticks.h>
 
 using namespace FabricUI;
 using namespace FabricUI::DFG;
@@ -30,6 +31,24 @@ void DFGGraphViewWidget::setGraph(GraphView::Graph * graph)
     graph->setCentralOverlayText("Press TAB to insert nodes.");
 }
 
+void DFGGraphViewWidget::paintEvent(QPaintEvent *event)
+{
+  DFGController *controller = graph() ?
+    static_cast<DFGController *>( graph()->controller() ) : NULL;
+  if(!controller || !controller->notificationProfiler().hasPendingScene())
+  {
+    GraphView::GraphViewWidget::paintEvent(event);
+    return;
+  }
+
+  // the paint following notifications is accounted to them
+  uint64_t startTicks = Util::GetCurrentTicks();
+  GraphView::GraphViewWidget::paintEvent(event);
+  controller->notificationProfiler().addScenePaint(
+    Util::GetSecondsBetweenTicks( startTicks, Util::GetCurrentTicks() )
+    );
+}
+
 void DFGGraphViewWidget::dropEvent(QDropEvent *event)
 {
   DFGController *controller =
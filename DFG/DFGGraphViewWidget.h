@@ -24,6 +24,10 @@ namespace FabricUI
       virtual void setGraph(GraphView::Graph * graph);
       virtual void dropEvent(QDropEvent *event);
 
+    protected:
+
+      virtual void paintEvent(QPaintEvent *event);
+
     };
 
   };
@@ -0,0 +1,67 @@
+// Copyright 2010-2015 Fabric Software Inc. All rights reserved.
+
+#include <FabricUI/DFG/DFGNotificationDescTable.h>
+#include <FabricUI/Util/StrHash.h>
+
+using namespace FabricUI;
+using namespace FabricUI::DFG;
+
+int DFGNotificationDescTable::insert( FTL::StrRef desc )
+{
+  int index = find( desc );
+  if ( index >= 0 )
+    return index;
+
+  index = int( m_descs.size() );
+  m_descs.push_back( std::string( desc.data(), desc.size() ) );
+  m_hashes.push_back( Util::HashStr( desc ) );
+
+  // keep the load factor at or below one half
+  if ( m_descs.size() * 2 > m_slots.size() )
+    rebuild();
+  else
+  {
+    size_t mask = m_slots.size() - 1;
+    size_t slot = m_hashes.back() & mask;
+    while ( m_slots[slot] >= 0 )
+      slot = ( slot + 1 ) & mask;
+    m_slots[slot] = index;
+  }
+  return index;
+}
+
+int DFGNotificationDescTable::find( FTL::StrRef desc ) const
+{
+  if ( m_slots.empty() )
+    return -1;
+
+  uint32_t hash = Util::HashStr( desc );
+  size_t mask = m_slots.size() - 1;
+  for ( size_t slot = hash & mask; ; slot = ( slot + 1 ) & mask )
+  {
+    int index = m_slots[slot];
+    if ( index < 0 )
+      return -1;
+    std::string const &slotDesc = m_descs[index];
+    if ( m_hashes[index] == hash
+      && desc == FTL::StrRef( slotDesc.data(), slotDesc.size() ) )
+      return index;
+  }
+}
+
+void DFGNotificationDescTable::rebuild()
+{
+  size_t slotCount = 16;
+  while ( slotCount < m_descs.size() * 2 )
+    slotCount *= 2;
+
+  m_slots.assign( slotCount, -1 );
+  size_t mask = slotCount - 1;
+  for ( size_t i = 0; i < m_descs.size(); ++i )
+  {
+    size_t slot = m_hashes[i] & mask;
+    while ( m_slots[slot] >= 0 )
+      slot = ( slot + 1 ) & mask;
+    m_slots[slot] = int( i );
+  }
+}
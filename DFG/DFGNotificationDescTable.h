@@ -0,0 +1,50 @@
+// Copyright 2010-2015 Fabric Software Inc. All rights reserved.
+
+#ifndef __UI_DFG_DFGNotificationDescTable__
+#define __UI_DFG_DFGNotificationDescTable__
+
+#include <FTL/StrRef.h>
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace FabricUI
+{
+
+  namespace DFG
+  {
+
+    // Maps notification descs to dense indices, in the order they were
+    // added, through open addressing on the hash of the desc.  The router
+    // keeps its handlers at these indices.
+    class DFGNotificationDescTable
+    {
+    public:
+
+      DFGNotificationDescTable() {}
+
+      size_t size() const
+        { return m_descs.size(); }
+
+      // returns the index of desc, adding it if it is new
+      int insert( FTL::StrRef desc );
+
+      // returns -1 if desc was never added
+      int find( FTL::StrRef desc ) const;
+
+    private:
+
+      void rebuild();
+
+      std::vector<std::string> m_descs;
+      std::vector<uint32_t> m_hashes;
+      // indices into m_descs, -1 marks a free slot
+      std::vector<int> m_slots;
+    };
+
+  };
+
+};
+
+#endif // __UI_DFG_DFGNotificationDescTable__
@@ -0,0 +1,307 @@
+// Copyright 2010-2015 Fabric Software Inc. All rights reserved.
+
+#include <FabricUI/DFG/DFGNotificationJSON.h>
+
+#include <string>
+
+using namespace FabricUI;
+using namespace FabricUI::DFG;
+
+static inline void SkipWhitespace( char *&p, char *end )
+{
+  while ( p != end
+    && ( *p == ' ' || *p == '\t' || *p == '\n' || *p == '\r' ) )
+    ++p;
+}
+
+static void Expect( char *&p, char *end, char c )
+{
+  if ( p == end || *p != c )
+  {
+    std::string desc = "DFGNotificationJSON: expected '";
+    desc += c;
+    desc += "'";
+    throw FTL::JSONException( desc.c_str() );
+  }
+  ++p;
+}
+
+static unsigned ParseHex4( char const *p, char const *end )
+{
+  if ( end - p < 4 )
+    throw FTL::JSONException( "DFGNotificationJSON: truncated \\u escape" );
+  unsigned value = 0;
+  for ( int i = 0; i < 4; ++i )
+  {
+    char c = p[i];
+    value <<= 4;
+    if ( c >= '0' && c <= '9' )
+      value |= unsigned( c - '0' );
+    else if ( c >= 'a' && c <= 'f' )
+      value |= unsigned( c - 'a' + 10 );
+    else if ( c >= 'A' && c <= 'F' )
+      value |= unsigned( c - 'A' + 10 );
+    else
+      throw FTL::JSONException( "DFGNotificationJSON: bad \\u escape" );
+  }
+  return value;
+}
+
+// Unescapes the string starting after its opening quote in place and
+// null-terminates it.  Escapes never expand, so the write position
+// never overtakes the read position.
+static FTL::StrRef ParseStringInPlace( char *&p, char *end )
+{
+  char *begin = p;
+  char *out = p;
+  for (;;)
+  {
+    if ( p == end )
+      throw FTL::JSONException( "DFGNotificationJSON: unterminated string" );
+
+    char c = *p++;
+    if ( c == '"' )
+      break;
+    if ( c != '\\' )
+    {
+      *out++ = c;
+      continue;
+    }
+
+    if ( p == end )
+      throw FTL::JSONException( "DFGNotificationJSON: unterminated string" );
+    switch ( *p++ )
+    {
+      case '"': *out++ = '"'; break;
+      case '\\': *out++ = '\\'; break;
+      case '/': *out++ = '/'; break;
+      case 'b': *out++ = '\b'; break;
+      case 'f': *out++ = '\f'; break;
+      case 'n': *out++ = '\n'; break;
+      case 'r': *out++ = '\r'; break;
+      case 't': *out++ = '\t'; break;
+      case 'u':
+      {
+        unsigned codePoint = ParseHex4( p, end );
+        p += 4;
+        if ( codePoint >= 0xD800 && codePoint < 0xDC00
+          && end - p >= 6 && p[0] == '\\' && p[1] == 'u' )
+        {
+          unsigned low = ParseHex4( p + 2, end );
+          if ( low >= 0xDC00 && low < 0xE000 )
+          {
+            codePoint =
+              0x10000 + ( ( codePoint - 0xD800 ) << 10 ) + ( low - 0xDC00 );
+            p += 6;
+          }
+        }
+
+        if ( codePoint < 0x80 )
+          *out++ = char( codePoint );
+        else if ( codePoint < 0x800 )
+        {
+          *out++ = char( 0xC0 | ( codePoint >> 6 ) );
+          *out++ = char( 0x80 | ( codePoint & 0x3F ) );
+        }
+        else if ( codePoint < 0x10000 )
+        {
+          *out++ = char( 0xE0 | ( codePoint >> 12 ) );
+          *out++ = char( 0x80 | ( ( codePoint >> 6 ) & 0x3F ) );
+          *out++ = char( 0x80 | ( codePoint & 0x3F ) );
+        }
+        else
+        {
+          *out++ = char( 0xF0 | ( codePoint >> 18 ) );
+          *out++ = char( 0x80 | ( ( codePoint >> 12 ) & 0x3F ) );
+          *out++ = char( 0x80 | ( ( codePoint >> 6 ) & 0x3F ) );
+          *out++ = char( 0x80 | ( codePoint & 0x3F ) );
+        }
+      }
+      break;
+      default:
+        throw FTL::JSONException( "DFGNotificationJSON: bad escape" );
+    }
+  }
+  *out = '\0';
+  return FTL::StrRef( begin, out - begin );
+}
+
+// Skips over a non-string value without modifying it.
+static void SkipValue( char *&p, char *end )
+{
+  if ( p != end && ( *p == '{' || *p == '[' ) )
+  {
+    unsigned depth = 0;
+    do
+    {
+      char c = *p++;
+      if ( c == '"' )
+      {
+        for (;;)
+        {
+          if ( p == end )
+            throw FTL::JSONException( "DFGNotificationJSON: unterminated string" );
+          char d = *p++;
+          if ( d == '\\' && p != end )
+            ++p;
+          else if ( d == '"' )
+            break;
+        }
+      }
+      else if ( c == '{' || c == '[' )
+        ++depth;
+      else if ( c == '}' || c == ']' )
+        --depth;
+    } while ( depth > 0 && p != end );
+
+    if ( depth > 0 )
+      throw FTL::JSONException( "DFGNotificationJSON: unterminated value" );
+  }
+  else
+  {
+    // number, true, false or null
+    while ( p != end
+      && *p != ',' && *p != '}' && *p != ']'
+      && *p != ' ' && *p != '\t' && *p != '\n' && *p != '\r' )
+      ++p;
+  }
+}
+
+DFGNotificationJSON::DFGNotificationJSON( FTL::StrRef jsonStr )
+  : m_buffer( jsonStr.data(), jsonStr.data() + jsonStr.size() )
+{
+  m_buffer.push_back( '\0' );
+  m_members.reserve( 8 );
+
+  char *p = &m_buffer[0];
+  char *end = p + jsonStr.size();
+
+  SkipWhitespace( p, end );
+  Expect( p, end, '{' );
+  SkipWhitespace( p, end );
+  if ( p != end && *p == '}' )
+    return;
+
+  for (;;)
+  {
+    Expect( p, end, '"' );
+    Member member;
+    member.key = ParseStringInPlace( p, end );
+    SkipWhitespace( p, end );
+    Expect( p, end, ':' );
+    SkipWhitespace( p, end );
+
+    if ( p != end && *p == '"' )
+    {
+      ++p;
+      member.value = ParseStringInPlace( p, end );
+      member.isString = true;
+    }
+    else
+    {
+      char const *valueBegin = p;
+      SkipValue( p, end );
+      if ( p == valueBegin )
+        throw FTL::JSONException( "DFGNotificationJSON: missing value" );
+      member.value = FTL::StrRef( valueBegin, p - valueBegin );
+      member.isString = false;
+    }
+    m_members.push_back( member );
+
+    SkipWhitespace( p, end );
+    if ( p != end && *p == ',' )
+    {
+      ++p;
+      SkipWhitespace( p, end );
+      continue;
+    }
+    Expect( p, end, '}' );
+    break;
+  }
+}
+
+DFGNotificationJSON::Member const *DFGNotificationJSON::find(
+  FTL::StrRef key
+  ) const
+{
+  for ( size_t i = 0; i < m_members.size(); ++i )
+  {
+    if ( m_members[i].key == key )
+      return &m_members[i];
+  }
+  return 0;
+}
+
+FTL::CStrRef DFGNotificationJSON::getString( FTL::StrRef key ) const
+{
+  Member const *member = find( key );
+  if ( !member || !member->isString )
+  {
+    std::string desc = "DFGNotificationJSON: missing string member '";
+    desc.append( key.data(), key.size() );
+    desc += "'";
+    throw FTL::JSONException( desc.c_str() );
+  }
+  return FTL::CStrRef( member->value.data(), member->value.size() );
+}
+
+FTL::CStrRef DFGNotificationJSON::getStringOrEmpty( FTL::StrRef key ) const
+{
+  FTL::CStrRef value;
+  maybeGetString( key, value );
+  return value;
+}
+
+bool DFGNotificationJSON::maybeGetString(
+  FTL::StrRef key,
+  FTL::CStrRef &value
+  ) const
+{
+  Member const *member = find( key );
+  if ( !member || !member->isString )
+    return false;
+  value = FTL::CStrRef( member->value.data(), member->value.size() );
+  return true;
+}
+
+FTL::JSONValue *DFGNotificationJSON::decode( FTL::StrRef key ) const
+{
+  Member const *member = find( key );
+  if ( !member || member->isString )
+  {
+    std::string desc = "DFGNotificationJSON: missing member '";
+    desc.append( key.data(), key.size() );
+    desc += "'";
+    throw FTL::JSONException( desc.c_str() );
+  }
+  FTL::JSONStrWithLoc jsonStrWithLoc( member->value );
+  return FTL::JSONValue::Decode( jsonStrWithLoc );
+}
+
+FTL::JSONArray *DFGNotificationJSON::maybeDecodeArray( FTL::StrRef key ) const
+{
+  Member const *member = find( key );
+  if ( !member || member->isString
+    || member->value.empty() || member->value.data()[0] != '[' )
+    return 0;
+  FTL::JSONStrWithLoc jsonStrWithLoc( member->value );
+  return FTL::JSONValue::Decode( jsonStrWithLoc )->cast<FTL::JSONArray>();
+}
+
+bool DFGNotificationJSON::replaceString(
+  FTL::StrRef key,
+  FTL::StrRef value
+  )
+{
+  for ( size_t i = 0; i < m_members.size(); ++i )
+  {
+    Member &member = m_members[i];
+    if ( member.key != key || !member.isString )
+      continue;
+    m_replacedStrings.push_back( std::string( value.data(), value.size() ) );
+    std::string const &replaced = m_replacedStrings.back();
+    member.value = FTL::StrRef( replaced.c_str(), replaced.size() );
+    return true;
+  }
+  return false;
+}
@@ -0,0 +1,82 @@
+// Copyright 2010-2015 Fabric Software Inc. All rights reserved.
+
+#ifndef __UI_DFG_DFGNotificationJSON__
+#define __UI_DFG_DFGNotificationJSON__
+
+#include <FTL/CStrRef.h>
+#include <FTL/JSONValue.h>
+
+#include <list>
+#include <string>
+#include <vector>
+
+namespace FabricUI
+{
+
+  namespace DFG
+  {
+
+    // Shallow, single pass scan of a core notification.  Only the members
+    // of the top-level object are located; string members are unescaped
+    // and null-terminated in place inside a private copy of the
+    // notification, so looking them up does not allocate.  Members that
+    // are objects or arrays are kept as raw JSON text and only decoded
+    // into a DOM when a handler asks for them.
+    class DFGNotificationJSON
+    {
+    public:
+
+      // throws FTL::JSONException if jsonStr is not a JSON object
+      DFGNotificationJSON( FTL::StrRef jsonStr );
+
+      FTL::CStrRef getDesc() const
+        { return getString( FTL_STR("desc") ); }
+
+      bool has( FTL::StrRef key ) const
+        { return find( key ) != 0; }
+
+      // throws FTL::JSONException if the member is missing or is not
+      // a string
+      FTL::CStrRef getString( FTL::StrRef key ) const;
+      FTL::CStrRef getStringOrEmpty( FTL::StrRef key ) const;
+      bool maybeGetString( FTL::StrRef key, FTL::CStrRef &value ) const;
+
+      // decodes a non-string member; the caller owns the result.
+      // throws FTL::JSONException if the member is missing.
+      FTL::JSONValue *decode( FTL::StrRef key ) const;
+      FTL::JSONObject *decodeObject( FTL::StrRef key ) const
+        { return decode( key )->cast<FTL::JSONObject>(); }
+      // returns 0 if the member is missing
+      FTL::JSONArray *maybeDecodeArray( FTL::StrRef key ) const;
+
+      // replaces the value of an existing string member, used to rewrite
+      // queued notifications; returns false if there is no such member
+      bool replaceString( FTL::StrRef key, FTL::StrRef value );
+
+    private:
+
+      DFGNotificationJSON( DFGNotificationJSON const & );
+      DFGNotificationJSON &operator=( DFGNotificationJSON const & );
+
+      struct Member
+      {
+        FTL::StrRef key;
+        // the unescaped string for string members, raw JSON otherwise
+        FTL::StrRef value;
+        bool isString;
+      };
+
+      Member const *find( FTL::StrRef key ) const;
+
+      std::vector<char> m_buffer;
+      std::vector<Member> m_members;
+      // storage of the replaced string values, a list so that the
+      // members can keep pointing into it
+      std::list<std::string> m_replacedStrings;
+    };
+
+  };
+
+};
+
+#endif // __UI_DFG_DFGNotificationJSON__
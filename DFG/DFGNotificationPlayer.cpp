@@ -0,0 +1,350 @@
+// Copyright 2010-2015 Fabric Software Inc. All rights reserved.
+
+#include <FabricUI/DFG/DFGNotificationPlayer.h>
+#include <FabricUI/DFG/DFGNotificationRouter.h>
+#include <FabricUI/Util/Ticks.h>
+
+#include <FTL/JSONValue.h>
+#include <FTL/OwnedPtr.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+using namespace FabricUI;
+using namespace FabricUI::DFG;
+
+DFGNotificationPlayer::DFGNotificationPlayer()
+{
+}
+
+bool DFGNotificationPlayer::load( char const *filePath )
+{
+  m_notifications.clear();
+  m_execPaths.clear();
+  m_marks.clear();
+  m_answers.clear();
+
+  FILE *file = fopen( filePath, "rb" );
+  if ( !file )
+  {
+    printf(
+      "DFGNotificationPlayer: unable to open '%s' for reading\n",
+      filePath
+      );
+    return false;
+  }
+
+  std::string line;
+  char buffer[4096];
+  for (;;)
+  {
+    line.clear();
+    bool eof = true;
+    while ( fgets( buffer, sizeof( buffer ), file ) )
+    {
+      eof = false;
+      line += buffer;
+      if ( !line.empty() && line[line.size() - 1] == '\n' )
+        break;
+    }
+    if ( eof )
+      break;
+
+    while ( !line.empty()
+      && ( line[line.size() - 1] == '\n' || line[line.size() - 1] == '\r' ) )
+      line.resize( line.size() - 1 );
+    if ( line.empty() )
+      continue;
+
+    if ( line[0] == '#' )
+    {
+      static const std::string execPrefix = "# exec ";
+      static const std::string descPrefix = "# desc ";
+      static const std::string flushLine = "# flush";
+      Mark mark;
+      mark.index = m_notifications.size();
+      if ( line.compare( 0, execPrefix.size(), execPrefix ) == 0 )
+      {
+        m_execPaths.push_back( line.substr( execPrefix.size() ) );
+        mark.kind = Mark::Kind_Exec;
+      }
+      else if ( line.compare( 0, descPrefix.size(), descPrefix ) == 0 )
+      {
+        mark.kind = Mark::Kind_Desc;
+        mark.desc = line.substr( descPrefix.size() );
+      }
+      else if ( line == flushLine )
+        mark.kind = Mark::Kind_Flush;
+      else
+        continue;
+      m_marks.push_back( mark );
+      continue;
+    }
+
+    if ( line[0] == '?' )
+    {
+      // ["query","arg",...,"answer"]
+      try
+      {
+        FTL::StrRef answerStr( line.data() + 1, line.size() - 1 );
+        FTL::JSONStrWithLoc answerStrWithLoc( answerStr );
+        FTL::OwnedPtr<FTL::JSONValue const> answerValue(
+          FTL::JSONValue::Decode( answerStrWithLoc )
+          );
+        FTL::JSONArray const *answerArray =
+          answerValue->cast<FTL::JSONArray>();
+        if ( answerArray->size() < 2 )
+          continue;
+        std::string key;
+        for ( size_t i = 0; i + 1 < answerArray->size(); ++i )
+        {
+          if ( i > 0 )
+            key += '\n';
+          FTL::CStrRef field = answerArray->get( i )->getStringValue();
+          key.append( field.data(), field.size() );
+        }
+        FTL::CStrRef answer =
+          answerArray->get( answerArray->size() - 1 )->getStringValue();
+        m_answers[key].push_back( std::string( answer.data(), answer.size() ) );
+      }
+      catch ( FTL::JSONException e )
+      {
+        printf(
+          "DFGNotificationPlayer: skipping answer: %s\n",
+          e.getDescCStr()
+          );
+      }
+      continue;
+    }
+
+    char *jsonCStr = 0;
+    Notification notification;
+    notification.time = strtod( line.c_str(), &jsonCStr );
+    while ( *jsonCStr == ' ' )
+      ++jsonCStr;
+    notification.json = jsonCStr;
+    if ( !notification.json.empty() )
+      m_notifications.push_back( notification );
+  }
+
+  fclose( file );
+  return true;
+}
+
+QSharedPointer<DFGExecBuildSource> DFGNotificationPlayer::createSource() const
+{
+  return QSharedPointer<DFGExecBuildSource>(
+    new DFGExecReplaySource( m_answers )
+    );
+}
+
+double DFGNotificationPlayer::replay( DFGNotificationRouter *router ) const
+{
+  router->beginReplay( createSource() );
+
+  uint64_t startTicks = Util::GetCurrentTicks();
+  size_t markIndex = 0;
+  size_t execCount = 0;
+  for ( size_t i = 0; ; ++i )
+  {
+    for ( ; markIndex < m_marks.size()
+      && m_marks[markIndex].index == i; ++markIndex )
+    {
+      Mark const &mark = m_marks[markIndex];
+      if ( mark.kind == Mark::Kind_Exec )
+        ++execCount;
+      if ( execCount > 1 )
+        break;
+      if ( mark.kind == Mark::Kind_Desc )
+        router->buildGraphFromDesc( mark.desc );
+      else if ( mark.kind == Mark::Kind_Flush )
+        router->flushNotifications();
+    }
+    if ( execCount > 1 || i == m_notifications.size() )
+      break;
+    router->replayNotification( m_notifications[i].json );
+  }
+  // whatever the recording ended with is still queued
+  router->flushNotifications();
+  double seconds =
+    Util::GetSecondsBetweenTicks( startTicks, Util::GetCurrentTicks() );
+
+  router->endReplay();
+  return seconds;
+}
+
+static std::string QueryKey( char const *query )
+{
+  return query;
+}
+
+static std::string QueryKey( char const *query, FTL::StrRef arg0 )
+{
+  std::string key = query;
+  key += '\n';
+  key.append( arg0.data(), arg0.size() );
+  return key;
+}
+
+static std::string QueryKey(
+  char const *query,
+  FTL::StrRef arg0,
+  FTL::StrRef arg1
+  )
+{
+  std::string key = QueryKey( query, arg0 );
+  key += '\n';
+  key.append( arg1.data(), arg1.size() );
+  return key;
+}
+
+static std::string QueryKey(
+  char const *query,
+  FTL::StrRef arg0,
+  FTL::StrRef arg1,
+  FTL::StrRef arg2
+  )
+{
+  std::string key = QueryKey( query, arg0, arg1 );
+  key += '\n';
+  key.append( arg2.data(), arg2.size() );
+  return key;
+}
+
+// numbers and enums are recorded as their decimal value
+static std::string FormatUInt( unsigned value )
+{
+  char buffer[16];
+  sprintf( buffer, "%u", value );
+  return buffer;
+}
+
+std::string const &DFGExecReplaySource::answer( std::string const &key )
+{
+  std::map< std::string, std::vector<std::string> >::const_iterator it =
+    m_answers.find( key );
+  if ( it == m_answers.end() || it->second.empty() )
+  {
+    static const std::string empty;
+    std::string query = key;
+    for ( size_t i = 0; i < query.size(); ++i )
+    {
+      if ( query[i] == '\n' )
+        query[i] = ' ';
+    }
+    printf(
+      "DFGExecReplaySource: no recorded answer for '%s'\n",
+      query.c_str()
+      );
+    return empty;
+  }
+
+  size_t &answered = m_answered[key];
+  std::string const &result = it->second[answered];
+  if ( answered + 1 < it->second.size() )
+    ++answered;
+  return result;
+}
+
+unsigned DFGExecReplaySource::answerUInt( std::string const &key )
+{
+  return unsigned( strtoul( answer( key ).c_str(), 0, 10 ) );
+}
+
+FabricCore::DFGExecType DFGExecReplaySource::getExecType()
+{
+  return FabricCore::DFGExecType( answerUInt( QueryKey( "getExecType" ) ) );
+}
+
+FabricCore::DFGNodeType DFGExecReplaySource::getNodeType(
+  FTL::CStrRef nodeName
+  )
+{
+  return FabricCore::DFGNodeType(
+    answerUInt( QueryKey( "getNodeType", nodeName ) )
+    );
+}
+
+bool DFGExecReplaySource::instExecIsPreset( FTL::CStrRef nodeName )
+{
+  return answerUInt( QueryKey( "instExecIsPreset", nodeName ) ) != 0;
+}
+
+std::string DFGExecReplaySource::getRefVarPath( FTL::CStrRef nodeName )
+{
+  return answer( QueryKey( "getRefVarPath", nodeName ) );
+}
+
+std::string DFGExecReplaySource::getNodeMetadata(
+  FTL::CStrRef nodeName,
+  FTL::CStrRef key
+  )
+{
+  return answer( QueryKey( "getNodeMetadata", nodeName, key ) );
+}
+
+std::string DFGExecReplaySource::getInstExecMetadata(
+  FTL::CStrRef nodeName,
+  FTL::CStrRef key
+  )
+{
+  return answer( QueryKey( "getInstExecMetadata", nodeName, key ) );
+}
+
+std::string DFGExecReplaySource::getInstExecPortMetadata(
+  FTL::CStrRef nodeName,
+  FTL::CStrRef portName,
+  FTL::CStrRef key
+  )
+{
+  return answer(
+    QueryKey( "getInstExecPortMetadata", nodeName, portName, key )
+    );
+}
+
+std::string DFGExecReplaySource::getExecPortMetadata(
+  FTL::CStrRef portName,
+  FTL::CStrRef key
+  )
+{
+  return answer( QueryKey( "getExecPortMetadata", portName, key ) );
+}
+
+std::string DFGExecReplaySource::getInstExecTitle( FTL::CStrRef nodeName )
+{
+  return answer( QueryKey( "getInstExecTitle", nodeName ) );
+}
+
+unsigned DFGExecReplaySource::getExecPortCount()
+{
+  return answerUInt( QueryKey( "getExecPortCount" ) );
+}
+
+std::string DFGExecReplaySource::getExecPortName( unsigned index )
+{
+  return answer( QueryKey( "getExecPortName", FormatUInt( index ) ) );
+}
+
+FabricCore::DFGPortType DFGExecReplaySource::getExecPortType(
+  unsigned index
+  )
+{
+  return FabricCore::DFGPortType(
+    answerUInt( QueryKey( "getExecPortType", FormatUInt( index ) ) )
+    );
+}
+
+unsigned DFGExecReplaySource::getInstExecPortCount( FTL::CStrRef nodeName )
+{
+  return answerUInt( QueryKey( "getInstExecPortCount", nodeName ) );
+}
+
+std::string DFGExecReplaySource::getInstExecPortName(
+  FTL::CStrRef nodeName,
+  unsigned index
+  )
+{
+  return answer(
+    QueryKey( "getInstExecPortName", nodeName, FormatUInt( index ) )
+    );
+}
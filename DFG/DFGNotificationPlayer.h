@@ -0,0 +1,144 @@
+// Copyright 2010-2015 Fabric Software Inc. All rights reserved.
+
+#ifndef __UI_DFG_DFGNotificationPlayer__
+#define __UI_DFG_DFGNotificationPlayer__
+
+#include <FabricUI/DFG/DFGExecBuildPlan.h>
+
+#include <QtCore/QSharedPointer>
+
+#include <map>
+#include <string>
+#include <vector>
+
+namespace FabricUI
+{
+
+  namespace DFG
+  {
+    class DFGNotificationRouter;
+
+    // Plays back a recording made with DFGNotificationRecorder by pushing
+    // each notification through the router as if it came from the core.
+    // The router's queries about the exec are answered from the
+    // recording, so no binding is needed: the recorded description
+    // builds the graph, the notifications are applied to it and the
+    // queued ones are flushed where the recording was.  Only the first
+    // exec of a recording is played back, the graph of the router is
+    // expected to be empty.
+    class DFGNotificationPlayer
+    {
+    public:
+
+      struct Notification
+      {
+        double time;
+        std::string json;
+      };
+
+      DFGNotificationPlayer();
+
+      bool load( char const *filePath );
+
+      std::vector<Notification> const &notifications() const
+        { return m_notifications; }
+      // the exec paths annotated in the recording, in order
+      std::vector<std::string> const &execPaths() const
+        { return m_execPaths; }
+
+      // a source answering the recorded queries, in the order they were
+      // recorded
+      QSharedPointer<DFGExecBuildSource> createSource() const;
+
+      // replays the notifications as fast as possible and returns the
+      // number of seconds the router spent on them, flushes included;
+      // the router answers from createSource() meanwhile and records
+      // nothing, see DFGNotificationRouter::beginReplay
+      double replay( DFGNotificationRouter *router ) const;
+
+    private:
+
+      struct Mark
+      {
+        enum Kind
+        {
+          Kind_Exec,
+          Kind_Desc,
+          Kind_Flush
+        };
+
+        Kind kind;
+        // the number of notifications before the mark
+        size_t index;
+        // the description of Kind_Desc marks
+        std::string desc;
+      };
+
+      std::vector<Notification> m_notifications;
+      std::vector<std::string> m_execPaths;
+      std::vector<Mark> m_marks;
+      // keyed by the query and its arguments separated by '\n', see
+      // DFGExecReplaySource
+      std::map< std::string, std::vector<std::string> > m_answers;
+    };
+
+    // Answers the queries of the router from the answers recorded with
+    // DFGExecRecordingSource.  Each query returns its recorded answers in
+    // turn and keeps returning the last one; queries that were never
+    // recorded print a warning and answer empty or zero.
+    class DFGExecReplaySource : public DFGExecBuildSource
+    {
+    public:
+
+      DFGExecReplaySource(
+        std::map< std::string, std::vector<std::string> > const &answers
+        )
+        : m_answers( answers )
+        {}
+
+      virtual FabricCore::DFGExecType getExecType();
+      virtual FabricCore::DFGNodeType getNodeType( FTL::CStrRef nodeName );
+      virtual bool instExecIsPreset( FTL::CStrRef nodeName );
+      virtual std::string getRefVarPath( FTL::CStrRef nodeName );
+      virtual std::string getNodeMetadata(
+        FTL::CStrRef nodeName,
+        FTL::CStrRef key
+        );
+      virtual std::string getInstExecMetadata(
+        FTL::CStrRef nodeName,
+        FTL::CStrRef key
+        );
+      virtual std::string getInstExecPortMetadata(
+        FTL::CStrRef nodeName,
+        FTL::CStrRef portName,
+        FTL::CStrRef key
+        );
+      virtual std::string getExecPortMetadata(
+        FTL::CStrRef portName,
+        FTL::CStrRef key
+        );
+      virtual std::string getInstExecTitle( FTL::CStrRef nodeName );
+      virtual unsigned getExecPortCount();
+      virtual std::string getExecPortName( unsigned index );
+      virtual FabricCore::DFGPortType getExecPortType( unsigned index );
+      virtual unsigned getInstExecPortCount( FTL::CStrRef nodeName );
+      virtual std::string getInstExecPortName(
+        FTL::CStrRef nodeName,
+        unsigned index
+        );
+
+    private:
+
+      // returns an empty answer if the query was not recorded
+      std::string const &answer( std::string const &key );
+      unsigned answerUInt( std::string const &key );
+
+      std::map< std::string, std::vector<std::string> > m_answers;
+      std::map<std::string, size_t> m_answered;
+    };
+
+  };
+
+};
+
+#endif // __UI_DFG_DFGNotificationPlayer__
@@ -0,0 +1,247 @@
+// Copyright 2010-2015 Fabric Software Inc. All rights reserved.
+
+#include <FabricUI/DFG/DFGNotificationProfiler.h>
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+using namespace FabricUI;
+using namespace FabricUI::DFG;
+
+DFGNotificationProfiler::Histogram::Histogram()
+  : m_count( 0 )
+  , m_sum( 0.0 )
+  , m_max( 0.0 )
+{
+  memset( m_buckets, 0, sizeof( m_buckets ) );
+}
+
+void DFGNotificationProfiler::Histogram::add( double seconds )
+{
+  double micros = seconds * 1e6;
+  int bucket = 0;
+  if ( micros > 1.0 )
+    bucket = int( 4.0 * log( micros ) / log( 2.0 ) );
+  if ( bucket >= BucketCount )
+    bucket = BucketCount - 1;
+  ++m_buckets[bucket];
+  ++m_count;
+  m_sum += seconds;
+  if ( seconds > m_max )
+    m_max = seconds;
+}
+
+double DFGNotificationProfiler::Histogram::percentile( double fraction ) const
+{
+  size_t rank = size_t( ceil( fraction * double( m_count ) ) );
+  if ( rank == 0 )
+    rank = 1;
+  size_t seen = 0;
+  for ( int i = 0; i < BucketCount; ++i )
+  {
+    seen += m_buckets[i];
+    if ( seen >= rank )
+    {
+      // report the upper bound of the bucket, clamped to the largest
+      // sample so a single sample reports itself
+      double upper = pow( 2.0, double( i + 1 ) / 4.0 ) * 1e-6;
+      return upper < m_max ? upper : m_max;
+    }
+  }
+  return m_max;
+}
+
+void DFGNotificationProfiler::Histogram::getStats( Stats &stats ) const
+{
+  stats.count = m_count;
+  stats.mean = m_count > 0 ? m_sum / double( m_count ) : 0.0;
+  stats.max = m_max;
+  stats.p50 = percentile( 0.50 );
+  stats.p95 = percentile( 0.95 );
+  stats.p99 = percentile( 0.99 );
+}
+
+DFGNotificationProfiler::DFGNotificationProfiler()
+  : m_enabled( false )
+{
+}
+
+void DFGNotificationProfiler::setEnabled( bool enabled )
+{
+  m_enabled = enabled;
+  m_pendingSceneDescs.clear();
+}
+
+void DFGNotificationProfiler::reset()
+{
+  m_entries.clear();
+  m_pendingSceneDescs.clear();
+}
+
+DFGNotificationProfiler::Entry &DFGNotificationProfiler::entry(
+  FTL::StrRef desc
+  )
+{
+  return m_entries[std::string( desc.data(), desc.size() )];
+}
+
+void DFGNotificationProfiler::addSample(
+  FTL::StrRef desc,
+  Phase phase,
+  double seconds
+  )
+{
+  if ( !m_enabled )
+    return;
+  entry( desc ).histograms[phase].add( seconds );
+}
+
+void DFGNotificationProfiler::addPendingScene( FTL::StrRef desc )
+{
+  if ( !m_enabled )
+    return;
+  for ( size_t i = 0; i < m_pendingSceneDescs.size(); ++i )
+  {
+    std::string const &pendingDesc = m_pendingSceneDescs[i];
+    if ( FTL::StrRef( pendingDesc.data(), pendingDesc.size() ) == desc )
+      return;
+  }
+  m_pendingSceneDescs.push_back( std::string( desc.data(), desc.size() ) );
+}
+
+void DFGNotificationProfiler::addScenePaint( double seconds )
+{
+  if ( !m_enabled )
+    return;
+  for ( size_t i = 0; i < m_pendingSceneDescs.size(); ++i )
+    m_entries[m_pendingSceneDescs[i]].histograms[Phase_Scene].add( seconds );
+  m_pendingSceneDescs.clear();
+}
+
+std::vector<std::string> DFGNotificationProfiler::descs() const
+{
+  std::vector<std::string> result;
+  result.reserve( m_entries.size() );
+  for ( std::map<std::string, Entry>::const_iterator it = m_entries.begin();
+    it != m_entries.end(); ++it )
+    result.push_back( it->first );
+  return result;
+}
+
+bool DFGNotificationProfiler::getStats(
+  FTL::StrRef desc,
+  Phase phase,
+  Stats &stats
+  ) const
+{
+  std::map<std::string, Entry>::const_iterator it =
+    m_entries.find( std::string( desc.data(), desc.size() ) );
+  if ( it == m_entries.end() || it->second.histograms[phase].empty() )
+    return false;
+  it->second.histograms[phase].getStats( stats );
+  return true;
+}
+
+char const *DFGNotificationProfiler::GetPhaseName( Phase phase )
+{
+  switch ( phase )
+  {
+    case Phase_Decode: return "decode";
+    case Phase_Handler: return "handler";
+    case Phase_Scene: return "scene";
+    default: return "";
+  }
+}
+
+bool DFGNotificationProfiler::dumpJSON( char const *filePath ) const
+{
+  FILE *file = fopen( filePath, "wb" );
+  if ( !file )
+  {
+    printf(
+      "DFGNotificationProfiler: unable to open '%s' for writing\n",
+      filePath
+      );
+    return false;
+  }
+
+  // descs are plain identifiers, nothing needs escaping
+  fprintf( file, "{\n" );
+  for ( std::map<std::string, Entry>::const_iterator it = m_entries.begin();
+    it != m_entries.end(); ++it )
+  {
+    if ( it != m_entries.begin() )
+      fprintf( file, ",\n" );
+    fprintf( file, "  \"%s\": {", it->first.c_str() );
+    bool first = true;
+    for ( int phase = 0; phase < PhaseCount; ++phase )
+    {
+      Histogram const &histogram = it->second.histograms[phase];
+      if ( histogram.empty() )
+        continue;
+      Stats stats;
+      histogram.getStats( stats );
+      fprintf(
+        file,
+        "%s\n    \"%s\": {\"count\": %u, \"meanMS\": %.6f, \"p50MS\": %.6f, \"p95MS\": %.6f, \"p99MS\": %.6f, \"maxMS\": %.6f}",
+        first ? "" : ",",
+        GetPhaseName( Phase( phase ) ),
+        unsigned( stats.count ),
+        stats.mean * 1e3,
+        stats.p50 * 1e3,
+        stats.p95 * 1e3,
+        stats.p99 * 1e3,
+        stats.max * 1e3
+        );
+      first = false;
+    }
+    fprintf( file, "\n  }" );
+  }
+  fprintf( file, "\n}\n" );
+
+  fclose( file );
+  return true;
+}
+
+bool DFGNotificationProfiler::dumpCSV( char const *filePath ) const
+{
+  FILE *file = fopen( filePath, "wb" );
+  if ( !file )
+  {
+    printf(
+      "DFGNotificationProfiler: unable to open '%s' for writing\n",
+      filePath
+      );
+    return false;
+  }
+
+  fprintf( file, "desc,phase,count,meanMS,p50MS,p95MS,p99MS,maxMS\n" );
+  for ( std::map<std::string, Entry>::const_iterator it = m_entries.begin();
+    it != m_entries.end(); ++it )
+  {
+    for ( int phase = 0; phase < PhaseCount; ++phase )
+    {
+      Histogram const &histogram = it->second.histograms[phase];
+      if ( histogram.empty() )
+        continue;
+      Stats stats;
+      histogram.getStats( stats );
+      fprintf(
+        file,
+        "%s,%s,%u,%.6f,%.6f,%.6f,%.6f,%.6f\n",
+        it->first.c_str(),
+        GetPhaseName( Phase( phase ) ),
+        unsigned( stats.count ),
+        stats.mean * 1e3,
+        stats.p50 * 1e3,
+        stats.p95 * 1e3,
+        stats.p99 * 1e3,
+        stats.max * 1e3
+        );
+    }
+  }
+
+  fclose( file );
+  return true;
+}
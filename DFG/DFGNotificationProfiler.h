@@ -0,0 +1,124 @@
+// Copyright 2010-2015 Fabric Software Inc. All rights reserved.
+
+#ifndef __UI_DFG_DFGNotificationProfiler__
+#define __UI_DFG_DFGNotificationProfiler__
+
+#include <FTL/StrRef.h>
+
+#include <map>
+#include <string>
+#include <vector>
+
+namespace FabricUI
+{
+
+  namespace DFG
+  {
+
+    // Collects, per notification desc, latency histograms for the three
+    // phases a notification goes through:
+    //
+    //   Phase_Decode   scanning the notification JSON
+    //   Phase_Handler  running the router handler
+    //   Phase_Scene    painting the graph view afterwards
+    //
+    // A view paint is attributed to every desc handled since the
+    // previous paint.  Unlike the FABRICUI_TIMERS timers it is switched
+    // on at runtime and costs a single branch while disabled.
+    class DFGNotificationProfiler
+    {
+    public:
+
+      enum Phase
+      {
+        Phase_Decode,
+        Phase_Handler,
+        Phase_Scene,
+        PhaseCount
+      };
+
+      struct Stats
+      {
+        size_t count;
+        // all in seconds
+        double mean;
+        double max;
+        double p50;
+        double p95;
+        double p99;
+      };
+
+      DFGNotificationProfiler();
+
+      bool isEnabled() const
+        { return m_enabled; }
+      void setEnabled( bool enabled );
+
+      void reset();
+
+      void addSample( FTL::StrRef desc, Phase phase, double seconds );
+
+      // remembers that desc was handled, so the next paint is attributed
+      // to it; hasPendingScene() tells if a paint needs to be timed
+      void addPendingScene( FTL::StrRef desc );
+      bool hasPendingScene() const
+        { return !m_pendingSceneDescs.empty(); }
+      void addScenePaint( double seconds );
+
+      // the descs for which samples were collected, sorted
+      std::vector<std::string> descs() const;
+      // returns false if no sample was collected for desc and phase
+      bool getStats( FTL::StrRef desc, Phase phase, Stats &stats ) const;
+
+      static char const *GetPhaseName( Phase phase );
+
+      // one entry per desc and phase; return false if the file
+      // cannot be written
+      bool dumpJSON( char const *filePath ) const;
+      bool dumpCSV( char const *filePath ) const;
+
+    private:
+
+      // Log-scale histogram: bucket i holds the samples between
+      // 2^(i/4) and 2^((i+1)/4) microseconds, so percentiles are exact
+      // to within 19% while using a fixed amount of memory.
+      class Histogram
+      {
+      public:
+
+        enum { BucketCount = 104 };
+
+        Histogram();
+
+        void add( double seconds );
+        bool empty() const
+          { return m_count == 0; }
+        void getStats( Stats &stats ) const;
+
+      private:
+
+        double percentile( double fraction ) const;
+
+        size_t m_buckets[BucketCount];
+        size_t m_count;
+        double m_sum;
+        double m_max;
+      };
+
+      struct Entry
+      {
+        Histogram histograms[PhaseCount];
+      };
+
+      Entry &entry( FTL::StrRef desc );
+
+      bool m_enabled;
+      std::map<std::string, Entry> m_entries;
+      std::vector<std::string> m_pendingSceneDescs;
+    };
+
+  };
+
+};
+
+#endif // __UI_DFG_DFGNotificationProfiler__
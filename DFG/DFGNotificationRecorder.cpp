@@ -0,0 +1,323 @@
+// Copyright 2010-2015 Fabric Software Inc. All rights reserved.
+
+#include <FabricUI/DFG/DFGNotificationRecorder.h>
+#include <FabricUI/Util/Ticks.h>
+#include <FTL/JSONEnc.h>
+
+using namespace FabricUI;
+using namespace FabricUI::DFG;
+
+DFGNotificationRecorder::DFGNotificationRecorder()
+  : m_file( NULL )
+  , m_startTicks( 0 )
+{
+}
+
+DFGNotificationRecorder::~DFGNotificationRecorder()
+{
+  close();
+}
+
+bool DFGNotificationRecorder::open( char const *filePath )
+{
+  close();
+
+  m_file = fopen( filePath, "wb" );
+  if ( !m_file )
+  {
+    printf(
+      "DFGNotificationRecorder: unable to open '%s' for writing\n",
+      filePath
+      );
+    return false;
+  }
+
+  m_startTicks = Util::GetCurrentTicks();
+  return true;
+}
+
+void DFGNotificationRecorder::close()
+{
+  if ( !m_file )
+    return;
+  fclose( m_file );
+  m_file = NULL;
+}
+
+void DFGNotificationRecorder::recordExec( FTL::StrRef execPath )
+{
+  if ( !m_file )
+    return;
+  fputs( "# exec ", m_file );
+  fwrite( execPath.data(), 1, execPath.size(), m_file );
+  fputc( '\n', m_file );
+}
+
+void DFGNotificationRecorder::recordDesc( FTL::StrRef desc )
+{
+  if ( !m_file )
+    return;
+  fputs( "# desc ", m_file );
+  writeLine( desc );
+}
+
+void DFGNotificationRecorder::recordFlush()
+{
+  if ( !m_file )
+    return;
+  fputs( "# flush\n", m_file );
+}
+
+void DFGNotificationRecorder::record( FTL::StrRef jsonStr )
+{
+  if ( !m_file )
+    return;
+
+  double seconds = Util::GetSecondsBetweenTicks(
+    m_startTicks, Util::GetCurrentTicks()
+    );
+  fprintf( m_file, "%.6f ", seconds );
+  writeLine( jsonStr );
+}
+
+void DFGNotificationRecorder::recordAnswer(
+  std::vector<std::string> const &fields
+  )
+{
+  if ( !m_file )
+    return;
+
+  std::string json;
+  {
+    FTL::JSONEnc<> enc( json );
+    FTL::JSONArrayEnc<> arrayEnc( enc );
+    for ( size_t i = 0; i < fields.size(); ++i )
+    {
+      FTL::JSONEnc<> fieldEnc( arrayEnc );
+      FTL::JSONStringEnc<> fieldStringEnc(
+        fieldEnc,
+        FTL::StrRef( fields[i].data(), fields[i].size() )
+        );
+    }
+  }
+
+  fputs( "? ", m_file );
+  writeLine( json );
+}
+
+void DFGNotificationRecorder::writeLine( FTL::StrRef jsonStr )
+{
+  // raw line breaks can only be whitespace between JSON tokens, so
+  // replacing them keeps one entry per line
+  char const *data = jsonStr.data();
+  size_t size = jsonStr.size();
+  size_t begin = 0;
+  for ( size_t i = 0; i < size; ++i )
+  {
+    if ( data[i] != '\n' && data[i] != '\r' )
+      continue;
+    fwrite( data + begin, 1, i - begin, m_file );
+    fputc( ' ', m_file );
+    begin = i + 1;
+  }
+  fwrite( data + begin, 1, size - begin, m_file );
+  fputc( '\n', m_file );
+}
+
+// numbers and enums are recorded as their decimal value
+static std::string FormatUInt( unsigned value )
+{
+  char buffer[16];
+  sprintf( buffer, "%u", value );
+  return buffer;
+}
+
+void DFGExecRecordingSource::recordAnswer(
+  char const *query,
+  FTL::StrRef answer
+  )
+{
+  std::vector<std::string> fields( 2 );
+  fields[0] = query;
+  fields[1].assign( answer.data(), answer.size() );
+  m_recorder->recordAnswer( fields );
+}
+
+void DFGExecRecordingSource::recordAnswer(
+  char const *query,
+  FTL::StrRef arg0,
+  FTL::StrRef answer
+  )
+{
+  std::vector<std::string> fields( 3 );
+  fields[0] = query;
+  fields[1].assign( arg0.data(), arg0.size() );
+  fields[2].assign( answer.data(), answer.size() );
+  m_recorder->recordAnswer( fields );
+}
+
+void DFGExecRecordingSource::recordAnswer(
+  char const *query,
+  FTL::StrRef arg0,
+  FTL::StrRef arg1,
+  FTL::StrRef answer
+  )
+{
+  std::vector<std::string> fields( 4 );
+  fields[0] = query;
+  fields[1].assign( arg0.data(), arg0.size() );
+  fields[2].assign( arg1.data(), arg1.size() );
+  fields[3].assign( answer.data(), answer.size() );
+  m_recorder->recordAnswer( fields );
+}
+
+void DFGExecRecordingSource::recordAnswer(
+  char const *query,
+  FTL::StrRef arg0,
+  FTL::StrRef arg1,
+  FTL::StrRef arg2,
+  FTL::StrRef answer
+  )
+{
+  std::vector<std::string> fields( 5 );
+  fields[0] = query;
+  fields[1].assign( arg0.data(), arg0.size() );
+  fields[2].assign( arg1.data(), arg1.size() );
+  fields[3].assign( arg2.data(), arg2.size() );
+  fields[4].assign( answer.data(), answer.size() );
+  m_recorder->recordAnswer( fields );
+}
+
+FabricCore::DFGExecType DFGExecRecordingSource::getExecType()
+{
+  FabricCore::DFGExecType execType = m_source->getExecType();
+  recordAnswer( "getExecType", FormatUInt( unsigned( execType ) ) );
+  return execType;
+}
+
+FabricCore::DFGNodeType DFGExecRecordingSource::getNodeType(
+  FTL::CStrRef nodeName
+  )
+{
+  FabricCore::DFGNodeType nodeType = m_source->getNodeType( nodeName );
+  recordAnswer(
+    "getNodeType",
+    nodeName,
+    FormatUInt( unsigned( nodeType ) )
+    );
+  return nodeType;
+}
+
+bool DFGExecRecordingSource::instExecIsPreset( FTL::CStrRef nodeName )
+{
+  bool isPreset = m_source->instExecIsPreset( nodeName );
+  recordAnswer( "instExecIsPreset", nodeName, FormatUInt( isPreset ) );
+  return isPreset;
+}
+
+std::string DFGExecRecordingSource::getRefVarPath( FTL::CStrRef nodeName )
+{
+  std::string varPath = m_source->getRefVarPath( nodeName );
+  recordAnswer( "getRefVarPath", nodeName, varPath );
+  return varPath;
+}
+
+std::string DFGExecRecordingSource::getNodeMetadata(
+  FTL::CStrRef nodeName,
+  FTL::CStrRef key
+  )
+{
+  std::string value = m_source->getNodeMetadata( nodeName, key );
+  recordAnswer( "getNodeMetadata", nodeName, key, value );
+  return value;
+}
+
+std::string DFGExecRecordingSource::getInstExecMetadata(
+  FTL::CStrRef nodeName,
+  FTL::CStrRef key
+  )
+{
+  std::string value = m_source->getInstExecMetadata( nodeName, key );
+  recordAnswer( "getInstExecMetadata", nodeName, key, value );
+  return value;
+}
+
+std::string DFGExecRecordingSource::getInstExecPortMetadata(
+  FTL::CStrRef nodeName,
+  FTL::CStrRef portName,
+  FTL::CStrRef key
+  )
+{
+  std::string value =
+    m_source->getInstExecPortMetadata( nodeName, portName, key );
+  recordAnswer( "getInstExecPortMetadata", nodeName, portName, key, value );
+  return value;
+}
+
+std::string DFGExecRecordingSource::getExecPortMetadata(
+  FTL::CStrRef portName,
+  FTL::CStrRef key
+  )
+{
+  std::string value = m_source->getExecPortMetadata( portName, key );
+  recordAnswer( "getExecPortMetadata", portName, key, value );
+  return value;
+}
+
+std::string DFGExecRecordingSource::getInstExecTitle( FTL::CStrRef nodeName )
+{
+  std::string title = m_source->getInstExecTitle( nodeName );
+  recordAnswer( "getInstExecTitle", nodeName, title );
+  return title;
+}
+
+unsigned DFGExecRecordingSource::getExecPortCount()
+{
+  unsigned count = m_source->getExecPortCount();
+  recordAnswer( "getExecPortCount", FormatUInt( count ) );
+  return count;
+}
+
+std::string DFGExecRecordingSource::getExecPortName( unsigned index )
+{
+  std::string portName = m_source->getExecPortName( index );
+  recordAnswer( "getExecPortName", FormatUInt( index ), portName );
+  return portName;
+}
+
+FabricCore::DFGPortType DFGExecRecordingSource::getExecPortType(
+  unsigned index
+  )
+{
+  FabricCore::DFGPortType portType = m_source->getExecPortType( index );
+  recordAnswer(
+    "getExecPortType",
+    FormatUInt( index ),
+    FormatUInt( unsigned( portType ) )
+    );
+  return portType;
+}
+
+unsigned DFGExecRecordingSource::getInstExecPortCount(
+  FTL::CStrRef nodeName
+  )
+{
+  unsigned count = m_source->getInstExecPortCount( nodeName );
+  recordAnswer( "getInstExecPortCount", nodeName, FormatUInt( count ) );
+  return count;
+}
+
+std::string DFGExecRecordingSource::getInstExecPortName(
+  FTL::CStrRef nodeName,
+  unsigned index
+  )
+{
+  std::string portName = m_source->getInstExecPortName( nodeName, index );
+  recordAnswer(
+    "getInstExecPortName",
+    nodeName,
+    FormatUInt( index ),
+    portName
+    );
+  return portName;
+}
@@ -0,0 +1,148 @@
+// Copyright 2010-2015 Fabric Software Inc. All rights reserved.
+
+#ifndef __UI_DFG_DFGNotificationRecorder__
+#define __UI_DFG_DFGNotificationRecorder__
+
+#include <FabricUI/DFG/DFGExecBuildPlan.h>
+#include <FTL/StrRef.h>
+
+#include <QtCore/QSharedPointer>
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+namespace FabricUI
+{
+
+  namespace DFG
+  {
+
+    // Writes the core notifications received by the router to a file,
+    // one per line, prefixed with the number of seconds elapsed since the
+    // recording started:
+    //
+    //   # exec <execPath>
+    //   # desc {"objectType":"Graph",...}
+    //   0.000125 {"desc":"nodeInserted",...}
+    //   ? ["getNodeType","add","0"]
+    //   # flush
+    //
+    // Lines starting with '#' are annotations: the exec the router
+    // switched to and its description, and the points at which the
+    // router applied its queued notifications.  Lines starting with '?'
+    // are the answers the router got from the exec while handling them,
+    // as a JSON array of the query, its arguments and the answer.
+    // Recordings are played back with DFGNotificationPlayer.
+    class DFGNotificationRecorder
+    {
+    public:
+
+      DFGNotificationRecorder();
+      ~DFGNotificationRecorder();
+
+      bool open( char const *filePath );
+      void close();
+      bool isOpen() const
+        { return m_file != NULL; }
+
+      void recordExec( FTL::StrRef execPath );
+      void recordDesc( FTL::StrRef desc );
+      void recordFlush();
+      void record( FTL::StrRef jsonStr );
+      // the query and its arguments, followed by the answer
+      void recordAnswer( std::vector<std::string> const &fields );
+
+    private:
+
+      DFGNotificationRecorder( DFGNotificationRecorder const & );
+      DFGNotificationRecorder &operator=( DFGNotificationRecorder const & );
+
+      // writes the JSON on a single line
+      void writeLine( FTL::StrRef jsonStr );
+
+      FILE *m_file;
+      uint64_t m_startTicks;
+    };
+
+    // Forwards the queries to another source and records their answers,
+    // so that a DFGNotificationPlayer can answer them without the exec.
+    // Queries that throw are not recorded.
+    class DFGExecRecordingSource : public DFGExecBuildSource
+    {
+    public:
+
+      DFGExecRecordingSource(
+        QSharedPointer<DFGExecBuildSource> source,
+        DFGNotificationRecorder *recorder
+        )
+        : m_source( source )
+        , m_recorder( recorder )
+        {}
+
+      virtual FabricCore::DFGExecType getExecType();
+      virtual FabricCore::DFGNodeType getNodeType( FTL::CStrRef nodeName );
+      virtual bool instExecIsPreset( FTL::CStrRef nodeName );
+      virtual std::string getRefVarPath( FTL::CStrRef nodeName );
+      virtual std::string getNodeMetadata(
+        FTL::CStrRef nodeName,
+        FTL::CStrRef key
+        );
+      virtual std::string getInstExecMetadata(
+        FTL::CStrRef nodeName,
+        FTL::CStrRef key
+        );
+      virtual std::string getInstExecPortMetadata(
+        FTL::CStrRef nodeName,
+        FTL::CStrRef portName,
+        FTL::CStrRef key
+        );
+      virtual std::string getExecPortMetadata(
+        FTL::CStrRef portName,
+        FTL::CStrRef key
+        );
+      virtual std::string getInstExecTitle( FTL::CStrRef nodeName );
+      virtual unsigned getExecPortCount();
+      virtual std::string getExecPortName( unsigned index );
+      virtual FabricCore::DFGPortType getExecPortType( unsigned index );
+      virtual unsigned getInstExecPortCount( FTL::CStrRef nodeName );
+      virtual std::string getInstExecPortName(
+        FTL::CStrRef nodeName,
+        unsigned index
+        );
+
+    private:
+
+      void recordAnswer(
+        char const *query,
+        FTL::StrRef answer
+        );
+      void recordAnswer(
+        char const *query,
+        FTL::StrRef arg0,
+        FTL::StrRef answer
+        );
+      void recordAnswer(
+        char const *query,
+        FTL::StrRef arg0,
+        FTL::StrRef arg1,
+        FTL::StrRef answer
+        );
+      void recordAnswer(
+        char const *query,
+        FTL::StrRef arg0,
+        FTL::StrRef arg1,
+        FTL::StrRef arg2,
+        FTL::StrRef answer
+        );
+
+      QSharedPointer<DFGExecBuildSource> m_source;
+      DFGNotificationRecorder *m_recorder;
+    };
+
+  };
+
+};
+
+#endif // __UI_DFG_DFGNotificationRecorder__
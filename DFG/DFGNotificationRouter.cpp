@@ -3,12 +3,22 @@
 #include <FabricUI/GraphView/Graph.h>
 #include <FabricUI/GraphView/BackDropNode.h>
 #include <FabricUI/GraphView/NodeBubble.h>
+#include <FabricUI/DFG/DFGNotificationJSON.h>
 #include <FabricUI/DFG/DFGNotificationRouter.h>
+#include <FabricUI/DFG/DFGNotificationRecorder.h>
 #include <FabricUI/DFG/DFGController.h>
 #include <FabricUI/DFG/DFGWidget.h>
+#include <FabricUI/Util/Ticks.h>
 
 #include <FTL/JSONValue.h>
 
+#include <QtCore/QTimer>
+#include <QtCore/QtConcurrentRun>
+#include <QtGui/QGraphicsView>
+
+#include <assert.h>
+#include <math.h>
+
 using namespace FabricServices;
 using namespace FabricUI;
 using namespace FabricUI::DFG;
@@ -20,21 +30,112 @@ DFGNotificationRouter::DFGNotificationRouter(
   : m_dfgController( dfgController )
   , m_config( config )
   , m_performChecks( true )
+  , m_replaying( false )
+  , m_coalesceNotifications( true )
+  , m_flushPending( false )
+  , m_buildPlanPending( false )
+  , m_buildPlanRestarts( 0 )
+  , m_buildPlanQueuedCount( 0 )
+  , m_buildPlanWatcher( 0 )
 {
+  registerBuiltinNotificationHandlers();
   onExecChanged();
 }
 
+DFGNotificationRouter::~DFGNotificationRouter()
+{
+  cancelBuildPlan();
+  clearQueuedNotifications();
+}
+
 void DFGNotificationRouter::onExecChanged()
 {
+  // queued notifications and pending plans refer to the previous exec
+  cancelBuildPlan();
+  clearQueuedNotifications();
+
   FabricCore::DFGExec &exec = m_dfgController->getExec();
   if ( exec )
     m_coreDFGView = exec.createView( &Callback, this );
   else
     m_coreDFGView = FabricCore::DFGView();
+
+  if ( DFGNotificationRecorder *recorder = notificationRecorder() )
+    recorder->recordExec( m_dfgController->getExecPath() );
+}
+
+void DFGNotificationRouter::beginReplay(
+  QSharedPointer<DFGExecBuildSource> source
+  )
+{
+  m_execSource = source;
+  m_replaying = true;
+}
+
+void DFGNotificationRouter::endReplay()
+{
+  m_execSource.clear();
+  m_replaying = false;
+}
+
+QSharedPointer<DFGExecBuildSource> DFGNotificationRouter::execSource()
+{
+  QSharedPointer<DFGExecBuildSource> source = m_execSource;
+  if ( !source )
+  {
+    FabricCore::DFGExec &exec = m_dfgController->getExec();
+    if ( !exec )
+      return QSharedPointer<DFGExecBuildSource>();
+    source = QSharedPointer<DFGExecBuildSource>(
+      new DFGExecBuildCoreSource( exec )
+      );
+  }
+
+  if ( DFGNotificationRecorder *recorder = notificationRecorder() )
+  {
+    if ( recorder->isOpen() )
+      source = QSharedPointer<DFGExecBuildSource>(
+        new DFGExecRecordingSource( source, recorder )
+        );
+  }
+  return source;
+}
+
+DFGNotificationRecorder *DFGNotificationRouter::notificationRecorder() const
+{
+  if ( m_replaying )
+    return 0;
+  return m_dfgController->notificationRecorder();
+}
+
+void DFGNotificationRouter::setCoalesceNotifications( bool coalesce )
+{
+  if ( m_coalesceNotifications == coalesce )
+    return;
+  m_coalesceNotifications = coalesce;
+  if ( !m_coalesceNotifications
+    && !m_dfgController->isInNotificationBracket() )
+    flushNotifications();
 }
 
 void DFGNotificationRouter::callback( FTL::CStrRef jsonStr )
 {
+  if ( DFGNotificationRecorder *recorder = notificationRecorder() )
+    recorder->record( jsonStr );
+
+  handleNotification( jsonStr );
+}
+
+void DFGNotificationRouter::handleNotification( FTL::CStrRef jsonStr )
+{
+  if ( m_coalesceNotifications
+    || m_buildPlanPending
+    || m_dfgController->isInNotificationBracket() )
+  {
+    queueNotification( jsonStr );
+    return;
+  }
+
   try
   {
     // printf( "notif = %s\n", jsonStr.c_str() );
@@ -44,542 +145,1474 @@ void DFGNotificationRouter::callback( FTL::CStrRef jsonStr )
 
     onNotification(jsonStr);
 
-    FTL::JSONStrWithLoc jsonStrWithLoc( jsonStr );
-    FTL::OwnedPtr<FTL::JSONObject> jsonObject(
-      FTL::JSONValue::Decode( jsonStrWithLoc )->cast<FTL::JSONObject>()
-      );
-    FTL::StrRef descStr = jsonObject->getString( FTL_STR("desc") );
-
-    if(descStr == FTL_STR("nodeInserted"))
-    {
-      onNodeInserted(
-        jsonObject->getString( FTL_STR("nodeName") ),
-        jsonObject->get( FTL_STR("nodeDesc") )->cast<FTL::JSONObject>()
-        );
-    }
-    else if(descStr == FTL_STR("nodeRemoved"))
+    DFGNotificationProfiler &profiler =
+      m_dfgController->notificationProfiler();
+    if ( profiler.isEnabled() )
     {
-      onNodeRemoved(
-        jsonObject->getString( FTL_STR("nodeName") )
+      uint64_t startTicks = Util::GetCurrentTicks();
+      DFGNotificationJSON notification( jsonStr );
+      profiler.addSample(
+        notification.getDesc(),
+        DFGNotificationProfiler::Phase_Decode,
+        Util::GetSecondsBetweenTicks( startTicks, Util::GetCurrentTicks() )
         );
+      dispatch( notification );
     }
-    else if(descStr == FTL_STR("nodePortInserted"))
+    else
     {
-      onNodePortInserted(
-        jsonObject->getString( FTL_STR("nodeName") ),
-        jsonObject->getString( FTL_STR("portName") ),
-        jsonObject->get( FTL_STR("nodePortDesc") )->cast<FTL::JSONObject>()
-        );
+      DFGNotificationJSON notification( jsonStr );
+      dispatch( notification );
     }
-    else if(descStr == FTL_STR("nodePortRemoved"))
-    {
-      onNodePortRemoved(
-        jsonObject->getString( FTL_STR("nodeName") ),
-        jsonObject->getString( FTL_STR("portName") )
+  }
+  catch ( FabricCore::Exception e )
+  {
+    printf(
+      "NotificationRouter::callback: caught Core exception: %s\n",
+      e.getDesc_cstr()
+      );
+  }
+  catch ( FTL::JSONException e )
+  {
+    printf(
+      "NotificationRouter::callback: caught FTL::JSONException: %s\n",
+      e.getDescCStr()
+      );
+  }
+}
+
+static bool DescHasPrefix( FTL::StrRef desc, FTL::StrRef prefix )
+{
+  return desc.size() >= prefix.size()
+    && FTL::StrRef( desc.data(), prefix.size() ) == prefix;
+}
+
+static std::string MakePortPath(
+  FTL::StrRef nodeName,
+  FTL::StrRef portName
+  )
+{
+  std::string portPath;
+  if ( !nodeName.empty() )
+  {
+    portPath.append( nodeName.data(), nodeName.size() );
+    portPath += '.';
+  }
+  portPath.append( portName.data(), portName.size() );
+  return portPath;
+}
+
+static void GetNotificationNodeNames(
+  DFGNotificationJSON const &notification,
+  std::vector<std::string> &nodeNames
+  )
+{
+  FTL::CStrRef descStr = notification.getDesc();
+
+  FTL::CStrRef nodeName;
+  if ( notification.maybeGetString( FTL_STR("nodeName"), nodeName )
+    || notification.maybeGetString( FTL_STR("instName"), nodeName )
+    || notification.maybeGetString( FTL_STR("refName"), nodeName ) )
+    nodeNames.push_back( nodeName );
+
+  if ( descStr == FTL_STR("nodeRenamed") )
+  {
+    nodeNames.push_back( notification.getString( FTL_STR("oldNodeName") ) );
+    nodeNames.push_back( notification.getString( FTL_STR("newNodeName") ) );
+  }
+  else if ( descStr == FTL_STR("portsConnected")
+    || descStr == FTL_STR("portsDisconnected") )
+  {
+    std::pair<FTL::StrRef, FTL::CStrRef> srcSplit =
+      notification.getString( FTL_STR("srcPath") ).split('.');
+    if ( !srcSplit.second.empty() )
+      nodeNames.push_back( srcSplit.first );
+    std::pair<FTL::StrRef, FTL::CStrRef> dstSplit =
+      notification.getString( FTL_STR("dstPath") ).split('.');
+    if ( !dstSplit.second.empty() )
+      nodeNames.push_back( dstSplit.first );
+  }
+}
+
+// the ports touched by a notification, as "node.port" for node ports and
+// "port" for exec ports
+static void GetNotificationPortPaths(
+  DFGNotificationJSON const &notification,
+  std::vector<std::string> &portPaths
+  )
+{
+  FTL::CStrRef descStr = notification.getDesc();
+
+  if ( descStr == FTL_STR("portsConnected")
+    || descStr == FTL_STR("portsDisconnected") )
+  {
+    portPaths.push_back( notification.getString( FTL_STR("srcPath") ) );
+    portPaths.push_back( notification.getString( FTL_STR("dstPath") ) );
+    return;
+  }
+
+  FTL::CStrRef nodeName;
+  if ( DescHasPrefix( descStr, FTL_STR("nodePort") ) )
+    nodeName = notification.getString( FTL_STR("nodeName") );
+  else if ( !DescHasPrefix( descStr, FTL_STR("execPort") ) )
+    return;
+
+  FTL::CStrRef portName;
+  if ( notification.maybeGetString( FTL_STR("portName"), portName ) )
+    portPaths.push_back( MakePortPath( nodeName, portName ) );
+  if ( notification.maybeGetString( FTL_STR("oldPortName"), portName ) )
+    portPaths.push_back( MakePortPath( nodeName, portName ) );
+  if ( notification.maybeGetString( FTL_STR("newPortName"), portName ) )
+    portPaths.push_back( MakePortPath( nodeName, portName ) );
+}
+
+static bool NotificationTouches(
+  std::vector<std::string> const &names,
+  FTL::StrRef name
+  )
+{
+  for ( size_t i = 0; i < names.size(); ++i )
+  {
+    if ( name == names[i] )
+      return true;
+  }
+  return false;
+}
+
+static void RenameInNames(
+  std::vector<std::string> &names,
+  std::string const &oldName,
+  std::string const &newName
+  )
+{
+  for ( size_t i = 0; i < names.size(); ++i )
+  {
+    if ( names[i] == oldName )
+      names[i] = newName;
+  }
+}
+
+// Erases the entries of a queue index whose key is name or starts with
+// name followed by a '.'
+static void EraseQueuedIndicesOf(
+  std::map<std::string, size_t> &indices,
+  std::string const &name
+  )
+{
+  std::map<std::string, size_t>::iterator it = indices.lower_bound( name );
+  while ( it != indices.end()
+    && it->first.compare( 0, name.size(), name ) == 0 )
+  {
+    if ( it->first.size() == name.size() || it->first[name.size()] == '.' )
+      indices.erase( it++ );
+    else
+      ++it;
+  }
+}
+
+// Re-keys the same entries as EraseQueuedIndicesOf under newName
+static void RenameQueuedIndicesOf(
+  std::map<std::string, size_t> &indices,
+  std::string const &oldName,
+  std::string const &newName
+  )
+{
+  std::vector< std::pair<std::string, size_t> > renamed;
+  std::map<std::string, size_t>::iterator it = indices.lower_bound( oldName );
+  while ( it != indices.end()
+    && it->first.compare( 0, oldName.size(), oldName ) == 0 )
+  {
+    if ( it->first.size() == oldName.size()
+      || it->first[oldName.size()] == '.' )
+    {
+      renamed.push_back(
+        std::pair<std::string, size_t>(
+          newName + it->first.substr( oldName.size() ),
+          it->second
+          )
         );
+      indices.erase( it++ );
     }
-    else if(descStr == FTL_STR("execPortInserted"))
-    {
-      onExecPortInserted(
-        jsonObject->getString( FTL_STR("portName") ),
-        jsonObject->get( FTL_STR("execPortDesc") )->cast<FTL::JSONObject>()
+    else
+      ++it;
+  }
+  for ( size_t i = 0; i < renamed.size(); ++i )
+    indices[renamed[i].first] = renamed[i].second;
+}
+
+void DFGNotificationRouter::renameQueuedNode(
+  QueuedNotification &queued,
+  std::string const &oldNodeName,
+  std::string const &newNodeName
+  )
+{
+  DFGNotificationJSON &notification = *queued.notification;
+
+  static char const *nameKeys[3] = { "nodeName", "instName", "refName" };
+  for ( size_t i = 0; i < 3; ++i )
+  {
+    FTL::StrRef key( nameKeys[i] );
+    FTL::CStrRef value;
+    if ( notification.maybeGetString( key, value ) && value == oldNodeName )
+      notification.replaceString( key, newNodeName );
+  }
+
+  static char const *pathKeys[2] = { "srcPath", "dstPath" };
+  for ( size_t i = 0; i < 2; ++i )
+  {
+    FTL::StrRef key( pathKeys[i] );
+    FTL::CStrRef value;
+    if ( !notification.maybeGetString( key, value ) )
+      continue;
+    std::pair<FTL::StrRef, FTL::CStrRef> split = value.split('.');
+    if ( split.second.empty() || split.first != oldNodeName )
+      continue;
+    std::string path = MakePortPath( newNodeName, split.second );
+    notification.replaceString( key, path );
+  }
+
+  RenameInNames( queued.nodeNames, oldNodeName, newNodeName );
+  for ( size_t i = 0; i < queued.portPaths.size(); ++i )
+  {
+    std::string &portPath = queued.portPaths[i];
+    if ( portPath.size() > oldNodeName.size()
+      && portPath[oldNodeName.size()] == '.'
+      && portPath.compare( 0, oldNodeName.size(), oldNodeName ) == 0 )
+      portPath = newNodeName + portPath.substr( oldNodeName.size() );
+  }
+}
+
+void DFGNotificationRouter::renameQueuedPort(
+  QueuedNotification &queued,
+  FTL::StrRef nodeName,
+  std::string const &oldPortName,
+  std::string const &newPortName
+  )
+{
+  std::string oldPortPath = MakePortPath( nodeName, oldPortName );
+  if ( !NotificationTouches( queued.portPaths, oldPortPath ) )
+    return;
+  std::string newPortPath = MakePortPath( nodeName, newPortName );
+
+  DFGNotificationJSON &notification = *queued.notification;
+
+  // exec port notifications have no node name
+  FTL::CStrRef queuedNodeName =
+    notification.getStringOrEmpty( FTL_STR("nodeName") );
+  FTL::CStrRef portName;
+  if ( queuedNodeName == nodeName
+    && notification.maybeGetString( FTL_STR("portName"), portName )
+    && portName == oldPortName )
+    notification.replaceString( FTL_STR("portName"), newPortName );
+
+  static char const *pathKeys[2] = { "srcPath", "dstPath" };
+  for ( size_t i = 0; i < 2; ++i )
+  {
+    FTL::StrRef key( pathKeys[i] );
+    FTL::CStrRef value;
+    if ( notification.maybeGetString( key, value ) && value == oldPortPath )
+      notification.replaceString( key, newPortPath );
+  }
+
+  RenameInNames( queued.portPaths, oldPortPath, newPortPath );
+}
+
+void DFGNotificationRouter::queueNotification( FTL::CStrRef jsonStr )
+{
+  try
+  {
+    onNotification(jsonStr);
+
+    DFGNotificationProfiler &profiler =
+      m_dfgController->notificationProfiler();
+    uint64_t startTicks = profiler.isEnabled() ? Util::GetCurrentTicks() : 0;
+
+    FTL::OwnedPtr<DFGNotificationJSON> notification(
+      new DFGNotificationJSON( jsonStr )
+      );
+    FTL::CStrRef descStr = notification->getDesc();
+
+    if ( profiler.isEnabled() )
+      profiler.addSample(
+        descStr,
+        DFGNotificationProfiler::Phase_Decode,
+        Util::GetSecondsBetweenTicks( startTicks, Util::GetCurrentTicks() )
         );
-    }
-    else if(descStr == FTL_STR("execPortRemoved"))
+
+    std::vector<std::string> nodeNames;
+    GetNotificationNodeNames( *notification, nodeNames );
+    std::vector<std::string> portPaths;
+    GetNotificationPortPaths( *notification, portPaths );
+
+    if ( descStr == FTL_STR("removedFromOwner") )
     {
-      onExecPortRemoved(
-        jsonObject->getString( FTL_STR("portName") )
-        );
+      // nothing queued so far matters anymore
+      clearQueuedNotifications();
     }
-    else if(descStr == FTL_STR("portsConnected"))
+    else if ( descStr == FTL_STR("nodeRemoved") )
     {
-      onPortsConnected(
-        jsonObject->getString( FTL_STR("srcPath") ),
-        jsonObject->getString( FTL_STR("dstPath") )
-        );
+      std::string nodeName = notification->getString( FTL_STR("nodeName") );
+
+      std::map<std::string, size_t>::iterator metadataIt =
+        m_queuedMetadata.begin();
+      while ( metadataIt != m_queuedMetadata.end() )
+      {
+        if ( NotificationTouches(
+          m_queuedNotifications[metadataIt->second].nodeNames, nodeName ) )
+          m_queuedMetadata.erase( metadataIt++ );
+        else
+          ++metadataIt;
+      }
+      EraseQueuedIndicesOf( m_queuedPortInserts, nodeName );
+
+      // an insertion followed by a removal cancels out, together with
+      // everything that happened to the node in between
+      std::map<std::string, size_t>::iterator insertIt =
+        m_queuedNodeInserts.find( nodeName );
+      if ( insertIt != m_queuedNodeInserts.end() )
+      {
+        for ( size_t i = insertIt->second;
+          i < m_queuedNotifications.size(); ++i )
+        {
+          QueuedNotification &queued = m_queuedNotifications[i];
+          if ( NotificationTouches( queued.nodeNames, nodeName ) )
+            queued.cancelled = true;
+        }
+        m_queuedNodeInserts.erase( insertIt );
+        return;
+      }
     }
-    else if(descStr == FTL_STR("portsDisconnected"))
+    else if ( descStr == FTL_STR("nodeRenamed") )
     {
-      onPortsDisconnected(
-        jsonObject->getString( FTL_STR("srcPath") ),
-        jsonObject->getString( FTL_STR("dstPath") )
-        );
+      std::string oldNodeName =
+        notification->getString( FTL_STR("oldNodeName") );
+      std::string newNodeName =
+        notification->getString( FTL_STR("newNodeName") );
+
+      std::map<std::string, size_t>::iterator metadataIt =
+        m_queuedMetadata.begin();
+      while ( metadataIt != m_queuedMetadata.end() )
+      {
+        std::vector<std::string> const &queuedNodeNames =
+          m_queuedNotifications[metadataIt->second].nodeNames;
+        if ( NotificationTouches( queuedNodeNames, oldNodeName )
+          || NotificationTouches( queuedNodeNames, newNodeName ) )
+          m_queuedMetadata.erase( metadataIt++ );
+        else
+          ++metadataIt;
+      }
+
+      // a node inserted in the same batch is inserted under its final
+      // name instead, the rename itself is dropped
+      std::map<std::string, size_t>::iterator insertIt =
+        m_queuedNodeInserts.find( oldNodeName );
+      if ( insertIt != m_queuedNodeInserts.end() )
+      {
+        for ( size_t i = insertIt->second;
+          i < m_queuedNotifications.size(); ++i )
+        {
+          QueuedNotification &queued = m_queuedNotifications[i];
+          if ( !queued.cancelled
+            && NotificationTouches( queued.nodeNames, oldNodeName ) )
+            renameQueuedNode( queued, oldNodeName, newNodeName );
+        }
+        RenameQueuedIndicesOf( m_queuedNodeInserts, oldNodeName, newNodeName );
+        RenameQueuedIndicesOf( m_queuedPortInserts, oldNodeName, newNodeName );
+        return;
+      }
+
+      EraseQueuedIndicesOf( m_queuedPortInserts, oldNodeName );
     }
-    else if(descStr == FTL_STR("nodeMetadataChanged"))
+    else if ( descStr == FTL_STR("nodePortRemoved")
+      || descStr == FTL_STR("execPortRemoved") )
     {
-      onNodeMetadataChanged(
-        jsonObject->getString( FTL_STR("nodeName") ),
-        jsonObject->getString( FTL_STR("key") ),
-        jsonObject->getString( FTL_STR("value") )
-        );
+      // same as for nodes, an inserted port that is removed again
+      // cancels out with everything that touched it
+      std::map<std::string, size_t>::iterator insertIt =
+        m_queuedPortInserts.find( portPaths[0] );
+      if ( insertIt != m_queuedPortInserts.end() )
+      {
+        for ( size_t i = insertIt->second;
+          i < m_queuedNotifications.size(); ++i )
+        {
+          QueuedNotification &queued = m_queuedNotifications[i];
+          if ( NotificationTouches( queued.portPaths, portPaths[0] ) )
+            queued.cancelled = true;
+        }
+        m_queuedPortInserts.erase( insertIt );
+        return;
+      }
     }
-    else if(descStr == FTL_STR("instExecTitleChanged"))
+    else if ( descStr == FTL_STR("nodePortRenamed")
+      || descStr == FTL_STR("execPortRenamed") )
     {
-      onNodeTitleChanged(
-        jsonObject->getString( FTL_STR("instName") ),
-        jsonObject->getString( FTL_STR("execTitle") )
-        );
+      FTL::CStrRef nodeName =
+        notification->getStringOrEmpty( FTL_STR("nodeName") );
+      std::string oldPortName =
+        notification->getString( FTL_STR("oldPortName") );
+      std::string newPortName =
+        notification->getString( FTL_STR("newPortName") );
+      std::string oldPortPath = MakePortPath( nodeName, oldPortName );
+
+      std::map<std::string, size_t>::iterator insertIt =
+        m_queuedPortInserts.find( oldPortPath );
+      if ( insertIt != m_queuedPortInserts.end() )
+      {
+        for ( size_t i = insertIt->second;
+          i < m_queuedNotifications.size(); ++i )
+        {
+          QueuedNotification &queued = m_queuedNotifications[i];
+          if ( !queued.cancelled )
+            renameQueuedPort( queued, nodeName, oldPortName, newPortName );
+        }
+        size_t index = insertIt->second;
+        m_queuedPortInserts.erase( insertIt );
+        m_queuedPortInserts[MakePortPath( nodeName, newPortName )] = index;
+        return;
+      }
     }
-    else if(descStr == FTL_STR("nodeRenamed"))
+
+    size_t index = m_queuedNotifications.size();
+
+    if ( descStr == FTL_STR("nodeInserted") )
     {
-      onNodeRenamed(
-        jsonObject->getString( FTL_STR("oldNodeName") ),
-        jsonObject->getString( FTL_STR("newNodeName") )
-        );
+      m_queuedNodeInserts[notification->getString( FTL_STR("nodeName") )] =
+        index;
     }
-    else if(descStr == FTL_STR("execPortRenamed"))
+    else if ( descStr == FTL_STR("nodePortInserted")
+      || descStr == FTL_STR("execPortInserted") )
     {
-      onExecPortRenamed(
-        jsonObject->getString( FTL_STR("oldPortName") ),
-        jsonObject->getString( FTL_STR("newPortName") ),
-        jsonObject->get( FTL_STR("execPortDesc") )->cast<FTL::JSONObject>()
-        );
+      m_queuedPortInserts[portPaths[0]] = index;
     }
-    else if(descStr == FTL_STR("nodePortRenamed"))
+    else if ( descStr == FTL_STR("nodeMetadataChanged")
+      || descStr == FTL_STR("execMetadataChanged") )
     {
-      onNodePortRenamed(
-        jsonObject->getString( FTL_STR("nodeName") ),
-        jsonObject->getString( FTL_STR("oldPortName") ),
-        jsonObject->getString( FTL_STR("newPortName") )
-        );
+      // repeated metadata changes collapse to the last value
+      std::string metadataKey = descStr;
+      metadataKey += '|';
+      metadataKey += notification->getStringOrEmpty( FTL_STR("nodeName") );
+      metadataKey += '|';
+      metadataKey += notification->getString( FTL_STR("key") );
+
+      std::map<std::string, size_t>::iterator metadataIt =
+        m_queuedMetadata.find( metadataKey );
+      if ( metadataIt != m_queuedMetadata.end() )
+      {
+        m_queuedNotifications[metadataIt->second].cancelled = true;
+        metadataIt->second = index;
+      }
+      else
+        m_queuedMetadata.insert(
+          std::pair<std::string, size_t>( metadataKey, index )
+          );
     }
-    else if(descStr == FTL_STR("execMetadataChanged"))
+
+    m_queuedNotifications.push_back( QueuedNotification() );
+    QueuedNotification &queued = m_queuedNotifications.back();
+    queued.notification = notification.take();
+    queued.nodeNames.swap( nodeNames );
+    queued.portPaths.swap( portPaths );
+    queued.cancelled = false;
+
+    if ( !m_flushPending
+      && !m_dfgController->isInNotificationBracket() )
     {
-      onExecMetadataChanged(
-        jsonObject->getString( FTL_STR("key") ),
-        jsonObject->getString( FTL_STR("value") )
-        );
+      m_flushPending = true;
+      QTimer::singleShot( 0, this, SLOT(flushNotifications()) );
     }
-    else if(descStr == FTL_STR("extDepAdded"))
+  }
+  catch ( FabricCore::Exception e )
+  {
+    printf(
+      "NotificationRouter::queueNotification: caught Core exception: %s\n",
+      e.getDesc_cstr()
+      );
+  }
+  catch ( FTL::JSONException e )
+  {
+    printf(
+      "NotificationRouter::queueNotification: caught FTL::JSONException: %s\n",
+      e.getDescCStr()
+      );
+  }
+}
+
+void DFGNotificationRouter::clearQueuedNotifications()
+{
+  for ( size_t i = 0; i < m_queuedNotifications.size(); ++i )
+    delete m_queuedNotifications[i].notification;
+  m_queuedNotifications.clear();
+  m_queuedNodeInserts.clear();
+  m_queuedPortInserts.clear();
+  m_queuedMetadata.clear();
+}
+
+void DFGNotificationRouter::flushNotifications()
+{
+  m_flushPending = false;
+
+  // the graph is not built yet, keep the queue for when it is
+  if ( m_queuedNotifications.empty() || m_buildPlanPending )
+    return;
+
+  if ( DFGNotificationRecorder *recorder = notificationRecorder() )
+    recorder->recordFlush();
+
+  std::vector<QueuedNotification> queuedNotifications;
+  queuedNotifications.swap( m_queuedNotifications );
+  m_queuedNodeInserts.clear();
+  m_queuedPortInserts.clear();
+  m_queuedMetadata.clear();
+
+  // removedFromOwner switches the exec, which destroys this
+  // router, so it has to be the last thing we do here.
+  for ( size_t i = 0; i < queuedNotifications.size(); ++i )
+  {
+    if ( queuedNotifications[i].notification->getDesc()
+      == FTL_STR("removedFromOwner") )
     {
-      onExtDepAdded(
-        jsonObject->getString( FTL_STR("name") ),
-        jsonObject->getString( FTL_STR("versionRange") )
-        );
+      for ( size_t j = 0; j < queuedNotifications.size(); ++j )
+        delete queuedNotifications[j].notification;
+      onRemovedFromOwner();
+      return;
     }
-    else if(descStr == FTL_STR("extDepRemoved"))
+  }
+
+  std::vector<QGraphicsView *> suspendedViews;
+  GraphView::Graph *uiGraph = m_dfgController->graph();
+  if ( uiGraph && uiGraph->scene() )
+  {
+    QList<QGraphicsView *> views = uiGraph->scene()->views();
+    for ( int i = 0; i < views.count(); ++i )
     {
-      onExtDepRemoved(
-        jsonObject->getString( FTL_STR("name") ),
-        jsonObject->getString( FTL_STR("versionRange") )
-        );
+      if ( !views[i]->updatesEnabled() )
+        continue;
+      views[i]->setUpdatesEnabled( false );
+      suspendedViews.push_back( views[i] );
     }
-    else if(descStr == FTL_STR("nodeCacheRuleChanged"))
+  }
+
+  {
+    DFGController::UpdateSignalBlocker blocker( m_dfgController );
+
+    for ( size_t i = 0; i < queuedNotifications.size(); ++i )
     {
-      onNodeCacheRuleChanged(
-        jsonObject->getString( FTL_STR("nodeName") ),
-        jsonObject->getString( FTL_STR("cacheRule") )
-        );
+      QueuedNotification &queued = queuedNotifications[i];
+      if ( queued.cancelled )
+        continue;
+
+      try
+      {
+        dispatch( *queued.notification );
+      }
+      catch ( FabricCore::Exception e )
+      {
+        printf(
+          "NotificationRouter::flushNotifications: caught Core exception: %s\n",
+          e.getDesc_cstr()
+          );
+      }
+      catch ( FTL::JSONException e )
+      {
+        printf(
+          "NotificationRouter::flushNotifications: caught FTL::JSONException: %s\n",
+          e.getDescCStr()
+          );
+      }
     }
-    else if(descStr == FTL_STR("execCacheRuleChanged"))
-    {
-      onExecCacheRuleChanged(
-        jsonObject->getString( FTL_STR("cacheRule") )
-        );
-    }
-    else if(descStr == FTL_STR("execPortResolvedTypeChanged"))
-    {
-      onExecPortResolvedTypeChanged(
-        jsonObject->getString( FTL_STR("portName") ),
-        jsonObject->getStringOrEmpty( FTL_STR("newResolvedType") )
-        );
-    }
-    else if(descStr == FTL_STR("execPortTypeSpecChanged"))
-    {
-      onExecPortTypeSpecChanged(
-        jsonObject->getString( FTL_STR("portName") ),
-        jsonObject->getStringOrEmpty( FTL_STR("newTypeSpec") )
-        );
-    }
-    else if(descStr == FTL_STR("nodePortResolvedTypeChanged"))
-    {
-      onNodePortResolvedTypeChanged(
-        jsonObject->getString( FTL_STR("nodeName") ),
-        jsonObject->getString( FTL_STR("portName") ),
-        jsonObject->getStringOrEmpty( FTL_STR("newResolvedType") )
-        );
-    }
-    else if(descStr == FTL_STR("nodePortMetadataChanged"))
-    {
-      onNodePortMetadataChanged(
-        jsonObject->getString( FTL_STR("nodeName") ),
-        jsonObject->getString( FTL_STR("portName") ),
-        jsonObject->getString( FTL_STR("key") ),
-        jsonObject->getString( FTL_STR("value") )
-        );
-    }
-    else if(descStr == FTL_STR("execPortMetadataChanged"))
-    {
-      onExecPortMetadataChanged(
-        jsonObject->getString( FTL_STR("portName") ),
-        jsonObject->getString( FTL_STR("key") ),
-        jsonObject->getString( FTL_STR("value") )
-        );
-    }
-    else if(descStr == FTL_STR("execPortTypeChanged"))
-    {
-      onExecPortTypeChanged(
-        jsonObject->getString( FTL_STR("portName") ),
-        jsonObject->getString( FTL_STR("newExecPortType") )
-        );
-    }
-    else if(descStr == FTL_STR("nodePortTypeChanged"))
-    {
-      onNodePortTypeChanged(
-        jsonObject->getString( FTL_STR("nodeName") ),
-        jsonObject->getString( FTL_STR("portName") ),
-        jsonObject->getString( FTL_STR("newNodePortType") )
-        );
-    }
-    else if(descStr == FTL_STR("refVarPathChanged"))
-    {
-      onRefVarPathChanged(
-        jsonObject->getString( FTL_STR("refName") ),
-        jsonObject->getString( FTL_STR("newVarPath") )
-        );
-    }
-    else if(descStr == FTL_STR("funcCodeChanged"))
+  }
+
+  // the handlers only marked the touched nodes, check them once
+  m_dfgController->updateErrors();
+
+  for ( size_t i = 0; i < suspendedViews.size(); ++i )
+    suspendedViews[i]->setUpdatesEnabled( true );
+
+  for ( size_t i = 0; i < queuedNotifications.size(); ++i )
+    delete queuedNotifications[i].notification;
+}
+
+void DFGNotificationRouter::addNotificationEntry(
+  FTL::StrRef desc,
+  int fieldCount,
+  NotificationHandler0 handler,
+  char const *field0,
+  char const *field1,
+  char const *field2,
+  char const *field3
+  )
+{
+  NotificationEntry entry;
+  entry.fieldCount = fieldCount;
+  entry.handler = handler;
+
+  char const *fields[MaxNotificationFields] =
+    { field0, field1, field2, field3 };
+  for ( int i = 0; i < MaxNotificationFields; ++i )
+  {
+    entry.optional[i] = false;
+    if ( i >= fieldCount )
+      continue;
+    assert( fields[i] );
+    char const *field = fields[i];
+    if ( field[0] == '?' )
     {
-      onFuncCodeChanged(
-        jsonObject->getString( FTL_STR("code") )
-        );
+      entry.optional[i] = true;
+      ++field;
     }
-    else if(descStr == FTL_STR("execTitleChanged"))
-    {
-      onExecTitleChanged(
-        jsonObject->getString( FTL_STR("title") )
+    entry.fields[i] = field;
+  }
+
+  // registering an existing desc replaces its handler
+  size_t index = size_t( m_notificationDescs.insert( desc ) );
+  if ( index < m_notificationEntries.size() )
+    m_notificationEntries[index] = entry;
+  else
+    m_notificationEntries.push_back( entry );
+}
+
+DFGNotificationRouter::NotificationEntry const *
+DFGNotificationRouter::findNotificationEntry( FTL::StrRef desc ) const
+{
+  int index = m_notificationDescs.find( desc );
+  if ( index < 0 )
+    return 0;
+  return &m_notificationEntries[index];
+}
+
+bool DFGNotificationRouter::hasNotificationHandler( FTL::StrRef desc ) const
+{
+  return findNotificationEntry( desc ) != 0;
+}
+
+void DFGNotificationRouter::registerNotificationHandler(
+  FTL::StrRef desc,
+  NotificationHandler0 handler
+  )
+{
+  addNotificationEntry( desc, 0, handler );
+}
+
+void DFGNotificationRouter::registerNotificationHandler(
+  FTL::StrRef desc,
+  NotificationHandler1 handler,
+  char const *field0
+  )
+{
+  addNotificationEntry(
+    desc,
+    1,
+    reinterpret_cast<NotificationHandler0>( handler ),
+    field0
+    );
+}
+
+void DFGNotificationRouter::registerNotificationHandler(
+  FTL::StrRef desc,
+  NotificationHandler2 handler,
+  char const *field0,
+  char const *field1
+  )
+{
+  addNotificationEntry(
+    desc,
+    2,
+    reinterpret_cast<NotificationHandler0>( handler ),
+    field0,
+    field1
+    );
+}
+
+void DFGNotificationRouter::registerNotificationHandler(
+  FTL::StrRef desc,
+  NotificationHandler3 handler,
+  char const *field0,
+  char const *field1,
+  char const *field2
+  )
+{
+  addNotificationEntry(
+    desc,
+    3,
+    reinterpret_cast<NotificationHandler0>( handler ),
+    field0,
+    field1,
+    field2
+    );
+}
+
+void DFGNotificationRouter::registerNotificationHandler(
+  FTL::StrRef desc,
+  NotificationHandler4 handler,
+  char const *field0,
+  char const *field1,
+  char const *field2,
+  char const *field3
+  )
+{
+  addNotificationEntry(
+    desc,
+    4,
+    reinterpret_cast<NotificationHandler0>( handler ),
+    field0,
+    field1,
+    field2,
+    field3
+    );
+}
+
+void DFGNotificationRouter::registerNotificationHandler(
+  FTL::StrRef desc,
+  JSONNotificationHandler handler
+  )
+{
+  addNotificationEntry(
+    desc,
+    -1,
+    reinterpret_cast<NotificationHandler0>( handler )
+    );
+}
+
+void DFGNotificationRouter::registerBuiltinNotificationHandlers()
+{
+  registerNotificationHandler(
+    FTL_STR("nodeInserted"),
+    &DFGNotificationRouter::dispatchNodeInserted
+    );
+  registerNotificationHandler(
+    FTL_STR("nodeRemoved"),
+    &DFGNotificationRouter::onNodeRemoved,
+    "nodeName"
+    );
+  registerNotificationHandler(
+    FTL_STR("nodePortInserted"),
+    &DFGNotificationRouter::dispatchNodePortInserted
+    );
+  registerNotificationHandler(
+    FTL_STR("nodePortRemoved"),
+    &DFGNotificationRouter::onNodePortRemoved,
+    "nodeName", "portName"
+    );
+  registerNotificationHandler(
+    FTL_STR("execPortInserted"),
+    &DFGNotificationRouter::dispatchExecPortInserted
+    );
+  registerNotificationHandler(
+    FTL_STR("execPortRemoved"),
+    &DFGNotificationRouter::onExecPortRemoved,
+    "portName"
+    );
+  registerNotificationHandler(
+    FTL_STR("portsConnected"),
+    &DFGNotificationRouter::onPortsConnected,
+    "srcPath", "dstPath"
+    );
+  registerNotificationHandler(
+    FTL_STR("portsDisconnected"),
+    &DFGNotificationRouter::onPortsDisconnected,
+    "srcPath", "dstPath"
+    );
+  registerNotificationHandler(
+    FTL_STR("nodeMetadataChanged"),
+    &DFGNotificationRouter::onNodeMetadataChanged,
+    "nodeName", "key", "value"
+    );
+  registerNotificationHandler(
+    FTL_STR("instExecTitleChanged"),
+    &DFGNotificationRouter::onNodeTitleChanged,
+    "instName", "execTitle"
+    );
+  registerNotificationHandler(
+    FTL_STR("nodeRenamed"),
+    &DFGNotificationRouter::onNodeRenamed,
+    "oldNodeName", "newNodeName"
+    );
+  registerNotificationHandler(
+    FTL_STR("execPortRenamed"),
+    &DFGNotificationRouter::dispatchExecPortRenamed
+    );
+  registerNotificationHandler(
+    FTL_STR("nodePortRenamed"),
+    &DFGNotificationRouter::onNodePortRenamed,
+    "nodeName", "oldPortName", "newPortName"
+    );
+  registerNotificationHandler(
+    FTL_STR("execMetadataChanged"),
+    &DFGNotificationRouter::onExecMetadataChanged,
+    "key", "value"
+    );
+  registerNotificationHandler(
+    FTL_STR("extDepAdded"),
+    &DFGNotificationRouter::onExtDepAdded,
+    "name", "versionRange"
+    );
+  registerNotificationHandler(
+    FTL_STR("extDepRemoved"),
+    &DFGNotificationRouter::onExtDepRemoved,
+    "name", "versionRange"
+    );
+  registerNotificationHandler(
+    FTL_STR("nodeCacheRuleChanged"),
+    &DFGNotificationRouter::onNodeCacheRuleChanged,
+    "nodeName", "cacheRule"
+    );
+  registerNotificationHandler(
+    FTL_STR("execCacheRuleChanged"),
+    &DFGNotificationRouter::onExecCacheRuleChanged,
+    "cacheRule"
+    );
+  registerNotificationHandler(
+    FTL_STR("execPortResolvedTypeChanged"),
+    &DFGNotificationRouter::onExecPortResolvedTypeChanged,
+    "portName", "?newResolvedType"
+    );
+  registerNotificationHandler(
+    FTL_STR("execPortTypeSpecChanged"),
+    &DFGNotificationRouter::onExecPortTypeSpecChanged,
+    "portName", "?newTypeSpec"
+    );
+  registerNotificationHandler(
+    FTL_STR("nodePortResolvedTypeChanged"),
+    &DFGNotificationRouter::onNodePortResolvedTypeChanged,
+    "nodeName", "portName", "?newResolvedType"
+    );
+  registerNotificationHandler(
+    FTL_STR("nodePortMetadataChanged"),
+    &DFGNotificationRouter::onNodePortMetadataChanged,
+    "nodeName", "portName", "key", "value"
+    );
+  registerNotificationHandler(
+    FTL_STR("execPortMetadataChanged"),
+    &DFGNotificationRouter::onExecPortMetadataChanged,
+    "portName", "key", "value"
+    );
+  registerNotificationHandler(
+    FTL_STR("execPortTypeChanged"),
+    &DFGNotificationRouter::onExecPortTypeChanged,
+    "portName", "newExecPortType"
+    );
+  registerNotificationHandler(
+    FTL_STR("nodePortTypeChanged"),
+    &DFGNotificationRouter::onNodePortTypeChanged,
+    "nodeName", "portName", "newNodePortType"
+    );
+  registerNotificationHandler(
+    FTL_STR("refVarPathChanged"),
+    &DFGNotificationRouter::onRefVarPathChanged,
+    "refName", "newVarPath"
+    );
+  registerNotificationHandler(
+    FTL_STR("funcCodeChanged"),
+    &DFGNotificationRouter::onFuncCodeChanged,
+    "code"
+    );
+  registerNotificationHandler(
+    FTL_STR("execTitleChanged"),
+    &DFGNotificationRouter::onExecTitleChanged,
+    "title"
+    );
+  registerNotificationHandler(
+    FTL_STR("extDepsChanged"),
+    &DFGNotificationRouter::onExecExtDepsChanged,
+    "extDeps"
+    );
+  registerNotificationHandler(
+    FTL_STR("execPortDefaultValuesChanged"),
+    &DFGNotificationRouter::onExecPortDefaultValuesChanged,
+    "portName"
+    );
+  registerNotificationHandler(
+    FTL_STR("nodePortDefaultValuesChanged"),
+    &DFGNotificationRouter::onNodePortDefaultValuesChanged,
+    "nodeName", "portName"
+    );
+  registerNotificationHandler(
+    FTL_STR("removedFromOwner"),
+    &DFGNotificationRouter::onRemovedFromOwner
+    );
+  registerNotificationHandler(
+    FTL_STR("execPortsReordered"),
+    &DFGNotificationRouter::dispatchExecPortsReordered
+    );
+  registerNotificationHandler(
+    FTL_STR("nodePortsReordered"),
+    &DFGNotificationRouter::dispatchNodePortsReordered
+    );
+  registerNotificationHandler(
+    FTL_STR("execDidAttachPreset"),
+    &DFGNotificationRouter::onExecDidAttachPreset,
+    "presetFilePath"
+    );
+  registerNotificationHandler(
+    FTL_STR("instExecDidAttachPreset"),
+    &DFGNotificationRouter::onInstExecDidAttachPreset,
+    "nodeName", "presetFilePath"
+    );
+  registerNotificationHandler(
+    FTL_STR("execWillDetachPreset"),
+    &DFGNotificationRouter::onExecWillDetachPreset,
+    "presetFilePath"
+    );
+  registerNotificationHandler(
+    FTL_STR("instExecWillDetachPreset"),
+    &DFGNotificationRouter::onInstExecWillDetachPreset,
+    "nodeName", "presetFilePath"
+    );
+  registerNotificationHandler(
+    FTL_STR("execEditWouldSplitFromPresetMayHaveChanged"),
+    &DFGNotificationRouter::onExecEditWouldSplitFromPresetMayHaveChanged
+    );
+  registerNotificationHandler(
+    FTL_STR("instExecEditWouldSplitFromPresetMayHaveChanged"),
+    &DFGNotificationRouter::onInstExecEditWouldSplitFromPresetMayHaveChanged,
+    "instName"
+    );
+}
+
+// Records the time spent in a handler, even if it throws, and marks
+// the next paint of the graph as caused by the notification.
+class NotificationProfileScope
+{
+public:
+
+  NotificationProfileScope(
+    DFGNotificationProfiler &profiler,
+    FTL::StrRef desc
+    )
+    : m_profiler( profiler )
+    , m_desc( desc )
+    , m_startTicks( Util::GetCurrentTicks() )
+  {
+  }
+
+  ~NotificationProfileScope()
+  {
+    m_profiler.addSample(
+      m_desc,
+      DFGNotificationProfiler::Phase_Handler,
+      Util::GetSecondsBetweenTicks( m_startTicks, Util::GetCurrentTicks() )
+      );
+    m_profiler.addPendingScene( m_desc );
+  }
+
+private:
+
+  DFGNotificationProfiler &m_profiler;
+  FTL::StrRef m_desc;
+  uint64_t m_startTicks;
+};
+
+void DFGNotificationRouter::dispatch(
+  DFGNotificationJSON const &notification
+  )
+{
+  FTL::CStrRef descStr = notification.getDesc();
+  NotificationEntry const *entry = findNotificationEntry( descStr );
+  if ( !entry )
+  {
+    printf(
+      "NotificationRouter::callback: Unhandled notification: %s\n",
+      descStr.c_str()
+      );
+    return;
+  }
+
+  DFGNotificationProfiler &profiler = m_dfgController->notificationProfiler();
+  if ( profiler.isEnabled() )
+  {
+    NotificationProfileScope profileScope( profiler, descStr );
+    invoke( *entry, notification );
+  }
+  else
+    invoke( *entry, notification );
+}
+
+void DFGNotificationRouter::invoke(
+  NotificationEntry const &entry,
+  DFGNotificationJSON const &notification
+  )
+{
+  if ( entry.fieldCount < 0 )
+  {
+    JSONNotificationHandler handler =
+      reinterpret_cast<JSONNotificationHandler>( entry.handler );
+    (this->*handler)( notification );
+    return;
+  }
+
+  FTL::CStrRef values[MaxNotificationFields];
+  for ( int i = 0; i < entry.fieldCount; ++i )
+  {
+    FTL::StrRef field( entry.fields[i].data(), entry.fields[i].size() );
+    if ( entry.optional[i] )
+      values[i] = notification.getStringOrEmpty( field );
+    else
+      values[i] = notification.getString( field );
+  }
+
+  switch ( entry.fieldCount )
+  {
+    case 0:
+      (this->*entry.handler)();
+      break;
+    case 1:
+      (this->*reinterpret_cast<NotificationHandler1>( entry.handler ))(
+        values[0]
         );
-    }
-    else if(descStr == FTL_STR("extDepsChanged"))
-    {
-      onExecExtDepsChanged(
-        jsonObject->getString( FTL_STR("extDeps") )
+      break;
+    case 2:
+      (this->*reinterpret_cast<NotificationHandler2>( entry.handler ))(
+        values[0], values[1]
         );
-    }
-    else if( descStr == FTL_STR("execPortDefaultValuesChanged") )
-    {
-      onExecPortDefaultValuesChanged(
-        jsonObject->getString( FTL_STR("portName") )
+      break;
+    case 3:
+      (this->*reinterpret_cast<NotificationHandler3>( entry.handler ))(
+        values[0], values[1], values[2]
         );
-    }
-    else if( descStr == FTL_STR("nodePortDefaultValuesChanged") )
-    {
-      onNodePortDefaultValuesChanged(
-        jsonObject->getString( FTL_STR("nodeName") ),
-        jsonObject->getString( FTL_STR("portName") )
+      break;
+    case 4:
+      (this->*reinterpret_cast<NotificationHandler4>( entry.handler ))(
+        values[0], values[1], values[2], values[3]
         );
-    }
-    else if ( descStr == FTL_STR("removedFromOwner") )
-    {
-      onRemovedFromOwner();
-    }
-    else if ( descStr == FTL_STR("execPortsReordered") )
-    {
-      const FTL::JSONArray * newOrder = jsonObject->maybeGetArray( FTL_STR("newOrder") );
-      if ( newOrder )
-      {
-        std::vector<unsigned int> indices;
-        for( size_t i = 0; i < newOrder->size(); i++ )
-        {
-          const FTL::JSONValue * indexVal = newOrder->get( i );
-          unsigned int index = indexVal->getSInt32Value();
-          indices.push_back( index );
-        }
+      break;
+  }
+}
 
-        if( indices.size() > 0 )
-          onExecPortsReordered( indices.size(), &indices[ 0 ] );
-      }
-    }
-    else if (descStr == FTL_STR("nodePortsReordered") )
-    {
-      FTL::CStrRef nodeName = jsonObject->getString( FTL_STR("nodeName") );
-      const FTL::JSONArray * newOrder = jsonObject->maybeGetArray( FTL_STR("newOrder") );
-      if ( newOrder )
-      {
-        std::vector<unsigned int> indices;
-        for( size_t i = 0; i < newOrder->size(); i++ )
-        {
-          const FTL::JSONValue * indexVal = newOrder->get( i );
-          unsigned int index = indexVal->getSInt32Value();
-          indices.push_back( index );
-        }
+void DFGNotificationRouter::dispatchNodeInserted(
+  DFGNotificationJSON const &notification
+  )
+{
+  FTL::OwnedPtr<FTL::JSONObject> nodeDesc(
+    notification.decodeObject( FTL_STR("nodeDesc") )
+    );
+  onNodeInserted(
+    notification.getString( FTL_STR("nodeName") ),
+    nodeDesc.get()
+    );
+}
 
-        if( indices.size() > 0 )
-          onNodePortsReordered( nodeName, indices.size(), &indices[ 0 ] );
-      }
-    }
-    else if (descStr == FTL_STR("execDidAttachPreset") )
-    {
-      FTL::CStrRef presetFilePath = jsonObject->getString( FTL_STR("presetFilePath") );
-      onExecDidAttachPreset( presetFilePath );
-    }
-    else if (descStr == FTL_STR("instExecDidAttachPreset") )
-    {
-      FTL::CStrRef nodeName = jsonObject->getString( FTL_STR("nodeName") );
-      FTL::CStrRef presetFilePath = jsonObject->getString( FTL_STR("presetFilePath") );
-      onInstExecDidAttachPreset( nodeName, presetFilePath );
-    }
-    else if (descStr == FTL_STR("execWillDetachPreset") )
-    {
-      FTL::CStrRef presetFilePath = jsonObject->getString( FTL_STR("presetFilePath") );
-      onExecWillDetachPreset( presetFilePath );
-    }
-    else if (descStr == FTL_STR("instExecWillDetachPreset") )
-    {
-      FTL::CStrRef nodeName = jsonObject->getString( FTL_STR("nodeName") );
-      FTL::CStrRef presetFilePath = jsonObject->getString( FTL_STR("presetFilePath") );
-      onInstExecWillDetachPreset( nodeName, presetFilePath );
-    }
-    else if (descStr == FTL_STR("execEditWouldSplitFromPresetMayHaveChanged") )
-    {
-      onExecEditWouldSplitFromPresetMayHaveChanged();
-    }
-    else if (descStr == FTL_STR("instExecEditWouldSplitFromPresetMayHaveChanged") )
+void DFGNotificationRouter::dispatchNodePortInserted(
+  DFGNotificationJSON const &notification
+  )
+{
+  FTL::OwnedPtr<FTL::JSONObject> nodePortDesc(
+    notification.decodeObject( FTL_STR("nodePortDesc") )
+    );
+  onNodePortInserted(
+    notification.getString( FTL_STR("nodeName") ),
+    notification.getString( FTL_STR("portName") ),
+    nodePortDesc.get()
+    );
+}
+
+void DFGNotificationRouter::dispatchExecPortInserted(
+  DFGNotificationJSON const &notification
+  )
+{
+  FTL::OwnedPtr<FTL::JSONObject> execPortDesc(
+    notification.decodeObject( FTL_STR("execPortDesc") )
+    );
+  onExecPortInserted(
+    notification.getString( FTL_STR("portName") ),
+    execPortDesc.get()
+    );
+}
+
+void DFGNotificationRouter::dispatchExecPortRenamed(
+  DFGNotificationJSON const &notification
+  )
+{
+  FTL::OwnedPtr<FTL::JSONObject> execPortDesc(
+    notification.decodeObject( FTL_STR("execPortDesc") )
+    );
+  onExecPortRenamed(
+    notification.getString( FTL_STR("oldPortName") ),
+    notification.getString( FTL_STR("newPortName") ),
+    execPortDesc.get()
+    );
+}
+
+void DFGNotificationRouter::dispatchExecPortsReordered(
+  DFGNotificationJSON const &notification
+  )
+{
+  FTL::OwnedPtr<FTL::JSONArray> newOrder(
+    notification.maybeDecodeArray( FTL_STR("newOrder") )
+    );
+  if ( newOrder.get() )
+  {
+    std::vector<unsigned int> indices;
+    for( size_t i = 0; i < newOrder->size(); i++ )
     {
-      FTL::CStrRef instName = jsonObject->getString( FTL_STR("instName") );
-      onInstExecEditWouldSplitFromPresetMayHaveChanged( instName );
+      const FTL::JSONValue * indexVal = newOrder->get( i );
+      unsigned int index = indexVal->getSInt32Value();
+      indices.push_back( index );
     }
-    else
+
+    if( indices.size() > 0 )
+      onExecPortsReordered( indices.size(), &indices[ 0 ] );
+  }
+}
+
+void DFGNotificationRouter::dispatchNodePortsReordered(
+  DFGNotificationJSON const &notification
+  )
+{
+  FTL::CStrRef nodeName = notification.getString( FTL_STR("nodeName") );
+  FTL::OwnedPtr<FTL::JSONArray> newOrder(
+    notification.maybeDecodeArray( FTL_STR("newOrder") )
+    );
+  if ( newOrder.get() )
+  {
+    std::vector<unsigned int> indices;
+    for( size_t i = 0; i < newOrder->size(); i++ )
     {
-      printf(
-        "NotificationRouter::callback: Unhandled notification:\n%s\n",
-        jsonStr.data()
-        );
+      const FTL::JSONValue * indexVal = newOrder->get( i );
+      unsigned int index = indexVal->getSInt32Value();
+      indices.push_back( index );
     }
+
+    if( indices.size() > 0 )
+      onNodePortsReordered( nodeName, indices.size(), &indices[ 0 ] );
   }
-  catch ( FabricCore::Exception e )
+}
+
+void DFGNotificationRouter::onGraphSet()
+{
+  m_buildPlanRestarts = 0;
+  buildGraph();
+}
+
+void DFGNotificationRouter::buildGraph()
+{
+  FabricCore::DFGExec &exec = m_dfgController->getExec();
+  if ( !exec )
+    return;
+
+  // the description is fetched here so that it is consistent with the
+  // notifications received from now on
+  FabricCore::DFGStringResult desc = exec.getDesc();
+  char const *descData;
+  uint32_t descSize;
+  desc.getStringDataAndLength( descData, descSize );
+  std::string descStr( descData, descSize );
+
+  cancelBuildPlan();
+
+  // while recording, the plan is resolved here so that its answers are
+  // written in order with the notifications
+  DFGNotificationRecorder *recorder = notificationRecorder();
+  if ( m_config.asyncGraphBuildThreshold > 0
+    && descSize >= m_config.asyncGraphBuildThreshold
+    && m_buildPlanRestarts < MaxBuildPlanRestarts
+    && !( recorder && recorder->isOpen() ) )
   {
-    printf(
-      "NotificationRouter::callback: caught Core exception: %s\n",
-      e.getDesc_cstr()
+    // resolve the plan on a worker thread; notifications are queued
+    // until it has been applied
+    m_buildPlanPending = true;
+    m_buildPlanQueuedCount = m_queuedNotifications.size();
+    m_buildPlanWatcher = new QFutureWatcher< QSharedPointer<DFGExecBuildPlan> >( this );
+    QObject::connect(
+      m_buildPlanWatcher, SIGNAL(finished()),
+      this, SLOT(onBuildPlanFinished())
       );
+    m_buildPlanWatcher->setFuture(
+      QtConcurrent::run(
+        &DFGExecBuildPlan::Build,
+        execSource(),
+        descStr,
+        m_config.getColorTypes(),
+        m_buildPlanToken
+        )
+      );
+    return;
   }
-  catch ( FTL::JSONException e )
+
+  buildGraphFromDesc( descStr );
+}
+
+void DFGNotificationRouter::buildGraphFromDesc( FTL::CStrRef desc )
+{
+  cancelBuildPlan();
+
+  if ( DFGNotificationRecorder *recorder = notificationRecorder() )
+    recorder->recordDesc( desc );
+
+  QSharedPointer<DFGExecBuildSource> source = execSource();
+  if ( !source )
+    return;
+
+  QSharedPointer<DFGExecBuildPlan> plan =
+    DFGExecBuildPlan::Build(
+      source,
+      std::string( desc.data(), desc.size() ),
+      m_config.getColorTypes(),
+      m_buildPlanToken
+      );
+  if ( plan )
+    applyBuildPlan( *plan );
+}
+
+void DFGNotificationRouter::cancelBuildPlan()
+{
+  m_buildPlanToken.cancel();
+  m_buildPlanToken = DFGExecBuildToken();
+  m_buildPlanPending = false;
+
+  if ( m_buildPlanWatcher )
+  {
+    m_buildPlanWatcher->disconnect( this );
+    m_buildPlanWatcher->deleteLater();
+    m_buildPlanWatcher = 0;
+  }
+}
+
+void DFGNotificationRouter::onBuildPlanFinished()
+{
+  QFutureWatcher< QSharedPointer<DFGExecBuildPlan> > *watcher =
+    m_buildPlanWatcher;
+  if ( !watcher || sender() != watcher )
+    return;
+
+  QSharedPointer<DFGExecBuildPlan> plan = watcher->result();
+  m_buildPlanWatcher = 0;
+  watcher->deleteLater();
+  m_buildPlanPending = false;
+
+  if ( !plan || m_queuedNotifications.size() > m_buildPlanQueuedCount )
+  {
+    // the exec changed while the plan was resolved, so the plan either
+    // failed or mixes states.  A new description covers the queued
+    // notifications, so they are dropped and the build starts over;
+    // after MaxBuildPlanRestarts attempts it runs on the GUI thread.
+    for ( size_t i = 0; i < m_queuedNotifications.size(); ++i )
+    {
+      if ( m_queuedNotifications[i].notification->getDesc()
+        == FTL_STR("removedFromOwner") )
+      {
+        // this destroys the router
+        flushNotifications();
+        return;
+      }
+    }
+    clearQueuedNotifications();
+
+    ++m_buildPlanRestarts;
+    buildGraph();
+    if ( m_buildPlanPending )
+      return;
+  }
+  else
   {
-    printf(
-      "NotificationRouter::callback: caught FTL::JSONException: %s\n",
-      e.getDescCStr()
-      );
+    applyBuildPlan( *plan );
+
+    // apply what happened to the exec before the plan was started
+    flushNotifications();
   }
+
+  emit execBuilt();
 }
 
-void DFGNotificationRouter::onGraphSet()
+void DFGNotificationRouter::applyBuildPlan( DFGExecBuildPlan const &plan )
 {
-  FabricCore::DFGExec &exec = m_dfgController->getExec();
-  if ( !exec )
-    return;
-
-  FabricCore::DFGStringResult desc = exec.getDesc();
-  char const *descData;
-  uint32_t descSize;
-  desc.getStringDataAndLength( descData, descSize );
-
-  FTL::JSONStrWithLoc jsonSrcWithLoc( FTL::StrRef( descData, descSize ) );
-  FTL::OwnedPtr<FTL::JSONValue const> rootValue(
-    FTL::JSONValue::Decode( jsonSrcWithLoc )
-    );
-
-  try
   {
-    FTL::JSONObject const *rootObject = rootValue->cast<FTL::JSONObject>();
+    // size the graph up front and build it in one go
+    GraphView::Graph::BulkBuildBracket bulkBuildBracket(
+      m_dfgController->graph(),
+      plan.nodes().size(),
+      plan.connections().size()
+      );
 
-    FTL::JSONArray const *portsArray =
-      rootObject->get( FTL_STR("ports") )->cast<FTL::JSONArray>();
-    for ( size_t i = 0; i < portsArray->size(); ++i )
+    std::vector<DFGExecBuildPlan::Port> const &ports = plan.ports();
+    if ( plan.isGraph() )
     {
-      FTL::JSONObject const *portObject =
-        portsArray->get( i )->cast<FTL::JSONObject>();
-      onExecPortInserted(
-        portObject->getString( FTL_STR("name") ),
-        portObject
-        );
+      for ( size_t i = 0; i < ports.size(); ++i )
+        addPlanExecPort( ports[i] );
     }
+    else if ( !ports.empty() )
+      refreshKLEditor();
 
-    if ( rootObject->getString( FTL_STR("objectType") ) == FTL_STR("Graph") )
-    {
-      FTL::JSONArray const *nodesArray =
-        rootObject->get( FTL_STR("nodes") )->cast<FTL::JSONArray>();
-      for ( size_t i = 0; i < nodesArray->size(); ++i )
-      {
-        FTL::JSONObject const *nodeObject =
-          nodesArray->get( i )->cast<FTL::JSONObject>();
-        onNodeInserted(
-          nodeObject->getString( FTL_STR("name") ),
-          nodeObject
-          );
-      }
+    std::vector<DFGExecBuildPlan::Node> const &nodes = plan.nodes();
+    for ( size_t i = 0; i < nodes.size(); ++i )
+      addPlanNode( nodes[i] );
 
-      FTL::JSONObject const *connectionsObject =
-        rootObject->get( FTL_STR("connections") )->cast<FTL::JSONObject>();
-      for ( FTL::JSONObject::const_iterator it = connectionsObject->begin();
-        it != connectionsObject->end(); ++it )
-      {
-        FTL::CStrRef srcPath = it->first;
-        FTL::JSONArray const *dstsArray = it->second->cast<FTL::JSONArray>();
-        for ( FTL::JSONArray::const_iterator it = dstsArray->begin();
-          it != dstsArray->end(); ++it )
-        {
-          FTL::JSONValue const *dstValue = *it;
-          FTL::CStrRef dstPath = dstValue->getStringValue();
-          onPortsConnected( srcPath, dstPath );
-        }
-      }
-    }
+    // the args of the binding were bound when it was set, so unlike
+    // onPortsConnected there is nothing to bind here
+    std::vector<DFGExecBuildPlan::Connection> const &connections =
+      plan.connections();
+    for ( size_t i = 0; i < connections.size(); ++i )
+      connectTargets( connections[i].srcPath, connections[i].dstPath );
 
-    FTL::JSONValue const *metadatasValue =
-      rootObject->maybeGet( FTL_STR("metadata") );
-    if ( metadatasValue )
-    {
-      FTL::JSONObject const *metadatasObject =
-        metadatasValue->cast<FTL::JSONObject>();
-      for ( FTL::JSONObject::const_iterator it = metadatasObject->begin();
-        it != metadatasObject->end(); ++it )
-      {
-        FTL::CStrRef key = it->first;
-        FTL::CStrRef value = it->second->getStringValue();
-        onExecMetadataChanged( key, value );
-      }
-    }
+    std::vector<DFGExecBuildPlan::Metadata> const &metadata =
+      plan.metadata();
+    for ( size_t i = 0; i < metadata.size(); ++i )
+      onExecMetadataChanged( metadata[i].key, metadata[i].value );
   }
-  catch ( FTL::JSONException je )
+
+  // an error pass scheduled by setExec may have run before the nodes
+  // existed, so show the errors now that they are built
+  m_dfgController->checkErrors();
+}
+
+QColor DFGNotificationRouter::getPortColor(
+  DFGExecBuildPlan::Port const &port
+  )
+{
+  // the plan only carries a uiColor for data types without a color
+  QColor color;
+  if ( !port.uiColor.empty()
+    && m_metadataDecoder.decodeColor( port.uiColor, color ) )
   {
-    printf( "Caught JSONException: %s\n", je.getDescCStr() );
+    m_config.registerDataTypeColor( port.dataType, color );
+    return color;
   }
+  return m_config.getColorForDataType( port.dataType );
 }
 
-void DFGNotificationRouter::onNotification(FTL::CStrRef json)
+void DFGNotificationRouter::refreshKLEditor()
 {
+  DFGWidget *dfgWidget = m_dfgController->getDFGWidget();
+  if ( !dfgWidget )
+    return;
+  DFGKLEditorWidget * uiKlEditor = dfgWidget->getKLEditor();
+  if(!uiKlEditor)
+    return;
+  uiKlEditor->onExecChanged();
 }
 
-void DFGNotificationRouter::onNodeInserted(
-  FTL::CStrRef nodeName,
-  FTL::JSONObject const *jsonObject
+GraphView::Node *DFGNotificationRouter::addPlanNode(
+  DFGExecBuildPlan::Node const &node
   )
 {
-  FabricCore::DFGExec &exec = m_dfgController->getExec();
-  if ( !exec )
-    return;
-
   GraphView::Graph * uiGraph = m_dfgController->graph();
   if(!uiGraph)
-    return;
+    return NULL;
 
-  FabricCore::DFGNodeType nodeType = exec.getNodeType( nodeName.c_str() );
   GraphView::Node * uiNode;
-  if ( nodeType == FabricCore::DFGNodeType_User )
-    uiNode = uiGraph->addBackDropNode( nodeName );
+  if ( node.type == FabricCore::DFGNodeType_User )
+    uiNode = uiGraph->addBackDropNode( node.name );
   else
-    uiNode = uiGraph->addNode( nodeName, FTL::CStrRef() );
+    uiNode = uiGraph->addNode( node.name, FTL::CStrRef() );
   if(!uiNode)
-    return;
+    return NULL;
 
-  if(nodeType == FabricCore::DFGNodeType_Var ||
-    nodeType == FabricCore::DFGNodeType_Get ||
-    nodeType == FabricCore::DFGNodeType_Set)
+  if(node.type == FabricCore::DFGNodeType_Var ||
+    node.type == FabricCore::DFGNodeType_Get ||
+    node.type == FabricCore::DFGNodeType_Set)
   {
     uiNode->setColor(m_config.varNodeDefaultColor);
     uiNode->setTitleColor(m_config.varLabelDefaultColor);
   }
 
-  if(nodeType == FabricCore::DFGNodeType_Inst)
-  {
-    if ( exec.instExecIsPreset( nodeName.c_str() ) )
-    {
-      FTL::CStrRef title;
-      if ( jsonObject->maybeGetString( FTL_STR("execTitle"), title ) )
-        uiNode->setTitle( title );
-    }
-    else
-    {
-      uiNode->setTitle( nodeName );
-      uiNode->setTitleSuffixAsterisk();
-    }
-  }
-  else if(nodeType == FabricCore::DFGNodeType_Var)
-  {
-    FTL::CStrRef name;
-    if ( jsonObject->maybeGetString( FTL_STR("name"), name ) )
-      uiNode->setTitle( name );
-  }
-  else if(nodeType == FabricCore::DFGNodeType_Get || nodeType == FabricCore::DFGNodeType_Set)
+  if ( !node.title.empty() )
+    uiNode->setTitle( node.title );
+  if ( node.titleSuffixAsterisk )
+    uiNode->setTitleSuffixAsterisk();
+
+  for ( size_t i = 0; i < node.pins.size(); ++i )
+    addPlanNodePin( uiNode, node.pins[i] );
+
+  for ( size_t i = 0; i < node.metadata.size(); ++i )
   {
-    FTL::CStrRef varPath = exec.getRefVarPath( nodeName.c_str() );
-    onRefVarPathChanged(nodeName, varPath);
+    onNodeMetadataChanged(
+      node.name,
+      node.metadata[i].key,
+      node.metadata[i].value
+      );
   }
 
-  FTL::JSONArray const *portsJSONArray =
-    jsonObject->get( FTL_STR("ports") )->cast<FTL::JSONArray>();
-  for ( size_t i = 0; i < portsJSONArray->size(); ++i )
+  if(m_performChecks)
+    m_dfgController->markNodeErrorsDirty( node.name );
+
+  return uiNode;
+}
+
+void DFGNotificationRouter::addPlanNodePin(
+  GraphView::Node *uiNode,
+  DFGExecBuildPlan::Port const &port
+  )
+{
+  GraphView::PortType pType = GraphView::PortType_Input;
+  if(port.portType == "Out")
+    pType = GraphView::PortType_Output;
+  else if(port.portType == "IO")
+    pType = GraphView::PortType_IO;
+
+  GraphView::Pin * uiPin = new GraphView::Pin(
+    uiNode, port.name.c_str(), pType, getPortColor( port ), port.name.c_str()
+    );
+  if ( !port.dataType.empty() )
+    uiPin->setDataType( port.dataType );
+  uiNode->addPin(uiPin, false);
+}
+
+void DFGNotificationRouter::addPlanExecPort(
+  DFGExecBuildPlan::Port const &port
+  )
+{
+  GraphView::Graph * uiGraph = m_dfgController->graph();
+  if(!uiGraph)
+    return;
+
+  QColor color = getPortColor( port );
+
+  GraphView::Port * uiOutPort = NULL;
+  GraphView::Port * uiInPort = NULL;
+
+  if(port.portType != "In")
   {
-    FTL::JSONObject const *portJSONObject =
-      portsJSONArray->get( i )->cast<FTL::JSONObject>();
-    onNodePortInserted(
-      nodeName,
-      portJSONObject->getString( FTL_STR("name") ),
-      portJSONObject
+    GraphView::SidePanel * uiPanel = uiGraph->sidePanel(GraphView::PortType_Input);
+    if(!uiPanel)
+      return;
+
+    uiInPort = new GraphView::Port(
+      uiPanel, port.name, GraphView::PortType_Input, port.dataType, color, port.name
       );
+    uiPanel->addPort(uiInPort);
   }
+  if(port.portType != "Out")
+  {
+    GraphView::SidePanel * uiPanel = uiGraph->sidePanel(GraphView::PortType_Output);
+    if(!uiPanel)
+      return;
 
-  if(exec.getNodeType(nodeName.c_str()) == FabricCore::DFGNodeType_Inst)
-  {
-    FabricCore::DFGExec subExec = exec.getSubExec(nodeName.c_str());
-    FTL::CStrRef uiNodeColor = subExec.getMetadata("uiNodeColor");
-    if(!uiNodeColor.empty())
-      onNodeMetadataChanged(nodeName, "uiNodeColor", uiNodeColor);
-    FTL::CStrRef uiHeaderColor = subExec.getMetadata("uiHeaderColor");
-    if(!uiHeaderColor.empty())
-      onNodeMetadataChanged(nodeName, "uiHeaderColor", uiHeaderColor);
-    FTL::CStrRef uiTextColor = subExec.getMetadata("uiTextColor");
-    if(!uiTextColor.empty())
-      onNodeMetadataChanged(nodeName, "uiTextColor", uiTextColor);
-    FTL::CStrRef uiTooltip = subExec.getMetadata("uiTooltip");
-    if(!uiTooltip.empty())
-      onNodeMetadataChanged(nodeName, "uiTooltip", uiTooltip);
-    FTL::CStrRef uiAlwaysShowDaisyChainPorts = subExec.getMetadata("uiAlwaysShowDaisyChainPorts");
-    if(!uiAlwaysShowDaisyChainPorts.empty())
-      onNodeMetadataChanged(nodeName, "uiAlwaysShowDaisyChainPorts", uiAlwaysShowDaisyChainPorts);
-    FTL::CStrRef uiCollapsedState = subExec.getMetadata("uiCollapsedState");
-    if(!uiCollapsedState.empty())
-      onNodeMetadataChanged(nodeName, "uiCollapsedState", uiCollapsedState);
-  }
-
-  if ( exec.getNodeType(nodeName.c_str()) == FabricCore::DFGNodeType_User )
-  {
-    FTL::CStrRef uiNodeColor =
-      exec.getNodeMetadata( nodeName.c_str(), "uiNodeColor" );
-    if ( !uiNodeColor.empty() )
-      onNodeMetadataChanged( nodeName, "uiNodeColor", uiNodeColor );
-    FTL::CStrRef uiHeaderColor =
-      exec.getNodeMetadata( nodeName.c_str(), "uiHeaderColor" );
-    if ( !uiHeaderColor.empty() )
-      onNodeMetadataChanged( nodeName, "uiHeaderColor", uiHeaderColor );
-    FTL::CStrRef uiTextColor =
-      exec.getNodeMetadata( nodeName.c_str(), "uiTextColor" );
-    if ( !uiTextColor.empty() )
-      onNodeMetadataChanged( nodeName, "uiTextColor", uiTextColor );
-  }
-
-  if ( FTL::JSONValue const *metadataJSONValue =
-    jsonObject->maybeGet( FTL_STR("metadata") ) )
-  {
-    FTL::JSONObject const *metadataJSONObject =
-      metadataJSONValue->cast<FTL::JSONObject>();
-
-    for ( FTL::JSONObject::const_iterator it = metadataJSONObject->begin();
-      it != metadataJSONObject->end(); ++it )
-    {
-      FTL::CStrRef key = it->first;
-      FTL::CStrRef value = it->second->cast<FTL::JSONString>()->getValue();
-      onNodeMetadataChanged(nodeName, key, value);
-    }
+    uiOutPort = new GraphView::Port(
+      uiPanel, port.name, GraphView::PortType_Output, port.dataType, color, port.name
+      );
+    uiPanel->addPort(uiOutPort);
   }
-
-  if(m_performChecks)
+  if(uiOutPort && uiInPort)
   {
-    ((DFGController*)m_dfgController)->checkErrors();
+    uiGraph->addConnection(uiOutPort, uiInPort, false);
   }
 }
 
+void DFGNotificationRouter::onNotification(FTL::CStrRef json)
+{
+}
+
+void DFGNotificationRouter::onNodeInserted(
+  FTL::CStrRef nodeName,
+  FTL::JSONObject const *jsonObject
+  )
+{
+  QSharedPointer<DFGExecBuildSource> source = execSource();
+  if ( !source )
+    return;
+
+  if ( !m_dfgController->graph() )
+    return;
+
+  DFGExecBuildPlan::Node node;
+  DFGExecBuildPlan::ResolveNode(
+    *source,
+    nodeName,
+    jsonObject,
+    m_config.getColorTypes(),
+    node
+    );
+  addPlanNode( node );
+}
+
 void DFGNotificationRouter::onNodeRemoved(
   FTL::CStrRef nodeName
   )
@@ -595,11 +1628,6 @@ void DFGNotificationRouter::onNodeRemoved(
   // todo - the notif should provide the node type
   // m_dfgController->updatePresetDB(true);
 
-  if(m_performChecks)
-  {
-    ((DFGController*)m_dfgController)->checkErrors();
-  }
-
   m_dfgController->emitNodeRemoved( nodeName );
 }
 
@@ -616,31 +1644,20 @@ void DFGNotificationRouter::onNodePortInserted(
   if(!uiNode)
     return;
 
-  FTL::CStrRef dataType = jsonObject->getStringOrEmpty( FTL_STR("type") );
-
-  FabricCore::DFGExec &exec = m_dfgController->getExec();
-
-  QColor color;
-  if(exec.getNodeType(nodeName.c_str()) == FabricCore::DFGNodeType_Inst)
-  {
-    FabricCore::DFGExec subExec = exec.getSubExec(nodeName.c_str());
-    color = m_config.getColorForDataType(dataType, &subExec, portName.c_str());
-  }
-  else
-    color = m_config.getColorForDataType(dataType);
-
-  FTL::CStrRef nodePortType =
-    jsonObject->getStringOrEmpty( FTL_STR("nodePortType") );
-  GraphView::PortType pType = GraphView::PortType_Input;
-  if(nodePortType == FTL_STR("Out"))
-    pType = GraphView::PortType_Output;
-  else if(nodePortType == FTL_STR("IO"))
-    pType = GraphView::PortType_IO;
-
-  GraphView::Pin * uiPin = new GraphView::Pin(uiNode, portName.c_str(), pType, color, portName.c_str());
-  if ( !dataType.empty() )
-    uiPin->setDataType(dataType);
-  uiNode->addPin(uiPin, false);
+  QSharedPointer<DFGExecBuildSource> source = execSource();
+  if(!source)
+    return;
+  DFGExecBuildPlan::Port port;
+  DFGExecBuildPlan::ResolveNodePort(
+    *source,
+    nodeName,
+    source->getNodeType( nodeName ),
+    portName,
+    jsonObject,
+    m_config.getColorTypes(),
+    port
+    );
+  addPlanNodePin( uiNode, port );
 }
 
 void DFGNotificationRouter::onNodePortRemoved(
@@ -661,9 +1678,7 @@ void DFGNotificationRouter::onNodePortRemoved(
   uiNode->removePin(uiPin, false);
 
   if(m_performChecks)
-  {
-    ((DFGController*)m_dfgController)->checkErrors();
-  }
+    m_dfgController->markNodeErrorsDirty( nodeName );
 }
 
 void DFGNotificationRouter::onExecPortInserted(
@@ -671,65 +1686,40 @@ void DFGNotificationRouter::onExecPortInserted(
   FTL::JSONObject const *jsonObject
   )
 {
-  FTL::CStrRef dataType = jsonObject->getStringOrEmpty( FTL_STR("type") );
-
-  FabricCore::DFGExec &exec = m_dfgController->getExec();
+  QSharedPointer<DFGExecBuildSource> source = execSource();
+  if(!source)
+    return;
 
-  if(exec.getType() == FabricCore::DFGExecType_Graph)
+  FabricCore::DFGExecType execType = source->getExecType();
+  if(execType == FabricCore::DFGExecType_Graph)
   {
-    GraphView::Graph * uiGraph = m_dfgController->graph();
-    if(!uiGraph)
+    if(!m_dfgController->graph())
       return;
 
-    QColor color = m_config.getColorForDataType(dataType, &exec, portName.c_str());
-
-    GraphView::Port * uiOutPort = NULL;
-    GraphView::Port * uiInPort = NULL;
-
-    FTL::CStrRef execPortType =
-      jsonObject->getStringOrEmpty( FTL_STR("execPortType") );
-    if(execPortType != FTL_STR("In"))
-    {
-      GraphView::SidePanel * uiPanel = uiGraph->sidePanel(GraphView::PortType_Input);
-      if(!uiPanel)
-        return;
-
-      uiInPort = new GraphView::Port(
-        uiPanel, portName, GraphView::PortType_Input, dataType, color, portName
-        );
-      uiPanel->addPort(uiInPort);
-    }
-    if(execPortType != FTL_STR("Out"))
-    {
-      GraphView::SidePanel * uiPanel = uiGraph->sidePanel(GraphView::PortType_Output);
-      if(!uiPanel)
-        return;
-
-      uiOutPort = new GraphView::Port(
-        uiPanel, portName, GraphView::PortType_Output, dataType, color, portName
-        );
-      uiPanel->addPort(uiOutPort);
-    }
-    if(uiOutPort && uiInPort)
-    {
-      uiGraph->addConnection(uiOutPort, uiInPort, false);
-    }
-  }
-  else if(exec.getType() == FabricCore::DFGExecType_Func)
-  {
-    DFGKLEditorWidget * uiKlEditor = m_dfgController->getDFGWidget()->getKLEditor();
-    if(!uiKlEditor)
-      return;
-    uiKlEditor->onExecChanged();
+    DFGExecBuildPlan::Port port;
+    DFGExecBuildPlan::ResolveExecPort(
+      *source,
+      portName,
+      jsonObject,
+      m_config.getColorTypes(),
+      port
+      );
+    addPlanExecPort( port );
   }
+  else if(execType == FabricCore::DFGExecType_Func)
+    refreshKLEditor();
 }
 
 void DFGNotificationRouter::onExecPortRemoved(
   FTL::CStrRef portName
   )
 {
-  FabricCore::DFGExec &exec = m_dfgController->getExec();
-  if(exec.getType() == FabricCore::DFGExecType_Graph)
+  QSharedPointer<DFGExecBuildSource> source = execSource();
+  if(!source)
+    return;
+
+  FabricCore::DFGExecType execType = source->getExecType();
+  if(execType == FabricCore::DFGExecType_Graph)
   {
     GraphView::Graph * uiGraph = m_dfgController->graph();
     if(!uiGraph)
@@ -758,27 +1748,37 @@ void DFGNotificationRouter::onExecPortRemoved(
     }
 
     if(m_performChecks)
-    {
-      ((DFGController*)m_dfgController)->checkErrors();
-    }
+      m_dfgController->markExecErrorsDirty();
   }
-  else if(exec.getType() == FabricCore::DFGExecType_Func)
+  else if(execType == FabricCore::DFGExecType_Func)
+    refreshKLEditor();
+}
+
+static void MarkConnectionErrorsDirty(
+  DFGController *dfgController,
+  FTL::CStrRef srcPath,
+  FTL::CStrRef dstPath
+  )
+{
+  FTL::CStrRef paths[2] = { srcPath, dstPath };
+  for ( unsigned i = 0; i < 2; ++i )
   {
-    DFGKLEditorWidget * uiKlEditor = m_dfgController->getDFGWidget()->getKLEditor();
-    if(!uiKlEditor)
-      return;
-    uiKlEditor->onExecChanged();
+    std::pair<FTL::StrRef, FTL::CStrRef> split = paths[i].split('.');
+    if ( split.second.empty() )
+      dfgController->markExecErrorsDirty();
+    else
+      dfgController->markNodeErrorsDirty( split.first );
   }
 }
 
-void DFGNotificationRouter::onPortsConnected(
+bool DFGNotificationRouter::connectTargets(
   FTL::CStrRef srcPath,
   FTL::CStrRef dstPath
   )
 {
   GraphView::Graph * uiGraph = m_dfgController->graph();
   if(!uiGraph)
-    return;
+    return false;
 
   GraphView::ConnectionTarget * uiSrcTarget = NULL;
   GraphView::ConnectionTarget * uiDstTarget = NULL;
@@ -788,7 +1788,7 @@ void DFGNotificationRouter::onPortsConnected(
   {
     GraphView::Node * uiSrcNode = uiGraph->node(srcSplit.first);
     if(!uiSrcNode)
-      return;
+      return false;
     uiSrcTarget = uiSrcNode->pin(srcSplit.second);
   }
   else
@@ -803,7 +1803,7 @@ void DFGNotificationRouter::onPortsConnected(
   {
     GraphView::Node * uiDstNode = uiGraph->node(dstSplit.first);
     if(!uiDstNode)
-      return;
+      return false;
     uiDstTarget = uiDstNode->pin(dstSplit.second);
   }
   else
@@ -814,16 +1814,33 @@ void DFGNotificationRouter::onPortsConnected(
   }
 
   if(!uiSrcTarget || !uiDstTarget)
-    return;
+    return false;
 
   uiGraph->addConnection(uiSrcTarget, uiDstTarget, false);
+  return true;
+}
+
+void DFGNotificationRouter::onPortsConnected(
+  FTL::CStrRef srcPath,
+  FTL::CStrRef dstPath
+  )
+{
+  if ( !connectTargets( srcPath, dstPath ) )
+    return;
 
   if(m_performChecks)
+    MarkConnectionErrorsDirty( m_dfgController, srcPath, dstPath );
+
+  // only the args of the root exec have bound values, and only the ones
+  // at either end of the connection can have had their type resolved;
+  // a substituted exec source has no binding to bind them on
+  if ( !m_execSource && m_dfgController->getExecPath().empty() )
   {
-    ((DFGController*)m_dfgController)->checkErrors();
+    if ( srcPath.split('.').second.empty() )
+      m_dfgController->bindUnboundRTVal( srcPath );
+    if ( dstPath.split('.').second.empty() )
+      m_dfgController->bindUnboundRTVal( dstPath );
   }
-
-  m_dfgController->bindUnboundRTVals();
 }
 
 void DFGNotificationRouter::onPortsDisconnected(
@@ -874,9 +1891,7 @@ void DFGNotificationRouter::onPortsDisconnected(
   uiGraph->removeConnection(uiSrcTarget, uiDstTarget, false);
 
   if(m_performChecks)
-  {
-    ((DFGController*)m_dfgController)->checkErrors();
-  }
+    MarkConnectionErrorsDirty( m_dfgController, srcPath, dstPath );
 }
 
 void DFGNotificationRouter::onNodeMetadataChanged(
@@ -896,34 +1911,26 @@ void DFGNotificationRouter::onNodeMetadataChanged(
 
   if(key == FTL_STR("uiGraphPos"))
   {
-    FTL::JSONStrWithLoc jsonStrWithLoc( value );
-    FTL::OwnedPtr<FTL::JSONValue const> jsonValue(
-      FTL::JSONValue::Decode( jsonStrWithLoc )
-      );
-    if ( jsonValue )
+    // echoes of moves the view made itself (eg. the end of a drag)
+    // find the node in place already
+    QPointF pos;
+    if ( m_metadataDecoder.decodePos( value, pos ) )
     {
-      FTL::JSONObject const *jsonObject = jsonValue->cast<FTL::JSONObject>();
-      float x = jsonObject->getFloat64( FTL_STR("x") );
-      float y = jsonObject->getFloat64( FTL_STR("y") );
-      uiNode->setTopLeftGraphPos(QPointF(x, y), false);
+      QPointF delta = pos - uiNode->topLeftGraphPos();
+      if ( fabs( delta.x() ) + fabs( delta.y() ) > 0.001 )
+        uiNode->setTopLeftGraphPos(pos, false);
     }
   }
   else if(key == FTL_STR("uiGraphSize"))
   {
-    FTL::JSONStrWithLoc jsonStrWithLoc( value );
-    FTL::OwnedPtr<FTL::JSONValue const> jsonValue(
-      FTL::JSONValue::Decode( jsonStrWithLoc )
-      );
-    if ( jsonValue )
+    QSizeF size;
+    if ( m_metadataDecoder.decodeSize( value, size ) )
     {
-      FTL::JSONObject const *jsonObject = jsonValue->cast<FTL::JSONObject>();
-      float w = jsonObject->getFloat64( FTL_STR("w") );
-      float h = jsonObject->getFloat64( FTL_STR("h") );
       if ( uiNode->isBackDropNode() )
       {
         GraphView::BackDropNode *uiBackDropNode =
           static_cast<GraphView::BackDropNode *>( uiNode );
-        uiBackDropNode->setSize( QSizeF( w, h ) );
+        uiBackDropNode->setSize( size );
       }
     }
   }
@@ -938,30 +1945,25 @@ void DFGNotificationRouter::onNodeMetadataChanged(
   }
   else if(key == FTL_STR("uiCollapsedState"))
   {
-    FabricCore::Variant metadataVar = FabricCore::Variant::CreateFromJSON(value.c_str());
-    GraphView::Node::CollapseState state = (GraphView::Node::CollapseState)metadataVar.getSInt32();
-    uiNode->setCollapsedState(state);
+    int state;
+    if ( m_metadataDecoder.decodeCollapsedState( value, state ) )
+      uiNode->setCollapsedState((GraphView::Node::CollapseState)state);
   }
   else if(key == FTL_STR("uiNodeColor"))
   {
-    FTL::JSONStrWithLoc jsonStrWithLoc( value );
-    FTL::OwnedPtr<FTL::JSONValue const> jsonValue(
-      FTL::JSONValue::Decode( jsonStrWithLoc )
-      );
-    if ( jsonValue )
+    QColor color;
+    if ( m_metadataDecoder.decodeColor( value, color ) )
     {
-      FTL::JSONObject const *jsonObject = jsonValue->cast<FTL::JSONObject>();
-      int r = int(jsonObject->getFloat64( FTL_STR("r") ));
-      int g = int(jsonObject->getFloat64( FTL_STR("g") ));
-      int b = int(jsonObject->getFloat64( FTL_STR("b") ));
       if ( uiNode->isBackDropNode() )
       {
-        uiNode->setColor( QColor( r, g, b, 0xA0 ) );
-        uiNode->setTitleColor( QColor( r, g, b, 0xB0 ) );
+        QColor backDropColor( color );
+        backDropColor.setAlpha( 0xA0 );
+        uiNode->setColor( backDropColor );
+        backDropColor.setAlpha( 0xB0 );
+        uiNode->setTitleColor( backDropColor );
       }
       else
       {
-        QColor color( r, g, b );
         uiNode->setColor(color);
         uiNode->setTitleColor(color.darker(130));
       }
@@ -969,43 +1971,25 @@ void DFGNotificationRouter::onNodeMetadataChanged(
   }
   else if(key == FTL_STR("uiHeaderColor"))
   {
-    FTL::JSONStrWithLoc jsonStrWithLoc( value );
-    FTL::OwnedPtr<FTL::JSONValue const> jsonValue(
-      FTL::JSONValue::Decode( jsonStrWithLoc )
-      );
-    if ( jsonValue )
+    QColor color;
+    if ( m_metadataDecoder.decodeColor( value, color ) )
     {
-      FTL::JSONObject const *jsonObject = jsonValue->cast<FTL::JSONObject>();
-      int r = int(jsonObject->getFloat64( FTL_STR("r") ));
-      int g = int(jsonObject->getFloat64( FTL_STR("g") ));
-      int b = int(jsonObject->getFloat64( FTL_STR("b") ));
       if ( uiNode->isBackDropNode() )
       {
-        uiNode->setTitleColor( QColor( r, g, b, 0xB0 ) );
+        color.setAlpha( 0xB0 );
+        uiNode->setTitleColor( color );
       }
       else
       {
-        QColor color(r, g, b);
         uiNode->setTitleColor(color);
       }
     }
   }
   else if(key == FTL_STR("uiTextColor"))
   {
-    FTL::JSONStrWithLoc jsonStrWithLoc( value );
-    FTL::OwnedPtr<FTL::JSONValue const> jsonValue(
-      FTL::JSONValue::Decode( jsonStrWithLoc )
-      );
-    if ( jsonValue )
-    {
-      FTL::JSONObject const *jsonObject = jsonValue->cast<FTL::JSONObject>();
-      int r = int(jsonObject->getFloat64( FTL_STR("r") ));
-      int g = int(jsonObject->getFloat64( FTL_STR("g") ));
-      int b = int(jsonObject->getFloat64( FTL_STR("b") ));
-
-      QColor color(r, g, b);
+    QColor color;
+    if ( m_metadataDecoder.decodeColor( value, color ) )
       uiNode->setFontColor(color);
-    }
   }
   else if(key == FTL_STR("uiTooltip"))
   {
@@ -1055,9 +2039,11 @@ void DFGNotificationRouter::onNodeTitleChanged(
   if(!uiNode)
     return;
 
-  FabricCore::DFGExec &exec = m_dfgController->getExec();
-  if ( exec.getNodeType( nodeName.c_str() ) == FabricCore::DFGNodeType_Inst
-    && exec.instExecIsPreset( nodeName.c_str() ) )
+  QSharedPointer<DFGExecBuildSource> source = execSource();
+  if ( !source )
+    return;
+  if ( source->getNodeType( nodeName ) == FabricCore::DFGNodeType_Inst
+    && source->instExecIsPreset( nodeName ) )
   {
     uiNode->setTitle( title );
     uiNode->update();
@@ -1076,9 +2062,10 @@ void DFGNotificationRouter::onNodeRenamed(
 
   GraphView::Node *uiNode = uiGraph->renameNode( oldNodeName, newNodeName );
 
-  FabricCore::DFGExec &exec = m_dfgController->getExec();
-  if ( exec.getNodeType( oldNodeName.c_str() ) == FabricCore::DFGNodeType_Inst
-    && !exec.instExecIsPreset( newNodeName.c_str() ) )
+  QSharedPointer<DFGExecBuildSource> source = execSource();
+  if ( source
+    && source->getNodeType( oldNodeName ) == FabricCore::DFGNodeType_Inst
+    && !source->instExecIsPreset( newNodeName ) )
   {
     assert( !!uiNode );
     uiNode->setTitle( newNodeName );
@@ -1159,7 +2146,9 @@ void DFGNotificationRouter::onExecMetadataChanged(
       FTL::JSONObject const *jsonObject = jsonValue->cast<FTL::JSONObject>();
       float x = jsonObject->getFloat64( FTL_STR("x") );
       float y = jsonObject->getFloat64( FTL_STR("y") );
-      uiGraph->mainPanel()->setCanvasPan(QPointF(x, y), false);
+      // the controller's own writes echo the pan the view already has
+      if ( uiGraph->mainPanel()->canvasPan() != QPointF(x, y) )
+        uiGraph->mainPanel()->setCanvasPan(QPointF(x, y), false);
     }
   }
   else if(key == "uiGraphZoom")
@@ -1236,11 +2225,18 @@ void DFGNotificationRouter::onExecPortResolvedTypeChanged(
 
   if(newResolvedType != uiPorts[0]->dataType())
   {
-    FabricCore::DFGExec &exec = m_dfgController->getExec();
+    QSharedPointer<DFGExecBuildSource> source = execSource();
+    if(!source)
+      return;
+    DFGExecBuildPlan::Port port;
+    port.dataType.assign(newResolvedType.data(), newResolvedType.size());
+    if(DFGExecBuildPlan::NeedsUIColor(newResolvedType, m_config.getColorTypes()))
+      port.uiColor = source->getExecPortMetadata(portName, "uiColor");
+    QColor color = getPortColor(port);
     for(size_t i=0;i<uiPorts.size();i++)
     {
       uiPorts[i]->setDataType(newResolvedType);
-      uiPorts[i]->setColor(m_config.getColorForDataType(newResolvedType, &exec, portName.c_str()));
+      uiPorts[i]->setColor(color);
     }
     uiGraph->updateColorForConnections(uiPorts[0]);
   }
@@ -1251,14 +2247,11 @@ void DFGNotificationRouter::onExecPortTypeSpecChanged(
   FTL::CStrRef newTypeSpec
   )
 {
-  FabricCore::DFGExec &exec = m_dfgController->getExec();
-  if(exec.getType() == FabricCore::DFGExecType_Func)
-  {
-    DFGKLEditorWidget * uiKlEditor = m_dfgController->getDFGWidget()->getKLEditor();
-    if(!uiKlEditor)
-      return;
-    uiKlEditor->onExecChanged();
-  }
+  QSharedPointer<DFGExecBuildSource> source = execSource();
+  if(!source)
+    return;
+  if(source->getExecType() == FabricCore::DFGExecType_Func)
+    refreshKLEditor();
 }
 
 void DFGNotificationRouter::onNodePortResolvedTypeChanged(
@@ -1280,15 +2273,17 @@ void DFGNotificationRouter::onNodePortResolvedTypeChanged(
 
   if(newResolvedType != uiPin->dataType())
   {
+    QSharedPointer<DFGExecBuildSource> source = execSource();
+    if(!source)
+      return;
     uiPin->setDataType(newResolvedType);
-    FabricCore::DFGExec &exec = m_dfgController->getExec();
-    if(exec.getNodeType(nodeName.c_str()) == FabricCore::DFGNodeType_Inst)
-    {
-      FabricCore::DFGExec subExec = exec.getSubExec( nodeName.c_str() );
-      uiPin->setColor(m_config.getColorForDataType(newResolvedType, &subExec, portName.data()));
-    }
-    else
-      uiPin->setColor(m_config.getColorForDataType(newResolvedType));
+    // only the ports of insts carry a color of their own
+    DFGExecBuildPlan::Port port;
+    port.dataType.assign(newResolvedType.data(), newResolvedType.size());
+    if(DFGExecBuildPlan::NeedsUIColor(newResolvedType, m_config.getColorTypes())
+      && source->getNodeType(nodeName) == FabricCore::DFGNodeType_Inst)
+      port.uiColor = source->getInstExecPortMetadata(nodeName, portName, "uiColor");
+    uiPin->setColor(getPortColor(port));
     uiGraph->updateColorForConnections(uiPin);
   }
 }
@@ -1315,14 +2310,11 @@ void DFGNotificationRouter::onExecPortTypeChanged(
   FTL::CStrRef execPortType
   )
 {
-  FabricCore::DFGExec &exec = m_dfgController->getExec();
-  if(exec.getType() == FabricCore::DFGExecType_Func)
-  {
-    DFGKLEditorWidget * uiKlEditor = m_dfgController->getDFGWidget()->getKLEditor();
-    if(!uiKlEditor)
-      return;
-    uiKlEditor->onExecChanged();
-  }
+  QSharedPointer<DFGExecBuildSource> source = execSource();
+  if(!source)
+    return;
+  if(source->getExecType() == FabricCore::DFGExecType_Func)
+    refreshKLEditor();
 }
 
 void DFGNotificationRouter::onNodePortTypeChanged(
@@ -1339,11 +2331,11 @@ void DFGNotificationRouter::onRefVarPathChanged(
   FTL::CStrRef newVarPath
   )
 {
-  FabricCore::DFGExec &exec = m_dfgController->getExec();
-  if ( !exec )
+  QSharedPointer<DFGExecBuildSource> source = execSource();
+  if ( !source )
     return;
 
-  FabricCore::DFGNodeType nodeType = exec.getNodeType(refName.c_str());
+  FabricCore::DFGNodeType nodeType = source->getNodeType(refName);
   std::string title = newVarPath;
   if(nodeType == FabricCore::DFGNodeType_Get)
     title = "get "+title;
@@ -1371,6 +2363,8 @@ void DFGNotificationRouter::onExecTitleChanged(
   )
 {
   DFGWidget *dfgWidget = m_dfgController->getDFGWidget();
+  if ( !dfgWidget )
+    return;
   dfgWidget->refreshTitle( title );
 }
 
@@ -1379,6 +2373,8 @@ void DFGNotificationRouter::onExecExtDepsChanged(
   )
 {
   DFGWidget *dfgWidget = m_dfgController->getDFGWidget();
+  if ( !dfgWidget )
+    return;
   dfgWidget->refreshExtDeps( extDeps );
 }
 
@@ -1452,14 +2448,18 @@ void DFGNotificationRouter::onExecPortsReordered(
   GraphView::SidePanel * leftPanel = uiGraph->sidePanel(GraphView::PortType_Input);
   GraphView::SidePanel * rightPanel = uiGraph->sidePanel(GraphView::PortType_Output);
 
-  FabricCore::DFGExec & exec = m_dfgController->getExec();
+  QSharedPointer<DFGExecBuildSource> source = execSource();
+  if(!source)
+    return;
   QStringList inputs, outputs;
-  for(unsigned int i=0;i<exec.getExecPortCount();i++)
+  unsigned int portCount = source->getExecPortCount();
+  for(unsigned int i=0;i<portCount;i++)
   {
-    QString name = exec.getExecPortName(i);
-    if(exec.getExecPortType(i) != FabricCore::DFGPortType_Out)
+    QString name = source->getExecPortName(i).c_str();
+    FabricCore::DFGPortType portType = source->getExecPortType(i);
+    if(portType != FabricCore::DFGPortType_Out)
       inputs.append(name);
-    if(exec.getExecPortType(i) != FabricCore::DFGPortType_In)
+    if(portType != FabricCore::DFGPortType_In)
       outputs.append(name);
   }
 
@@ -1481,12 +2481,14 @@ void DFGNotificationRouter::onNodePortsReordered(
   if(!uiNode)
     return;
 
-  FabricCore::DFGExec & exec = m_dfgController->getExec();
-  FabricCore::DFGExec subExec = exec.getSubExec(nodeName.c_str());
+  QSharedPointer<DFGExecBuildSource> source = execSource();
+  if(!source)
+    return;
   QStringList names;
-  for(unsigned int i=0;i<subExec.getExecPortCount();i++)
+  unsigned int portCount = source->getInstExecPortCount(nodeName);
+  for(unsigned int i=0;i<portCount;i++)
   {
-    QString name = subExec.getExecPortName(i);
+    QString name = source->getInstExecPortName(nodeName, i).c_str();
     names.append(name);
   }
 
@@ -1539,16 +2541,17 @@ void DFGNotificationRouter::onInstExecEditWouldSplitFromPresetMayHaveChanged(
   if(!uiNode)
     return;
 
-  FabricCore::DFGExec & exec = m_dfgController->getExec();
-  FabricCore::DFGExec subExec = exec.getSubExec( instName.c_str() );
-  if ( !subExec.isPreset() )
+  QSharedPointer<DFGExecBuildSource> source = execSource();
+  if ( !source )
+    return;
+  if ( !source->instExecIsPreset( instName ) )
   {
     uiNode->setTitle( instName );
     uiNode->setTitleSuffixAsterisk();
   }
   else
   {
-    uiNode->setTitle( subExec.getTitle() );
+    uiNode->setTitle( source->getInstExecTitle( instName ) );
     uiNode->removeTitleSuffix();
   }
 }
@@ -7,6 +7,16 @@
 #include <FTL/CStrRef.h>
 #include <FTL/JSONValue.h>
 #include <FabricUI/DFG/DFGConfig.h>
+#include <FabricUI/DFG/DFGExecBuildPlan.h>
+#include <FabricUI/DFG/DFGNotificationDescTable.h>
+#include <FabricUI/DFG/DFGUIMetadataDecoder.h>
+#include <FabricUI/GraphView/Node.h>
+
+#include <QtCore/QFutureWatcher>
+
+#include <map>
+#include <string>
+#include <vector>
 
 namespace FabricUI
 {
@@ -14,6 +24,8 @@ namespace FabricUI
   namespace DFG
   {
     class DFGController;
+    class DFGNotificationJSON;
+    class DFGNotificationRecorder;
     class DFGWidget;
 
     class DFGNotificationRouter : public QObject
@@ -29,15 +41,149 @@ namespace FabricUI
         DFGController *dfgController,
         const DFGConfig & config = DFGConfig()
         );
-      virtual ~DFGNotificationRouter() {}
+      virtual ~DFGNotificationRouter();
+
+      // when set, the handlers answer their queries about the exec from
+      // this source instead of the exec of the controller, eg. to play
+      // back a recording without a binding
+      void setExecSource( QSharedPointer<DFGExecBuildSource> source )
+        { m_execSource = source; }
+
+      // between these, the router answers from the given source and
+      // records nothing: neither the notifications, nor the answers and
+      // flushes; see DFGNotificationPlayer
+      void beginReplay( QSharedPointer<DFGExecBuildSource> source );
+      void endReplay();
+      bool isReplaying() const
+        { return m_replaying; }
+
+      // handles a notification as if it had been sent by the core,
+      // without recording it
+      void replayNotification( FTL::CStrRef jsonStr )
+        { handleNotification( jsonStr ); }
+
+      // builds the graph from an exec description on this thread,
+      // answering from the exec source
+      void buildGraphFromDesc( FTL::CStrRef desc );
+
+      // builds the graph of the exec from a resolved plan, without
+      // querying the exec
+      void applyBuildPlan( DFGExecBuildPlan const &plan );
+
+      // on by default: notifications received outside of a controller
+      // NotificationBracket (undo, redo, host or script driven commands)
+      // are queued and applied in one pass per event loop tick.  hosts
+      // that read the graph back right after an unbracketed Core call
+      // can turn it off, which flushes the queue.
+      void setCoalesceNotifications( bool coalesce );
+      bool coalesceNotifications() const
+        { return m_coalesceNotifications; }
 
     public slots:
 
       void onExecChanged();
 
+      // applies all queued notifications in a single pass
+      void flushNotifications();
+
+    signals:
+
+      // emitted once a graph built from a background plan is complete
+      void execBuilt();
+
+    private slots:
+
+      void onBuildPlanFinished();
+
     protected:
 
+      // Notifications are dispatched through a table keyed by the hash of
+      // their "desc" field.  Each entry declares the string fields its
+      // handler takes, which are extracted in order before the call; a
+      // field name starting with '?' is optional and reads as empty when
+      // missing.  The fields are slices of the notification itself, no
+      // DOM is built for them.  Handlers that need more than strings take
+      // the scanned notification instead and decode what they walk.
+      // Subclasses may register handlers for new descs, or replace
+      // existing ones, by static_cast'ing their member functions to the
+      // matching handler type.
+      typedef void (DFGNotificationRouter::*NotificationHandler0)();
+      typedef void (DFGNotificationRouter::*NotificationHandler1)(
+        FTL::CStrRef
+        );
+      typedef void (DFGNotificationRouter::*NotificationHandler2)(
+        FTL::CStrRef,
+        FTL::CStrRef
+        );
+      typedef void (DFGNotificationRouter::*NotificationHandler3)(
+        FTL::CStrRef,
+        FTL::CStrRef,
+        FTL::CStrRef
+        );
+      typedef void (DFGNotificationRouter::*NotificationHandler4)(
+        FTL::CStrRef,
+        FTL::CStrRef,
+        FTL::CStrRef,
+        FTL::CStrRef
+        );
+      typedef void (DFGNotificationRouter::*JSONNotificationHandler)(
+        DFGNotificationJSON const &
+        );
+
+      void registerNotificationHandler(
+        FTL::StrRef desc,
+        NotificationHandler0 handler
+        );
+      void registerNotificationHandler(
+        FTL::StrRef desc,
+        NotificationHandler1 handler,
+        char const *field0
+        );
+      void registerNotificationHandler(
+        FTL::StrRef desc,
+        NotificationHandler2 handler,
+        char const *field0,
+        char const *field1
+        );
+      void registerNotificationHandler(
+        FTL::StrRef desc,
+        NotificationHandler3 handler,
+        char const *field0,
+        char const *field1,
+        char const *field2
+        );
+      void registerNotificationHandler(
+        FTL::StrRef desc,
+        NotificationHandler4 handler,
+        char const *field0,
+        char const *field1,
+        char const *field2,
+        char const *field3
+        );
+      void registerNotificationHandler(
+        FTL::StrRef desc,
+        JSONNotificationHandler handler
+        );
+      bool hasNotificationHandler( FTL::StrRef desc ) const;
+
+      // builds the graph of the exec; the plans of descriptions of at
+      // least DFGConfig::asyncGraphBuildThreshold bytes are resolved on a
+      // worker thread, in which case execBuilt() is emitted when done
       void onGraphSet();
+      void buildGraph();
+      GraphView::Node *addPlanNode( DFGExecBuildPlan::Node const &node );
+      void addPlanNodePin(
+        GraphView::Node *uiNode,
+        DFGExecBuildPlan::Port const &port
+        );
+      void addPlanExecPort( DFGExecBuildPlan::Port const &port );
+      QColor getPortColor( DFGExecBuildPlan::Port const &port );
+      void refreshKLEditor();
+      // adds the view connection, returns false if an end is missing
+      bool connectTargets(
+        FTL::CStrRef srcPath,
+        FTL::CStrRef dstPath
+        );
       void onNotification(FTL::CStrRef json);
       void onNodeInserted(
         FTL::CStrRef nodeName,
@@ -196,7 +342,80 @@ namespace FabricUI
 
     private:
 
+      enum { MaxNotificationFields = 4 };
+      // plans invalidated by edits are restarted this many times before
+      // the graph is built on the GUI thread
+      enum { MaxBuildPlanRestarts = 3 };
+
+      struct NotificationEntry
+      {
+        // number of string fields, or -1 for a JSONNotificationHandler
+        int fieldCount;
+        std::string fields[MaxNotificationFields];
+        bool optional[MaxNotificationFields];
+        // cast back to the real handler type according to fieldCount
+        NotificationHandler0 handler;
+      };
+
+      void registerBuiltinNotificationHandlers();
+      void addNotificationEntry(
+        FTL::StrRef desc,
+        int fieldCount,
+        NotificationHandler0 handler,
+        char const *field0 = 0,
+        char const *field1 = 0,
+        char const *field2 = 0,
+        char const *field3 = 0
+        );
+      NotificationEntry const *findNotificationEntry(
+        FTL::StrRef desc
+        ) const;
+
+      void dispatchNodeInserted( DFGNotificationJSON const &notification );
+      void dispatchNodePortInserted( DFGNotificationJSON const &notification );
+      void dispatchExecPortInserted( DFGNotificationJSON const &notification );
+      void dispatchExecPortRenamed( DFGNotificationJSON const &notification );
+      void dispatchExecPortsReordered( DFGNotificationJSON const &notification );
+      void dispatchNodePortsReordered( DFGNotificationJSON const &notification );
+
+      struct QueuedNotification
+      {
+        DFGNotificationJSON *notification;
+        std::vector<std::string> nodeNames;
+        std::vector<std::string> portPaths;
+        bool cancelled;
+      };
+
+      // rewrite a queued notification for a rename that is folded into a
+      // queued insertion
+      static void renameQueuedNode(
+        QueuedNotification &queued,
+        std::string const &oldNodeName,
+        std::string const &newNodeName
+        );
+      static void renameQueuedPort(
+        QueuedNotification &queued,
+        FTL::StrRef nodeName,
+        std::string const &oldPortName,
+        std::string const &newPortName
+        );
+
+      // the source the handlers query about the exec, null without an
+      // exec; queries are recorded along with the notifications
+      QSharedPointer<DFGExecBuildSource> execSource();
+      // the recorder of the controller, null while replaying
+      DFGNotificationRecorder *notificationRecorder() const;
+
       void callback( FTL::CStrRef jsonStr );
+      void handleNotification( FTL::CStrRef jsonStr );
+      void dispatch( DFGNotificationJSON const &notification );
+      void invoke(
+        NotificationEntry const &entry,
+        DFGNotificationJSON const &notification
+        );
+      void queueNotification( FTL::CStrRef jsonStr );
+      void cancelBuildPlan();
+      void clearQueuedNotifications();
 
       static void Callback(
         void *thisVoidPtr,
@@ -213,6 +432,24 @@ namespace FabricUI
       FabricCore::DFGView m_coreDFGView;
       DFGConfig m_config;
       bool m_performChecks;
+      DFGUIMetadataDecoder m_metadataDecoder;
+      QSharedPointer<DFGExecBuildSource> m_execSource;
+      bool m_replaying;
+      bool m_coalesceNotifications;
+      bool m_flushPending;
+      std::vector<QueuedNotification> m_queuedNotifications;
+      std::map<std::string, size_t> m_queuedNodeInserts;
+      // keyed by "node.port", or "port" for exec ports
+      std::map<std::string, size_t> m_queuedPortInserts;
+      std::map<std::string, size_t> m_queuedMetadata;
+      bool m_buildPlanPending;
+      unsigned m_buildPlanRestarts;
+      size_t m_buildPlanQueuedCount;
+      DFGExecBuildToken m_buildPlanToken;
+      QFutureWatcher< QSharedPointer<DFGExecBuildPlan> > *m_buildPlanWatcher;
+      // the entries are stored at the indices of their descs
+      DFGNotificationDescTable m_notificationDescs;
+      std::vector<NotificationEntry> m_notificationEntries;
     };
 
   };
@@ -0,0 +1,238 @@
+// Copyright 2010-2015 Fabric Software Inc. All rights reserved.
+
+#include <FabricUI/DFG/DFGUIMetadataDecoder.h>
+#include <FabricUI/Util/StrHash.h>
+
+#include <FTL/JSONValue.h>
+#include <FTL/OwnedPtr.h>
+
+#include <stdint.h>
+
+using namespace FabricUI;
+using namespace FabricUI::DFG;
+
+static inline void SkipWhitespace( char const *&p, char const *end )
+{
+  while ( p != end
+    && ( *p == ' ' || *p == '\t' || *p == '\n' || *p == '\r' ) )
+    ++p;
+}
+
+// Parses a JSON number.  Unlike strtod this does not depend on the
+// current locale, which Qt sets from the environment.
+static bool ScanNumber( char const *&p, char const *end, double &value )
+{
+  bool negative = false;
+  if ( p != end && *p == '-' )
+  {
+    negative = true;
+    ++p;
+  }
+
+  if ( p == end || *p < '0' || *p > '9' )
+    return false;
+  double result = 0.0;
+  while ( p != end && *p >= '0' && *p <= '9' )
+    result = result * 10.0 + double( *p++ - '0' );
+
+  if ( p != end && *p == '.' )
+  {
+    ++p;
+    if ( p == end || *p < '0' || *p > '9' )
+      return false;
+    double scale = 0.1;
+    while ( p != end && *p >= '0' && *p <= '9' )
+    {
+      result += scale * double( *p++ - '0' );
+      scale *= 0.1;
+    }
+  }
+
+  if ( p != end && ( *p == 'e' || *p == 'E' ) )
+  {
+    ++p;
+    bool negativeExponent = false;
+    if ( p != end && ( *p == '+' || *p == '-' ) )
+      negativeExponent = *p++ == '-';
+    if ( p == end || *p < '0' || *p > '9' )
+      return false;
+    int exponent = 0;
+    while ( p != end && *p >= '0' && *p <= '9' )
+    {
+      if ( exponent < 1000 )
+        exponent = exponent * 10 + ( *p - '0' );
+      ++p;
+    }
+    double factor = 1.0;
+    for ( int i = 0; i < exponent; ++i )
+      factor *= 10.0;
+    if ( negativeExponent )
+      result /= factor;
+    else
+      result *= factor;
+  }
+
+  value = negative ? -result : result;
+  return true;
+}
+
+bool DFGUIMetadataDecoder::ScanNumbers(
+  FTL::CStrRef json,
+  char const * const *keys,
+  unsigned count,
+  double *values
+  )
+{
+  char const *p = json.data();
+  char const *end = p + json.size();
+
+  SkipWhitespace( p, end );
+  if ( p == end || *p++ != '{' )
+    return false;
+
+  unsigned foundMask = 0;
+  unsigned found = 0;
+  for (;;)
+  {
+    SkipWhitespace( p, end );
+    if ( p == end || *p++ != '"' )
+      return false;
+    char const *keyBegin = p;
+    while ( p != end && *p != '"' )
+    {
+      // keys with escapes are left to the generic decoder
+      if ( *p == '\\' )
+        return false;
+      ++p;
+    }
+    if ( p == end )
+      return false;
+    FTL::StrRef key( keyBegin, p - keyBegin );
+    ++p;
+
+    unsigned index = 0;
+    while ( index < count && !( key == FTL::StrRef( keys[index] ) ) )
+      ++index;
+    if ( index == count || ( foundMask & ( 1u << index ) ) )
+      return false;
+
+    SkipWhitespace( p, end );
+    if ( p == end || *p++ != ':' )
+      return false;
+    SkipWhitespace( p, end );
+    if ( !ScanNumber( p, end, values[index] ) )
+      return false;
+    foundMask |= 1u << index;
+    ++found;
+
+    SkipWhitespace( p, end );
+    if ( p == end )
+      return false;
+    char c = *p++;
+    if ( c == '}' )
+      break;
+    if ( c != ',' )
+      return false;
+  }
+
+  SkipWhitespace( p, end );
+  return p == end && found == count;
+}
+
+bool DFGUIMetadataDecoder::DecodeNumbers(
+  FTL::CStrRef json,
+  char const * const *keys,
+  unsigned count,
+  double *values
+  )
+{
+  FTL::JSONStrWithLoc jsonStrWithLoc( json );
+  FTL::OwnedPtr<FTL::JSONValue const> jsonValue(
+    FTL::JSONValue::Decode( jsonStrWithLoc )
+    );
+  if ( !jsonValue.get() )
+    return false;
+  FTL::JSONObject const *jsonObject = jsonValue->cast<FTL::JSONObject>();
+  for ( unsigned i = 0; i < count; ++i )
+    values[i] = jsonObject->getFloat64( FTL::StrRef( keys[i] ) );
+  return true;
+}
+
+DFGUIMetadataDecoder::DFGUIMetadataDecoder()
+{
+}
+
+bool DFGUIMetadataDecoder::decodePos( FTL::CStrRef json, QPointF &pos )
+{
+  static char const * const keys[2] = { "x", "y" };
+  double values[2];
+  if ( !ScanNumbers( json, keys, 2, values )
+    && !DecodeNumbers( json, keys, 2, values ) )
+    return false;
+  pos = QPointF( float( values[0] ), float( values[1] ) );
+  return true;
+}
+
+bool DFGUIMetadataDecoder::decodeSize( FTL::CStrRef json, QSizeF &size )
+{
+  static char const * const keys[2] = { "w", "h" };
+  double values[2];
+  if ( !ScanNumbers( json, keys, 2, values )
+    && !DecodeNumbers( json, keys, 2, values ) )
+    return false;
+  size = QSizeF( float( values[0] ), float( values[1] ) );
+  return true;
+}
+
+bool DFGUIMetadataDecoder::decodeColor( FTL::CStrRef json, QColor &color )
+{
+  // direct mapped on the hash of the raw string
+  CachedColor &cached =
+    m_colorCache[Util::HashStr( json ) % ColorCacheSize];
+  if ( !cached.json.empty()
+    && FTL::StrRef( cached.json.data(), cached.json.size() ) == json )
+  {
+    color = cached.color;
+    return true;
+  }
+
+  static char const * const keys[3] = { "r", "g", "b" };
+  double values[3];
+  if ( !ScanNumbers( json, keys, 3, values )
+    && !DecodeNumbers( json, keys, 3, values ) )
+    return false;
+  color = QColor( int( values[0] ), int( values[1] ), int( values[2] ) );
+
+  cached.json.assign( json.data(), json.size() );
+  cached.color = color;
+  return true;
+}
+
+bool DFGUIMetadataDecoder::decodeCollapsedState(
+  FTL::CStrRef json,
+  int &state
+  )
+{
+  char const *p = json.data();
+  char const *end = p + json.size();
+  SkipWhitespace( p, end );
+  double value;
+  if ( ScanNumber( p, end, value ) )
+  {
+    SkipWhitespace( p, end );
+    if ( p == end )
+    {
+      state = int( value );
+      return true;
+    }
+  }
+
+  FTL::JSONStrWithLoc jsonStrWithLoc( json );
+  FTL::OwnedPtr<FTL::JSONValue const> jsonValue(
+    FTL::JSONValue::Decode( jsonStrWithLoc )
+    );
+  if ( !jsonValue.get() )
+    return false;
+  state = int( jsonValue->getSInt32Value() );
+  return true;
+}
@@ -0,0 +1,75 @@
+// Copyright 2010-2015 Fabric Software Inc. All rights reserved.
+
+#ifndef __UI_DFG_DFGUIMetadataDecoder__
+#define __UI_DFG_DFGUIMetadataDecoder__
+
+#include <FTL/CStrRef.h>
+
+#include <QtCore/QPointF>
+#include <QtCore/QSizeF>
+#include <QtGui/QColor>
+
+#include <string>
+
+namespace FabricUI
+{
+
+  namespace DFG
+  {
+
+    // Decodes the fixed-shape values of the well-known ui* metadata:
+    //
+    //   uiGraphPos        {"x":..,"y":..}
+    //   uiGraphSize       {"w":..,"h":..}
+    //   ui*Color          {"r":..,"g":..,"b":..}
+    //   uiCollapsedState  an integer
+    //
+    // The common flat forms are scanned directly without allocating;
+    // anything else falls back to the generic JSON decoder, which throws
+    // FTL::JSONException on malformed input.  Colors tend to repeat
+    // across nodes, so they also go through a small cache keyed on the
+    // raw string.
+    class DFGUIMetadataDecoder
+    {
+    public:
+
+      DFGUIMetadataDecoder();
+
+      bool decodePos( FTL::CStrRef json, QPointF &pos );
+      bool decodeSize( FTL::CStrRef json, QSizeF &size );
+      bool decodeColor( FTL::CStrRef json, QColor &color );
+      bool decodeCollapsedState( FTL::CStrRef json, int &state );
+
+    private:
+
+      // fills values in the order of keys; returns false if json is not
+      // a flat object holding exactly these numeric members
+      static bool ScanNumbers(
+        FTL::CStrRef json,
+        char const * const *keys,
+        unsigned count,
+        double *values
+        );
+      static bool DecodeNumbers(
+        FTL::CStrRef json,
+        char const * const *keys,
+        unsigned count,
+        double *values
+        );
+
+      enum { ColorCacheSize = 64 };
+
+      struct CachedColor
+      {
+        std::string json;
+        QColor color;
+      };
+
+      CachedColor m_colorCache[ColorCacheSize];
+    };
+
+  };
+
+};
+
+#endif // __UI_DFG_DFGUIMetadataDecoder__
@@ -1943,6 +1943,10 @@ void DFGWidget::onExecChanged()
     m_router =
       static_cast<DFGNotificationRouter *>( m_uiController->createRouter() );
     m_uiController->setRouter(m_router);
+    QObject::connect(
+      m_router, SIGNAL(execBuilt()),
+      this, SLOT(onExecBuilt())
+      );
   
     if(m_isEditable)
     {
@@ -1993,3 +1997,10 @@ void DFGWidget::onExecChanged()
 
   emit execChanged();
 }
+
+void DFGWidget::onExecBuilt()
+{
+  // the graph was built asynchronously, see DFGNotificationRouter::onGraphSet
+  if ( m_uiGraph )
+    emit onGraphSet(m_uiGraph);
+}
@@ -85,6 +85,7 @@ namespace FabricUI
     public slots:
 
       void onExecChanged();
+      void onExecBuilt();
       void onGoUpPressed();
       void onGraphAction(QAction * action);
       void onNodeAction(QAction * action);
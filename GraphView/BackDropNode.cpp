@@ -238,25 +238,16 @@ void BackDropNode::mouseReleaseEvent(QGraphicsSceneMouseEvent * event)
 
 void BackDropNode::appendOverlappingNodes( std::vector<Node*> &nodes ) const
 {
-  std::vector<Node *> all = graph()->nodes();
+  std::vector<Node *> contained =
+    m_graph->nodesContainedIn(m_graph->spatialIndex().bounds(this));
 
-  QPointF topLeft = mapToScene(boundingRect().topLeft());
-  QPointF bottomRight = mapToScene(boundingRect().bottomRight());
-  QRectF rect(topLeft, bottomRight);
-
-  for(size_t i=0;i<all.size();i++)
+  for(size_t i=0;i<contained.size();i++)
   {
-    if ( all[i]->isBackDropNode() )
+    if ( contained[i]->isBackDropNode() )
       continue;
-    if(all[i]->selected())
+    if(contained[i]->selected())
       continue;
-
-    QPointF topLeft2 = all[i]->mapToScene(all[i]->boundingRect().topLeft());
-    QPointF bottomRight2 = all[i]->mapToScene(all[i]->boundingRect().bottomRight());
-    QRectF rect2(topLeft2, bottomRight2);
-
-    if(rect.contains(rect2))
-      nodes.push_back(all[i]);
+    nodes.push_back(contained[i]);
   }
 }
 
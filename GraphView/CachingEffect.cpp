@@ -1,23 +1,84 @@
 // Copyright 2010-2015 Fabric Software Inc. All rights reserved.
 
 #include <FabricUI/GraphView/CachingEffect.h>
+#include <FabricUI/GraphView/NodePixmapCache.h>
 
 #include <QtGui/QPainter>
 #include <QtGui/QPixmap>
 #include <QtGui/QPixmapCache>
 
+#include <math.h>
+
 using namespace FabricUI::GraphView;
 
-CachingEffect::CachingEffect(QGraphicsWidget * parent)
+CachingEffect::CachingEffect(QGraphicsWidget * parent, NodePixmapCache * pixmapCache)
 : QGraphicsEffect(parent)
 {
   QPixmapCache::setCacheLimit(10240 * 10);
+  m_pixmapCache = pixmapCache;
+  m_dirtyFlags = 0;
+}
+
+CachingEffect::~CachingEffect()
+{
+  if(m_pixmapCache)
+    m_pixmapCache->invalidate(this);
+}
+
+void CachingEffect::markDirty(unsigned int flags)
+{
+  m_dirtyFlags |= flags;
+  if(m_pixmapCache)
+    m_pixmapCache->invalidate(this);
+  update();
+}
+
+void CachingEffect::sourceChanged(ChangeFlags flags)
+{
+  // a resized source can't reuse its pixmaps, moving it doesn't matter
+  if(flags.testFlag(SourceBoundingRectChanged) && m_pixmapCache)
+    m_pixmapCache->invalidate(this);
 }
 
 void CachingEffect::draw(QPainter * painter)
 {
-  QPoint point;
-  QPixmap pixmap = sourcePixmap(Qt::DeviceCoordinates, &point, NoPad);
-  painter->setWorldTransform(QTransform());
-  painter->drawPixmap(point, pixmap);
+  QTransform xfo = painter->worldTransform();
+  float scale = sqrtf(float(xfo.m11() * xfo.m11() + xfo.m12() * xfo.m12()));
+  int bucket = NodePixmapCache::Bucket(scale);
+
+  // zoomed in views show few nodes, they are cached at device resolution
+  if(!m_pixmapCache || bucket > 0 || xfo.isRotating())
+  {
+    QPoint point;
+    QPixmap pixmap = sourcePixmap(Qt::DeviceCoordinates, &point, NoPad);
+    painter->setWorldTransform(QTransform());
+    painter->drawPixmap(point, pixmap);
+    return;
+  }
+
+  NodePixmapCache::Entry const * entry = m_pixmapCache->find(this, bucket);
+  if(!entry)
+  {
+    QPoint offset;
+    QPixmap pixmap = sourcePixmap(Qt::LogicalCoordinates, &offset, NoPad);
+    float bucketScale = NodePixmapCache::BucketScale(bucket);
+    if(bucket < 0)
+    {
+      pixmap = pixmap.scaled(
+        qMax(1, int(ceilf(pixmap.width() * bucketScale))),
+        qMax(1, int(ceilf(pixmap.height() * bucketScale))),
+        Qt::IgnoreAspectRatio,
+        Qt::SmoothTransformation
+        );
+    }
+    entry = m_pixmapCache->insert(this, bucket, pixmap, QPointF(offset), bucketScale);
+    m_dirtyFlags = 0;
+  }
+
+  // the bucket is at most twice the device resolution
+  painter->save();
+  painter->translate(entry->offset);
+  painter->scale(1.0f / entry->scale, 1.0f / entry->scale);
+  painter->drawPixmap(0, 0, entry->pixmap);
+  painter->restore();
 }
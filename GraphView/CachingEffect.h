@@ -11,16 +11,44 @@ namespace FabricUI
 
   namespace GraphView
   {
+    // forward declarations
+    class NodePixmapCache;
+
     class CachingEffect : public QGraphicsEffect
     {
       Q_OBJECT
 
     public:
 
-      CachingEffect(QGraphicsWidget * parent);
-      virtual ~CachingEffect() {}
+      // what changed in the source, any of them drops the cached pixmaps
+      enum DirtyFlag
+      {
+        Dirty_Title = 1,
+        Dirty_Color = 2,
+        Dirty_Pins = 4,
+        Dirty_Selection = 8,
+        Dirty_Style = 16,
+        Dirty_All = 31
+      };
+
+      // without a pixmap cache the source is cached per device transform
+      CachingEffect(QGraphicsWidget * parent, NodePixmapCache * pixmapCache = NULL);
+      virtual ~CachingEffect();
+
+      void markDirty(unsigned int flags);
+      // the flags accumulated since the cached pixmaps were last rebuilt
+      unsigned int dirtyFlags() const { return m_dirtyFlags; }
 
       virtual void draw(QPainter * painter);
+
+    protected:
+
+      virtual void sourceChanged(ChangeFlags flags);
+
+    private:
+
+      NodePixmapCache * m_pixmapCache;
+      unsigned int m_dirtyFlags;
     };
 
   };
@@ -25,10 +25,20 @@ Connection::Connection(
   , m_graph( graph )
   , m_src( src )
   , m_dst( dst )
+  , m_graphIndex( 0 )
+  , m_srcIndex( 0 )
+  , m_dstIndex( 0 )
   , m_hovered( false )
   , m_dragging( false )
   , m_aboutToBeDeleted( false )
   , m_hasSelectedTarget( false )
+  , m_hasPath( false )
+  , m_pathDirty( false )
+  , m_dirtyIndex( 0 )
+  , m_virtualized( false )
+  , m_virtualizationCandidate( false )
+  , m_candidateIndex( 0 )
+  , m_detachedIndex( -1 )
 {
   m_isExposedConnection = 
     m_src->targetType() == TargetType_ProxyPort ||
@@ -74,50 +84,25 @@ Connection::Connection(
 
   setZValue(-1);
 
-  dependencyMoved();
+  // during a bulk build the graph computes all paths once at the end
+  if(!graph->isBulkBuilding())
+    dependencyMoved();
   dependencySelected();
 
-  MainPanel *mainPanel = graph->mainPanel();
-  QObject::connect(
-    mainPanel, SIGNAL(geometryChanged()),
-    this, SLOT(dependencyMoved())
-    );
-  QObject::connect(
-    mainPanel, SIGNAL(canvasZoomChanged(float)),
-    this, SLOT(dependencyMoved())
-    );
-  QObject::connect(
-    mainPanel, SIGNAL(canvasPanChanged(QPointF)),
-    this, SLOT(dependencyMoved())
-    );
-
+  // moving end points mark the connection dirty through the graph, see
+  // Graph::markConnectionsDirty.  only the mouse grabber, which is not
+  // tracked by the graph, drives the path directly.
   for(int i=0;i<2;i++)
   {
     ConnectionTarget * target = src;
     if(i>0)
       target = dst;
 
-    if(target->targetType() == TargetType_Pin)
-    {
-      Pin * pin = (Pin*)target;
-      Node * node = pin->node();
-      QObject::connect(pin, SIGNAL(visibleChanged()), this, SLOT(dependencyMoved()));
-      QObject::connect(pin, SIGNAL(yChanged()), this, SLOT(dependencyMoved()));
-      QObject::connect(node, SIGNAL(positionChanged(FabricUI::GraphView::Node *, QPointF)), this, SLOT(dependencyMoved()));
-      QObject::connect(node, SIGNAL(geometryChanged()), this, SLOT(dependencyMoved()));
-      QObject::connect(node, SIGNAL(selectionChanged(FabricUI::GraphView::Node *, bool)), this, SLOT(dependencySelected()));
-    }
-    else if(target->targetType() == TargetType_MouseGrabber)
+    if(target->targetType() == TargetType_MouseGrabber)
     {
       MouseGrabber * grabber = (MouseGrabber*)target;
       QObject::connect(grabber, SIGNAL(positionChanged(QPointF)), this, SLOT(dependencyMoved()));
     }
-    else if(target->targetType() == TargetType_Port)
-    {
-      Port * port = (Port*)target;
-      QObject::connect(port, SIGNAL(positionChanged()), this, SLOT(dependencyMoved()));
-      QObject::connect(port->sidePanel(), SIGNAL(scrolled()), this, SLOT(dependencyMoved()));
-    }
   }
 }
 
@@ -295,6 +280,17 @@ void Connection::mouseMoveEvent(QGraphicsSceneMouseEvent * event)
 
 void Connection::paint(QPainter * painter, const QStyleOptionGraphicsItem * option, QWidget * widget)
 {
+  if(m_graph->mainPanel()->lodTier() == MainPanel::LODTier_Dots)
+  {
+    // the path runs back to its source to close the hover area, so its
+    // current position is the source again
+    if(!m_hasPath)
+      return;
+    painter->setPen(pen());
+    painter->drawLine(m_pathSrcPoint, m_pathDstPoint);
+    return;
+  }
+
   if(m_isExposedConnection && !m_hovered && !m_hasSelectedTarget && m_graph->config().dimConnectionLines)
   {
     painter->setOpacity(0.15);
@@ -313,9 +309,19 @@ void Connection::paint(QPainter * painter, const QStyleOptionGraphicsItem * opti
 
 void Connection::dependencyMoved()
 {
-  QPointF currSrcPoint = srcPoint();
-  QPointF currDstPoint = dstPoint();
-  float tangentLength = computeTangentLength();
+  updatePath(srcPoint(), dstPoint());
+}
+
+void Connection::updatePath(QPointF currSrcPoint, QPointF currDstPoint)
+{
+  // the signals firing this slot do not always move an end point
+  if(m_hasPath && currSrcPoint == m_pathSrcPoint && currDstPoint == m_pathDstPoint)
+    return;
+  m_hasPath = true;
+  m_pathSrcPoint = currSrcPoint;
+  m_pathDstPoint = currDstPoint;
+
+  float tangentLength = computeTangentLength(currSrcPoint, currDstPoint);
 
   // painter->setRenderHint(QPainter::Antialiasing,true);
   // painter->setRenderHint(QPainter::HighQualityAntialiasing,true);
@@ -366,11 +372,8 @@ void Connection::dependencySelected()
   update();
 }
 
-float Connection::computeTangentLength() const
+float Connection::computeTangentLength(QPointF currSrcPoint, QPointF currDstPoint) const
 {
-  QPointF currSrcPoint = srcPoint();
-  QPointF currDstPoint = dstPoint();
-
   // if the connection points are on the wrong
   // sides, we need to scale up the boundingRect
   float tangentLength = 0.0f;
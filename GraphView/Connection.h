@@ -51,6 +51,10 @@ namespace FabricUI
       QPointF srcPoint() const;
       QPointF dstPoint() const;
 
+      // true while the connection is off screen, see Graph::updateVirtualization
+      bool isVirtualized() const
+        { return m_virtualized; }
+
       virtual void invalidate();
       
       virtual void hoverEnterEvent(QGraphicsSceneHoverEvent * event);
@@ -66,12 +70,25 @@ namespace FabricUI
 
     private:
 
-      float computeTangentLength() const;
+      // maintained by the graph
+      friend class Graph;
+      // orders by m_graphIndex
+      friend class GraphTraversal;
+
+      float computeTangentLength(QPointF srcPoint, QPointF dstPoint) const;
+      // end points are in graph space
+      void updatePath(QPointF srcPoint, QPointF dstPoint);
 
       Graph * m_graph;
       ConnectionTarget * m_src;
       ConnectionTarget * m_dst;
 
+      // positions in the graph's connection list and in the adjacency
+      // lists of the targets, so removing a connection is O(1)
+      size_t m_graphIndex;
+      size_t m_srcIndex;
+      size_t m_dstIndex;
+
       QColor m_color;
       QPen m_defaultPen;
       QPen m_hoverPen;
@@ -84,6 +101,21 @@ namespace FabricUI
       bool m_hasSelectedTarget;
       float m_clipRadius;
       QPainterPath m_clipPath;
+      // the end points the path was last built for, in graph space
+      bool m_hasPath;
+      QPointF m_pathSrcPoint;
+      QPointF m_pathDstPoint;
+      // queued in the graph's dirty connections, at m_dirtyIndex
+      bool m_pathDirty;
+      size_t m_dirtyIndex;
+      // hidden and left out of path updates while off screen
+      bool m_virtualized;
+      // queued for the graph's next virtualization pass, at m_candidateIndex
+      bool m_virtualizationCandidate;
+      size_t m_candidateIndex;
+      // between two virtualized nodes, at m_detachedIndex in the graph's
+      // detached connections, -1 otherwise
+      int m_detachedIndex;
     };
 
   };
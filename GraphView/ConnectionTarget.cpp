@@ -30,7 +30,7 @@ ConnectionTarget::~ConnectionTarget()
 
 bool ConnectionTarget::isConnected() const
 {
-  return graph()->isConnected(this);
+  return !m_inConnections.empty() || !m_outConnections.empty();
 }
 
 void ConnectionTarget::hoverEnterEvent(QGraphicsSceneHoverEvent * event)
@@ -8,12 +8,15 @@
 #include <QtCore/QPointF>
 #include "PortType.h"
 
+#include <vector>
+
 namespace FabricUI
 {
 
   namespace GraphView
   {
     // forward declarations
+    class Connection;
     class Graph;
     class PinCircle;
 
@@ -53,14 +56,26 @@ namespace FabricUI
 
       virtual bool isConnected() const;
 
+      // the connections of the graph ending or starting here
+      std::vector<Connection *> const &inConnections() const
+        { return m_inConnections; }
+      std::vector<Connection *> const &outConnections() const
+        { return m_outConnections; }
+
       virtual void hoverEnterEvent(QGraphicsSceneHoverEvent * event);
       virtual void hoverLeaveEvent(QGraphicsSceneHoverEvent * event);
       virtual void mousePressEvent(QGraphicsSceneMouseEvent * event);
 
     private:
+
+      // maintained by the graph
+      friend class Graph;
+
       PinCircle * findPinCircle(QPointF pos);
 
       PinCircle * m_lastPinCircle;
+      std::vector<Connection *> m_inConnections;
+      std::vector<Connection *> m_outConnections;
 #if defined(FTL_BUILD_DEBUG)
       bool m_deleted;
 #endif
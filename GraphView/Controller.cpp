@@ -21,6 +21,14 @@ Controller::Controller(Graph * parent)
     m_graph->setController(this);
   m_compound = NULL;
   m_interactionBracket = 0;
+
+  m_canvasPersistTimer = new QTimer(this);
+  m_canvasPersistTimer->setSingleShot(true);
+  QObject::connect(m_canvasPersistTimer, SIGNAL(timeout()), this, SLOT(flushCanvasState()));
+  m_canvasZoomPending = false;
+  m_canvasPanPending = false;
+  m_pendingCanvasZoom = 1.0f;
+  resetCanvasCounters();
 }
 
 Controller::~Controller()
@@ -82,16 +90,21 @@ bool Controller::selectNode(Node * node, bool state)
   return false;
 }
 
+bool Controller::selectNodes(
+  const std::vector<Node*> & toSelect,
+  const std::vector<Node*> & toDeselect
+  )
+{
+  if(!m_graph)
+    return false;
+  return m_graph->updateSelection(toSelect, toDeselect);
+}
+
 bool Controller::clearSelection()
 {
   if(!m_graph)
     return false;
-  std::vector<Node*> nodes = m_graph->selectedNodes();
-  for(size_t i=0;i<nodes.size();i++)
-  {
-    nodes[i]->setSelected(false);
-  }
-  return nodes.size() > 0;
+  return m_graph->setSelection(std::vector<Node*>());
 }
 
 bool Controller::gvcDoRemoveConnection(Connection * conn)
@@ -104,6 +117,10 @@ bool Controller::zoomCanvas(float zoom)
   if(!m_graph)
     return false;
   m_graph->mainPanel()->setCanvasZoom(zoom, true);
+  m_pendingCanvasZoom = m_graph->mainPanel()->canvasZoom();
+  m_canvasZoomPending = true;
+  m_canvasChangeCount++;
+  scheduleCanvasPersist();
   return true;
 }
 
@@ -112,9 +129,61 @@ bool Controller::panCanvas(QPointF pan)
   if(!m_graph)
     return false;
   m_graph->mainPanel()->setCanvasPan(pan, true);
+  m_pendingCanvasPan = pan;
+  m_canvasPanPending = true;
+  m_canvasChangeCount++;
+  scheduleCanvasPersist();
   return true;
 }
 
+bool Controller::hasPendingCanvasState() const
+{
+  return m_canvasZoomPending || m_canvasPanPending;
+}
+
+void Controller::resetCanvasCounters()
+{
+  m_canvasChangeCount = 0;
+  m_canvasWriteCount = 0;
+}
+
+void Controller::flushCanvasState()
+{
+  m_canvasPersistTimer->stop();
+  if(!hasPendingCanvasState())
+    return;
+
+  // cleared first, persisting may notify back into the controller
+  bool zoomChanged = m_canvasZoomPending;
+  bool panChanged = m_canvasPanPending;
+  m_canvasZoomPending = false;
+  m_canvasPanPending = false;
+
+  m_canvasWriteCount += persistCanvasState(
+    zoomChanged, m_pendingCanvasZoom,
+    panChanged, m_pendingCanvasPan
+    );
+}
+
+unsigned int Controller::persistCanvasState(
+  bool zoomChanged,
+  float zoom,
+  bool panChanged,
+  QPointF pan
+  )
+{
+  return 0;
+}
+
+void Controller::scheduleCanvasPersist()
+{
+  // restarted by every change, the state is persisted once it settles
+  int delay = 0;
+  if(m_graph)
+    delay = m_graph->config().canvasPersistDelay;
+  m_canvasPersistTimer->start(delay);
+}
+
 bool Controller::frameNodes(const std::vector<Node*> & nodes, float zoom)
 {
   if(!m_graph)
@@ -122,9 +191,7 @@ bool Controller::frameNodes(const std::vector<Node*> & nodes, float zoom)
   if(nodes.size() == 0)
     return false;
 
-  QRectF bounds;
-  for(size_t i=0;i<nodes.size();i++)
-    bounds = bounds.united(nodes[i]->boundingRect().translated(nodes[i]->topLeftGraphPos()));
+  QRectF bounds = m_graph->nodesBounds(nodes);
 
   if(zoom != 0.0f)
     zoomCanvas(zoom);
@@ -144,9 +211,15 @@ bool Controller::frameAndFitNodes(const std::vector<Node*> & nodes)
     return false;
 
   // Get the boudingRect of the nodes
-  QRectF bounds;
-  for(size_t i=0;i<nodes.size();i++)
-    bounds = bounds.united(nodes[i]->boundingRect().translated(nodes[i]->topLeftGraphPos()));
+  return frameAndFitBounds(m_graph->nodesBounds(nodes));
+}
+
+bool Controller::frameAndFitBounds(QRectF bounds)
+{
+  if(!m_graph)
+    return false;
+  if(bounds.isNull())
+    return false;
 
   // Get the boudingRect of DFG panel 
   QRectF boundingRect = m_graph->mainPanel()->boundingRect();
@@ -174,7 +247,10 @@ bool Controller::frameSelectedNodes()
 
 bool Controller::frameAllNodes()
 {
-  return frameAndFitNodes(m_graph->nodes());
+  if(!m_graph || m_graph->spatialIndex().size() == 0)
+    return false;
+  // an empty list yields the bounds of the whole index
+  return frameAndFitBounds(m_graph->nodesBounds(std::vector<Node*>()));
 }
 
 void Controller::collapseNodes(int state, const std::vector<Node*> & nodes) {
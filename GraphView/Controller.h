@@ -5,7 +5,9 @@
 
 #include <QtCore/QString>
 #include <QtCore/QPointF>
+#include <QtCore/QRectF>
 #include <QtCore/QSizeF>
+#include <QtCore/QTimer>
 #include <QtGui/QColor>
 
 #include <Commands/CommandStack.h>
@@ -83,6 +85,9 @@ namespace FabricUI
         bool expanded
         ) = 0;
 
+      // without allowUndo the move is a preview, applied to the items
+      // only.  dragged nodes are moved by the nodes themselves and
+      // committed once, with allowUndo, when the drag ends.
       virtual void gvcDoMoveNodes(
         std::vector<Node *> const &nodes,
         QPointF delta,
@@ -97,11 +102,20 @@ namespace FabricUI
         ) = 0;
 
       virtual bool selectNode(Node * node, bool state);
+      // changes the selection state of several nodes at once, with the
+      // per node signals and a single Graph::selectionChanged
+      virtual bool selectNodes(
+        const std::vector<Node*> & toSelect,
+        const std::vector<Node*> & toDeselect
+        );
       virtual bool clearSelection();
+      // the canvas zoom and pan are applied to the view right away and
+      // persisted once per interaction, see flushCanvasState.
       virtual bool zoomCanvas(float zoom);
       virtual bool panCanvas(QPointF pan);
       virtual bool frameNodes(const std::vector<Node*> & nodes, float zoom = 0.0f);
       virtual bool frameAndFitNodes(const std::vector<Node*> & nodes);
+      virtual bool frameAndFitBounds(QRectF bounds);
       virtual bool frameSelectedNodes();
       virtual bool frameAllNodes();
       virtual bool canConnectTo(
@@ -114,15 +128,50 @@ namespace FabricUI
 
     virtual void collapseNodes(int state, const std::vector<Node*> & nodes);
     virtual void collapseSelectedNodes(int state);
+
+      bool hasPendingCanvasState() const;
+      // the number of zoomCanvas / panCanvas calls and of the values
+      // written by persistCanvasState since the last resetCanvasCounters
+      unsigned int canvasChangeCount() const { return m_canvasChangeCount; }
+      unsigned int canvasWriteCount() const { return m_canvasWriteCount; }
+      void resetCanvasCounters();
     
     public slots:
       virtual void onNodeHeaderButtonTriggered(FabricUI::GraphView::NodeHeaderButton * button);
 
+      // persists the canvas state changed since the last flush.  called
+      // when a mouse pan or zoom ends and once the canvas has been idle
+      // for GraphConfig::canvasPersistDelay, and to be called before the
+      // state is read back, eg. when switching execs or saving.
+      void flushCanvasState();
+
+    protected:
+
+      // writes the changed values of the canvas state and returns how
+      // many were written.  the base controller keeps the state in the
+      // view only.
+      virtual unsigned int persistCanvasState(
+        bool zoomChanged,
+        float zoom,
+        bool panChanged,
+        QPointF pan
+        );
+
     private:
 
+      void scheduleCanvasPersist();
+
       Graph * m_graph;
       unsigned int m_interactionBracket;
       FabricServices::Commands::CompoundCommand * m_compound;
+
+      QTimer * m_canvasPersistTimer;
+      bool m_canvasZoomPending;
+      bool m_canvasPanPending;
+      float m_pendingCanvasZoom;
+      QPointF m_pendingCanvasPan;
+      unsigned int m_canvasChangeCount;
+      unsigned int m_canvasWriteCount;
     };
 
   };
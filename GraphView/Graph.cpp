@@ -1,11 +1,16 @@
 // Copyright 2010-2015 Fabric Software Inc. All rights reserved.
 #include <QtGui/QGraphicsView>
+#include <QtCore/QTimer>
 
 #include <FabricUI/GraphView/BackDropNode.h>
 #include <FabricUI/GraphView/Graph.h>
 #include <FabricUI/GraphView/NodeBubble.h>
 #include <FabricUI/GraphView/Exception.h>
 
+#include <assert.h>
+#include <map>
+#include <set>
+
 using namespace FabricUI::GraphView;
 
 Graph::Graph(
@@ -43,6 +48,14 @@ Graph::Graph(
   m_backdropZValue = 1.0;
   m_connectionZValue = 2.0;
   m_centralOverlay = NULL;
+  m_bulkBuildCount = 0;
+  m_bulkFirstConnection = 0;
+  m_bulkItemIndexMethod = QGraphicsScene::BspTreeIndex;
+  m_selectionCount = 0;
+  m_dirtyConnectionsScheduled = false;
+  m_virtualizationStamp = 0;
+  m_virtualizationScheduled = false;
+  m_pixmapCache.setBudget(m_config.nodePixmapCacheBudget);
 }
 
 void Graph::requestSidePanelInspect(
@@ -77,6 +90,9 @@ void Graph::initialize()
   layout->addItem(m_mainPanel);
   layout->addItem(m_rightPanel);
   setLayout(layout);
+
+  QObject::connect(m_leftPanel, SIGNAL(scrolled()), this, SLOT(onSidePanelScrolled()));
+  QObject::connect(m_rightPanel, SIGNAL(scrolled()), this, SLOT(onSidePanelScrolled()));
 }
 
 const GraphConfig & Graph::config() const
@@ -139,13 +155,9 @@ const SidePanel * Graph::sidePanel(PortType portType) const
 
 Node * Graph::addNode(Node * node, bool quiet)
 {
-  FTL::StrRef key = node->name();
-  if(m_nodeMap.find(key) != m_nodeMap.end())
+  if(!m_nodes.insert(node->name(), node).isValid())
     return NULL;
 
-  m_nodeMap.insert(std::pair<FTL::StrRef, size_t>(key, m_nodes.size()));
-  m_nodes.push_back(node);
-
   double * zValue;
   if(node->isBackDropNode())
     zValue = &m_backdropZValue;
@@ -167,11 +179,16 @@ Node * Graph::addNode(Node * node, bool quiet)
     SLOT(onNodeDoubleClicked(FabricUI::GraphView::Node*, Qt::MouseButton, Qt::KeyboardModifiers))
     );
   QObject::connect(node, SIGNAL(bubbleEditRequested(FabricUI::GraphView::Node*)), this, SLOT(onBubbleEditRequested(FabricUI::GraphView::Node*)));
+  QObject::connect(node, SIGNAL(geometryChanged()), this, SLOT(onNodeGeometryChanged()));
+
+  m_spatialIndex.insert(node);
+  materializeNode(node);
+  markVirtualizationDirty();
 
   if(!quiet)
     emit nodeAdded(node);
 
-  if(m_centralOverlay)
+  if(m_centralOverlay && !m_bulkBuildCount)
   {
     prepareGeometryChange();
     scene()->removeItem(m_centralOverlay);
@@ -204,44 +221,37 @@ BackDropNode *Graph::addBackDropNode(
 bool Graph::removeNode(Node * node, bool quiet)
 {
   FTL::StrRef key = node->name();
-  std::map<FTL::StrRef, size_t>::iterator it = m_nodeMap.find(key);
-  if(it == m_nodeMap.end())
+  if(m_nodes.get(m_nodes.find(key)) != node)
     return false;
 
   controller()->beginInteraction();
 
-  for(int i=m_connections.size()-1;i>=0;i--)
+  // a connection between two pins of the node is only taken from
+  // its source so it is removed once
+  std::vector<Connection *> nodeConnections;
+  for(unsigned int i=0;i<node->pinCount();i++)
   {
-    Connection * con = m_connections[i];
-    bool found = false;
-    for(int j=0;j<2;j++)
+    Pin * pin = node->pin(i);
+    std::vector<Connection *> const &outConnections = pin->outConnections();
+    nodeConnections.insert(nodeConnections.end(), outConnections.begin(), outConnections.end());
+    std::vector<Connection *> const &inConnections = pin->inConnections();
+    for(size_t j=0;j<inConnections.size();j++)
     {
-      ConnectionTarget * target = j == 0 ? con->src() : con->dst();
-      if(target->targetType() == TargetType_Pin)
-      {
-        Pin * pin = (Pin *)target;
-        if(pin->node() == node)
-        {
-          found = true;
-          break;
-        }
-      }
+      ConnectionTarget * src = inConnections[j]->src();
+      if(src->targetType() == TargetType_Pin && ((Pin *)src)->node() == node)
+        continue;
+      nodeConnections.push_back(inConnections[j]);
     }
-
-    if(found)
-      controller()->gvcDoRemoveConnection(con);
   }
+  for(size_t i=0;i<nodeConnections.size();i++)
+    controller()->gvcDoRemoveConnection(nodeConnections[i]);
 
-  size_t index = it->second;
-  m_nodes.erase(m_nodes.begin() + index);
-  m_nodeMap.erase(it);
-
-  // update the lookup
-  for(it = m_nodeMap.begin(); it != m_nodeMap.end(); it++)
-  {
-    if(it->second > index)
-      it->second--;
-  }
+  m_nodes.erase(key);
+  m_spatialIndex.remove(node);
+  if(node->m_selectionIndex >= 0)
+    eraseSelection(node);
+  if(node->m_materializedIndex >= 0)
+    virtualizeNode(node);
 
   if(!quiet)
     emit nodeRemoved(node);
@@ -262,39 +272,175 @@ bool Graph::removeNode(Node * node, bool quiet)
 std::vector<Node *> Graph::nodes() const
 {
   std::vector<Node *> result;
-  result.insert(result.end(), m_nodes.begin(), m_nodes.end());
+  result.reserve(m_nodes.size());
+  for(NodeRegistry::const_iterator it=m_nodes.begin();it!=m_nodes.end();++it)
+    result.push_back(*it);
   return result;
 }
 
 Node * Graph::node( FTL::StrRef name ) const
 {
-  std::map<FTL::StrRef, size_t>::const_iterator it = m_nodeMap.find(name);
-  if(it == m_nodeMap.end())
-    return NULL;
-  return m_nodes[it->second];
+  return m_nodes.get(m_nodes.find(name));
 }
 
 std::vector<Node *> Graph::selectedNodes() const
 {
   std::vector<Node *> result;
-  for(size_t i=0;i<m_nodes.size();i++)
+  result.reserve(m_selectionCount);
+  for(size_t i=0;i<m_selection.size();i++)
   {
-    if(m_nodes[i]->selected())
-      result.push_back(m_nodes[i]);
+    if(m_selection[i])
+      result.push_back(m_selection[i]);
   }
   return result;
 }
 
 void Graph::selectAllNodes()
 {
-  for (size_t i=0;i<m_nodes.size();i++)
-    m_nodes[i]->setSelected( true );
+  setSelection(nodes());
+}
+
+void Graph::clearSelection()
+{
+  setSelection(std::vector<Node *>());
+}
+
+bool Graph::setSelection(const std::vector<Node *> & nodes)
+{
+  std::set<Node *> keep(nodes.begin(), nodes.end());
+  std::vector<Node *> toDeselect;
+  for(size_t i=0;i<m_selection.size();i++)
+  {
+    if(m_selection[i] && keep.find(m_selection[i]) == keep.end())
+      toDeselect.push_back(m_selection[i]);
+  }
+  return updateSelection(nodes, toDeselect);
+}
+
+void Graph::insertSelection(Node * node)
+{
+  node->m_selectionIndex = int(m_selection.size());
+  m_selection.push_back(node);
+  m_selectionCount++;
+}
+
+void Graph::eraseSelection(Node * node)
+{
+  m_selection[node->m_selectionIndex] = NULL;
+  node->m_selectionIndex = -1;
+  m_selectionCount--;
+
+  if(m_selectionCount == 0)
+  {
+    m_selection.clear();
+    return;
+  }
+  if(m_selectionCount * 2 >= m_selection.size())
+    return;
+
+  size_t count = 0;
+  for(size_t i=0;i<m_selection.size();i++)
+  {
+    Node * selected = m_selection[i];
+    if(!selected)
+      continue;
+    selected->m_selectionIndex = int(count);
+    m_selection[count++] = selected;
+  }
+  m_selection.resize(count);
+}
+
+bool Graph::updateSelection(
+  const std::vector<Node *> & toSelect,
+  const std::vector<Node *> & toDeselect
+  )
+{
+  std::vector<Node *> changed;
+  for(size_t i=0;i<toDeselect.size();i++)
+  {
+    if(!toDeselect[i]->selected())
+      continue;
+    toDeselect[i]->setSelected(false, true);
+    changed.push_back(toDeselect[i]);
+  }
+  for(size_t i=0;i<toSelect.size();i++)
+  {
+    if(toSelect[i]->selected())
+      continue;
+    toSelect[i]->setSelected(true, true);
+    changed.push_back(toSelect[i]);
+  }
+  if(changed.size() == 0)
+    return false;
+
+  // a connection between two changed nodes is restyled once
+  std::set<Connection *> connections;
+  for(size_t i=0;i<changed.size();i++)
+  {
+    Node * node = changed[i];
+    for(unsigned int j=0;j<node->pinCount();j++)
+    {
+      Pin * pin = node->pin(j);
+      connections.insert(pin->inConnections().begin(), pin->inConnections().end());
+      connections.insert(pin->outConnections().begin(), pin->outConnections().end());
+    }
+  }
+  for(std::set<Connection *>::iterator it=connections.begin();it!=connections.end();++it)
+    (*it)->dependencySelected();
+
+  // the per node signals of Node::setSelected go out once the whole
+  // selection is in place, followed by the aggregate one
+  for(size_t i=0;i<changed.size();i++)
+  {
+    Node * node = changed[i];
+    emit node->selectionChanged(node, node->selected());
+    if(node->selected())
+      emit nodeSelected(node);
+    else
+      emit nodeDeselected(node);
+  }
+  emit selectionChanged();
+  return true;
+}
+
+std::vector<Node *> Graph::nodesIntersecting(QRectF rect)
+{
+  std::vector<Node *> result;
+  m_spatialIndex.intersecting(rect, result);
+  return result;
+}
+
+std::vector<Node *> Graph::nodesContainedIn(QRectF rect)
+{
+  std::vector<Node *> result;
+  m_spatialIndex.contained(rect, result);
+  return result;
 }
 
-void Graph::clearSelection() const
+Node * Graph::nodeAt(QPointF pos)
 {
-  for (size_t i=0;i<m_nodes.size();i++)
-    m_nodes[i]->setSelected( false );
+  std::vector<Node *> hits;
+  m_spatialIndex.at(pos, hits);
+
+  Node * result = NULL;
+  for(size_t i=0;i<hits.size();i++)
+  {
+    if(result && hits[i]->zValue() < result->zValue())
+      continue;
+    result = hits[i];
+  }
+  return result;
+}
+
+QRectF Graph::nodesBounds(const std::vector<Node *> & nodes)
+{
+  if(nodes.size() == 0)
+    return m_spatialIndex.bounds();
+
+  QRectF bounds;
+  for(size_t i=0;i<nodes.size();i++)
+    bounds = bounds.united(m_spatialIndex.bounds(nodes[i]));
+  return bounds;
 }
 
 bool Graph::addPort(Port * port, bool quiet)
@@ -325,18 +471,9 @@ Port * Graph::port(FTL::StrRef name) const
   if(!hasSidePanels())
     return NULL;
 
-  for(unsigned int i=0;i<m_leftPanel->portCount();i++)
-  {
-    if(name == m_leftPanel->port(i)->name())
-      return m_leftPanel->port(i);
-  }
-  for(unsigned int i=0;i<m_rightPanel->portCount();i++)
-  {
-    if(name == m_rightPanel->port(i)->name())
-      return m_rightPanel->port(i);
-  }
-
-  return NULL;
+  if(Port * port = m_leftPanel->port(name))
+    return port;
+  return m_rightPanel->port(name);
 }
 
 std::vector<Port *> Graph::ports(FTL::StrRef name) const
@@ -345,16 +482,11 @@ std::vector<Port *> Graph::ports(FTL::StrRef name) const
   if(!hasSidePanels())
     return result;
 
-  for(unsigned int i=0;i<m_leftPanel->portCount();i++)
-  {
-    if(name == m_leftPanel->port(i)->name())
-      result.push_back(m_leftPanel->port(i));
-  }
-  for(unsigned int i=0;i<m_rightPanel->portCount();i++)
-  {
-    if(name == m_rightPanel->port(i)->name())
-      result.push_back(m_rightPanel->port(i));
-  }
+  // an exec port shows up in each panel it belongs to
+  if(Port * port = m_leftPanel->port(name))
+    result.push_back(port);
+  if(Port * port = m_rightPanel->port(name))
+    result.push_back(port);
 
   return result;
 }
@@ -366,12 +498,7 @@ std::vector<Connection *> Graph::connections() const
 
 bool Graph::isConnected(const ConnectionTarget * target) const
 {
-  for(size_t i=0;i<m_connections.size();i++)
-  {
-    if(m_connections[i]->dst() == target || m_connections[i]->src() == target)
-      return true;
-  }
-  return false;
+  return target->isConnected();
 }
 
 void Graph::updateColorForConnections(const ConnectionTarget * target) const
@@ -381,12 +508,14 @@ void Graph::updateColorForConnections(const ConnectionTarget * target) const
   if(target == NULL)
     return;
 
-  for(size_t i=0;i<m_connections.size();i++)
+  for(int j=0;j<2;j++)
   {
-    if(m_connections[i]->dst() == target || m_connections[i]->src() == target)
+    std::vector<Connection *> const &connections =
+      j == 0 ? target->inConnections() : target->outConnections();
+    for(size_t i=0;i<connections.size();i++)
     {
-      m_connections[i]->setColor(target->color());
-      m_connections[i]->update();
+      connections[i]->setColor(target->color());
+      connections[i]->update();
     }
   }
 }
@@ -399,30 +528,33 @@ Connection * Graph::addConnection(ConnectionTarget * src, ConnectionTarget * dst
   if(src->targetType() == TargetType_MouseGrabber || dst->targetType() == TargetType_MouseGrabber)
     return NULL;
 
+  // a bulk build replays connections that are known to be consistent
+  if(m_bulkBuildCount)
+    return addBulkConnection(src, dst, quiet);
+
   // make sure this connection does not exist yet
-  for(size_t i=0;i<m_connections.size();i++)
+  std::vector<Connection *> const &srcConnections = src->outConnections();
+  for(size_t i=0;i<srcConnections.size();i++)
   {
-    if(m_connections[i]->src() == src && m_connections[i]->dst() == dst)
+    if(srcConnections[i]->dst() == dst)
       return NULL;
   }
 
   if(m_config.disconnectInputsAutomatically)
   {
-    for(size_t i=0;i<m_connections.size();i++)
+    std::vector<Connection *> const &dstConnections = dst->inConnections();
+    for(size_t i=0;i<dstConnections.size();i++)
     {
-      if(m_connections[i]->dst() == dst)
+      // filter out IO ports
+      if(dstConnections[i]->src()->targetType() == TargetType_Port && dstConnections[i]->dst()->targetType() == TargetType_Port)
       {
-        // filter out IO ports
-        if(m_connections[i]->src()->targetType() == TargetType_Port && m_connections[i]->dst()->targetType() == TargetType_Port)
-        {
-          if(((Port*)m_connections[i]->src())->name() == ((Port*)m_connections[i]->dst())->name())
-            continue;
-        }
-
-        if(!controller()->gvcDoRemoveConnection(m_connections[i]))
-          return NULL;
-        break;
+        if(((Port*)dstConnections[i]->src())->name() == ((Port*)dstConnections[i]->dst())->name())
+          continue;
       }
+
+      if(!controller()->gvcDoRemoveConnection(dstConnections[i]))
+        return NULL;
+      break;
     }
   }
 
@@ -430,7 +562,7 @@ Connection * Graph::addConnection(ConnectionTarget * src, ConnectionTarget * dst
   controller()->beginInteraction();
 
   Connection * connection = new Connection(this, src, dst);
-  m_connections.push_back(connection);
+  insertConnection(connection);
 
   if(connection->src()->targetType() == TargetType_Pin)
   {
@@ -456,32 +588,167 @@ Connection * Graph::addConnection(ConnectionTarget * src, ConnectionTarget * dst
   return connection;
 }
 
-bool Graph::removeConnection(ConnectionTarget * src, ConnectionTarget * dst, bool quiet)
+Connection * Graph::addBulkConnection(ConnectionTarget * src, ConnectionTarget * dst, bool quiet)
 {
-  for(size_t i=0;i<m_connections.size();i++)
+  Connection * connection = new Connection(this, src, dst);
+  insertConnection(connection);
+
+  if(connection->src()->targetType() == TargetType_Pin)
+    ((Pin*)connection->src())->setDaisyChainCircleVisible(true);
+
+  connection->setZValue(m_connectionZValue);
+  m_connectionZValue += 0.0001;
+
+  if(!quiet)
+    emit connectionAdded(connection);
+
+  return connection;
+}
+
+void Graph::beginBulkBuild(
+  size_t nodeCountHint,
+  size_t connectionCountHint
+  )
+{
+  if(m_bulkBuildCount++ > 0)
+    return;
+
+  m_nodes.reserve(m_nodes.size() + nodeCountHint);
+  m_connections.reserve(m_connections.size() + connectionCountHint);
+  m_bulkFirstConnection = m_connections.size();
+
+  // the index is rebuilt once when the build ends instead of
+  // being updated for every item that gets added
+  if(scene())
+  {
+    m_bulkItemIndexMethod = scene()->itemIndexMethod();
+    scene()->setItemIndexMethod(QGraphicsScene::NoIndex);
+  }
+
+  if(controller())
+    controller()->beginInteraction();
+}
+
+void Graph::endBulkBuild()
+{
+  assert(m_bulkBuildCount > 0);
+  if(--m_bulkBuildCount > 0)
+    return;
+
+  prepareGeometryChange();
+
+  std::set<Node *> connectedNodes;
+  for(size_t i=m_bulkFirstConnection;i<m_connections.size();i++)
   {
-    if(m_connections[i]->src() == src && m_connections[i]->dst() == dst)
+    Connection * connection = m_connections[i];
+    connection->dependencyMoved();
+
+    for(int j=0;j<2;j++)
     {
-      return removeConnection(m_connections[i], quiet);
+      ConnectionTarget * target = j == 0 ? connection->src() : connection->dst();
+      if(target->targetType() == TargetType_Pin)
+        connectedNodes.insert(((Pin*)target)->node());
     }
   }
-  return false;
+  m_bulkFirstConnection = 0;
+
+  for(std::set<Node *>::iterator it = connectedNodes.begin(); it != connectedNodes.end(); it++)
+    (*it)->onConnectionsChanged();
+
+  if(m_centralOverlay && m_nodes.size() > 0)
+  {
+    scene()->removeItem(m_centralOverlay);
+    delete(m_centralOverlay);
+    m_centralOverlay = NULL;
+  }
+
+  if(scene())
+    scene()->setItemIndexMethod(m_bulkItemIndexMethod);
+
+  if(controller())
+    controller()->endInteraction();
 }
 
-bool Graph::removeConnection(Connection * connection, bool quiet)
+void Graph::insertConnection(Connection * connection)
+{
+  connection->m_graphIndex = m_connections.size();
+  m_connections.push_back(connection);
+
+  std::vector<Connection *> &srcConnections = connection->src()->m_outConnections;
+  connection->m_srcIndex = srcConnections.size();
+  srcConnections.push_back(connection);
+
+  std::vector<Connection *> &dstConnections = connection->dst()->m_inConnections;
+  connection->m_dstIndex = dstConnections.size();
+  dstConnections.push_back(connection);
+
+  markVirtualizationCandidate(connection);
+  markVirtualizationDirty();
+}
+
+void Graph::eraseConnection(Connection * connection)
+{
+  // swap with the last entry and pop, patching the moved entry's index
+  if(connection->m_pathDirty
+    && connection->m_dirtyIndex < m_dirtyConnections.size()
+    && m_dirtyConnections[connection->m_dirtyIndex] == connection)
+  {
+    Connection * lastDirty = m_dirtyConnections.back();
+    m_dirtyConnections[connection->m_dirtyIndex] = lastDirty;
+    lastDirty->m_dirtyIndex = connection->m_dirtyIndex;
+    m_dirtyConnections.pop_back();
+  }
+  connection->m_pathDirty = false;
+
+  if(connection->m_virtualizationCandidate
+    && connection->m_candidateIndex < m_virtualizationCandidates.size()
+    && m_virtualizationCandidates[connection->m_candidateIndex] == connection)
+  {
+    Connection * lastCandidate = m_virtualizationCandidates.back();
+    m_virtualizationCandidates[connection->m_candidateIndex] = lastCandidate;
+    lastCandidate->m_candidateIndex = connection->m_candidateIndex;
+    m_virtualizationCandidates.pop_back();
+  }
+  connection->m_virtualizationCandidate = false;
+  if(connection->m_detachedIndex >= 0)
+    eraseDetachedConnection(connection);
+
+  Connection * last = m_connections.back();
+  m_connections[connection->m_graphIndex] = last;
+  last->m_graphIndex = connection->m_graphIndex;
+  m_connections.pop_back();
+
+  std::vector<Connection *> &srcConnections = connection->src()->m_outConnections;
+  last = srcConnections.back();
+  srcConnections[connection->m_srcIndex] = last;
+  last->m_srcIndex = connection->m_srcIndex;
+  srcConnections.pop_back();
+
+  std::vector<Connection *> &dstConnections = connection->dst()->m_inConnections;
+  last = dstConnections.back();
+  dstConnections[connection->m_dstIndex] = last;
+  last->m_dstIndex = connection->m_dstIndex;
+  dstConnections.pop_back();
+}
+
+bool Graph::removeConnection(ConnectionTarget * src, ConnectionTarget * dst, bool quiet)
 {
-  bool found = false;
-  size_t index;
-  for(size_t i=0;i<m_connections.size();i++)
+  std::vector<Connection *> const &srcConnections = src->outConnections();
+  for(size_t i=0;i<srcConnections.size();i++)
   {
-    if(m_connections[i] == connection)
+    if(srcConnections[i]->dst() == dst)
     {
-      found = true;
-      index = i;
-      break;
+      return removeConnection(srcConnections[i], quiet);
     }
   }
-  if(!found)
+  return false;
+}
+
+bool Graph::removeConnection(Connection * connection, bool quiet)
+{
+  if(connection->m_graph != this
+    || connection->m_graphIndex >= m_connections.size()
+    || m_connections[connection->m_graphIndex] != connection)
     return false;
 
   prepareGeometryChange();
@@ -502,23 +769,12 @@ bool Graph::removeConnection(Connection * connection, bool quiet)
     node->onConnectionsChanged();
   }
 
-  m_connections.erase(m_connections.begin() + index);
+  eraseConnection(connection);
   if(!quiet)
     emit connectionRemoved(connection);
 
   if(daisyChainPin)
-  {
-    bool found = false;
-    for(size_t i=0;i<m_connections.size();i++)
-    {
-      if(m_connections[i]->src() == daisyChainPin)
-      {
-        found = true;
-        break;
-      }
-    }
-    daisyChainPin->setDaisyChainCircleVisible(found);
-  }
+    daisyChainPin->setDaisyChainCircleVisible(!daisyChainPin->outConnections().empty());
 
   prepareGeometryChange();
   connection->invalidate();
@@ -684,6 +940,327 @@ void Graph::onBubbleEditRequested(FabricUI::GraphView::Node * node)
   emit bubbleEditRequested(node);
 }
 
+void Graph::onNodeGeometryChanged()
+{
+  Node * node = qobject_cast<Node *>(sender());
+  if(node)
+  {
+    m_spatialIndex.markDirty(node);
+    markConnectionsDirty(node);
+    markVirtualizationDirty(node);
+  }
+}
+
+void Graph::onSidePanelScrolled()
+{
+  SidePanel * sidePanel = qobject_cast<SidePanel *>(sender());
+  if(sidePanel)
+    markSidePanelConnectionsDirty(sidePanel);
+}
+
+void Graph::markConnectionDirty(Connection * connection)
+{
+  if(connection->m_pathDirty)
+    return;
+  connection->m_pathDirty = true;
+  connection->m_dirtyIndex = m_dirtyConnections.size();
+  m_dirtyConnections.push_back(connection);
+
+  if(!m_dirtyConnectionsScheduled)
+  {
+    m_dirtyConnectionsScheduled = true;
+    QTimer::singleShot(0, this, SLOT(updateDirtyConnections()));
+  }
+}
+
+void Graph::markConnectionsDirty(ConnectionTarget * target)
+{
+  std::vector<Connection *> const &inConnections = target->inConnections();
+  for(size_t i=0;i<inConnections.size();i++)
+    markConnectionDirty(inConnections[i]);
+  std::vector<Connection *> const &outConnections = target->outConnections();
+  for(size_t i=0;i<outConnections.size();i++)
+    markConnectionDirty(outConnections[i]);
+}
+
+void Graph::markConnectionsDirty(Node * node)
+{
+  for(unsigned int i=0;i<node->pinCount();i++)
+    markConnectionsDirty(node->pin(i));
+}
+
+void Graph::markSidePanelConnectionsDirty(SidePanel * sidePanel)
+{
+  if(!sidePanel)
+  {
+    if(m_leftPanel)
+      markSidePanelConnectionsDirty(m_leftPanel);
+    if(m_rightPanel)
+      markSidePanelConnectionsDirty(m_rightPanel);
+    return;
+  }
+
+  for(unsigned int i=0;i<sidePanel->portCount();i++)
+    markConnectionsDirty(sidePanel->port(i));
+  if(sidePanel->m_proxyPort)
+    markConnectionsDirty(sidePanel->m_proxyPort);
+}
+
+void Graph::updateConnectionsSelection(Node * node)
+{
+  for(unsigned int i=0;i<node->pinCount();i++)
+  {
+    Pin * pin = node->pin(i);
+    std::vector<Connection *> const &inConnections = pin->inConnections();
+    for(size_t j=0;j<inConnections.size();j++)
+      inConnections[j]->dependencySelected();
+    std::vector<Connection *> const &outConnections = pin->outConnections();
+    for(size_t j=0;j<outConnections.size();j++)
+      outConnections[j]->dependencySelected();
+  }
+}
+
+void Graph::updateDirtyConnections()
+{
+  m_dirtyConnectionsScheduled = false;
+  if(m_dirtyConnections.size() == 0)
+    return;
+
+  std::vector<Connection *> dirtyConnections;
+  dirtyConnections.swap(m_dirtyConnections);
+
+  // end points shared by several connections (eg. an output pin fanning
+  // out) are only mapped into graph space once
+  QGraphicsWidget * group = itemGroup();
+  std::map<ConnectionTarget *, QPointF> srcPoints;
+  std::map<ConnectionTarget *, QPointF> dstPoints;
+  for(size_t i=0;i<dirtyConnections.size();i++)
+  {
+    Connection * connection = dirtyConnections[i];
+    connection->m_pathDirty = false;
+    // rebuilt when the connection comes back on screen
+    if(connection->m_aboutToBeDeleted || connection->m_virtualized)
+      continue;
+
+    std::map<ConnectionTarget *, QPointF>::iterator srcIt = srcPoints.find(connection->src());
+    if(srcIt == srcPoints.end())
+    {
+      QPointF pos = group->mapFromScene(connection->src()->connectionPos(PortType_Output));
+      srcIt = srcPoints.insert(std::make_pair(connection->src(), pos)).first;
+    }
+    std::map<ConnectionTarget *, QPointF>::iterator dstIt = dstPoints.find(connection->dst());
+    if(dstIt == dstPoints.end())
+    {
+      QPointF pos = group->mapFromScene(connection->dst()->connectionPos(PortType_Input));
+      dstIt = dstPoints.insert(std::make_pair(connection->dst(), pos)).first;
+    }
+    connection->updatePath(srcIt->second, dstIt->second);
+  }
+}
+
+void Graph::markVirtualizationDirty(Node * movedNode)
+{
+  // the connections of a shown node are shown whatever its position
+  if(movedNode && movedNode->m_virtualized)
+    markVirtualizationCandidates(movedNode);
+  if(m_virtualizationScheduled)
+    return;
+  m_virtualizationScheduled = true;
+  QTimer::singleShot(0, this, SLOT(updateVirtualization()));
+}
+
+static Node * VirtualizationNode(ConnectionTarget * target)
+{
+  if(target->targetType() == TargetType_Pin)
+    return ((Pin *)target)->node();
+  if(target->targetType() == TargetType_NodeHeader)
+    return ((NodeHeader *)target)->node();
+  return NULL;
+}
+
+void Graph::updateVirtualization()
+{
+  m_virtualizationScheduled = false;
+  if(!m_mainPanel)
+    return;
+
+  if(!m_config.virtualizationEnabled)
+  {
+    if(m_materializedNodes.size() < m_nodes.size())
+    {
+      for(NodeRegistry::const_iterator it=m_nodes.begin();it!=m_nodes.end();++it)
+      {
+        if((*it)->m_virtualized)
+          materializeNode(*it);
+      }
+    }
+    // only detached connections are ever virtualized
+    while(m_detachedConnections.size() > 0)
+    {
+      Connection * connection = m_detachedConnections.back();
+      eraseDetachedConnection(connection);
+      setConnectionVirtualized(connection, false);
+    }
+    for(size_t i=0;i<m_virtualizationCandidates.size();i++)
+      m_virtualizationCandidates[i]->m_virtualizationCandidate = false;
+    m_virtualizationCandidates.clear();
+    m_virtualizationViewRect = QRectF();
+    return;
+  }
+
+  // the panel has not been laid out yet
+  QRectF panelRect = m_mainPanel->rect();
+  if(panelRect.isEmpty())
+    return;
+
+  float margin = m_config.virtualizationMargin;
+  QRectF viewRect = itemGroup()->mapRectFromParent(
+    panelRect.adjusted(-margin, -margin, margin, margin)
+    );
+
+  m_virtualizationStamp++;
+  std::vector<Node *> visibleNodes = nodesIntersecting(viewRect);
+  for(size_t i=0;i<visibleNodes.size();i++)
+  {
+    Node * node = visibleNodes[i];
+    node->m_virtualizationStamp = m_virtualizationStamp;
+    if(node->m_virtualized)
+    {
+      materializeNode(node);
+      markVirtualizationCandidates(node);
+    }
+  }
+
+  // walk backwards, virtualizing swaps the last node into the slot
+  for(size_t i=m_materializedNodes.size();i>0;i--)
+  {
+    Node * node = m_materializedNodes[i-1];
+    if(node->m_virtualizationStamp != m_virtualizationStamp)
+    {
+      virtualizeNode(node);
+      markVirtualizationCandidates(node);
+    }
+  }
+
+  // the other connections only change along with their nodes
+  if(viewRect != m_virtualizationViewRect)
+  {
+    m_virtualizationViewRect = viewRect;
+    for(size_t i=0;i<m_detachedConnections.size();i++)
+      markVirtualizationCandidate(m_detachedConnections[i]);
+  }
+
+  std::vector<Connection *> candidates;
+  candidates.swap(m_virtualizationCandidates);
+  for(size_t i=0;i<candidates.size();i++)
+  {
+    candidates[i]->m_virtualizationCandidate = false;
+    updateConnectionVirtualization(candidates[i], viewRect);
+  }
+}
+
+void Graph::markVirtualizationCandidate(Connection * connection)
+{
+  if(connection->m_virtualizationCandidate)
+    return;
+  connection->m_virtualizationCandidate = true;
+  connection->m_candidateIndex = m_virtualizationCandidates.size();
+  m_virtualizationCandidates.push_back(connection);
+}
+
+void Graph::markVirtualizationCandidates(ConnectionTarget * target)
+{
+  std::vector<Connection *> const &inConnections = target->inConnections();
+  for(size_t i=0;i<inConnections.size();i++)
+    markVirtualizationCandidate(inConnections[i]);
+  std::vector<Connection *> const &outConnections = target->outConnections();
+  for(size_t i=0;i<outConnections.size();i++)
+    markVirtualizationCandidate(outConnections[i]);
+}
+
+void Graph::markVirtualizationCandidates(Node * node)
+{
+  for(unsigned int i=0;i<node->pinCount();i++)
+    markVirtualizationCandidates(node->pin(i));
+  if(node->header())
+    markVirtualizationCandidates(node->header());
+}
+
+void Graph::updateConnectionVirtualization(Connection * connection, QRectF const & viewRect)
+{
+  // a connection is a cheap segment between the bounds of its nodes
+  // while both of them are virtualized.  connections to the side panels
+  // are always shown.
+  Node * srcNode = VirtualizationNode(connection->src());
+  Node * dstNode = VirtualizationNode(connection->dst());
+  bool detached = srcNode && dstNode
+    && srcNode->m_virtualized && dstNode->m_virtualized;
+  if(detached && connection->m_detachedIndex < 0)
+    insertDetachedConnection(connection);
+  else if(!detached && connection->m_detachedIndex >= 0)
+    eraseDetachedConnection(connection);
+
+  bool virtualized = detached;
+  if(virtualized)
+  {
+    QRectF segment = m_spatialIndex.bounds(srcNode).united(m_spatialIndex.bounds(dstNode));
+    float tangent = m_config.connectionFixedTangentLength
+      + m_config.connectionPercentualTangentLength * 0.01f * segment.width();
+    segment.adjust(-tangent, 0, tangent, 0);
+    virtualized = !segment.intersects(viewRect);
+  }
+  setConnectionVirtualized(connection, virtualized);
+}
+
+void Graph::insertDetachedConnection(Connection * connection)
+{
+  connection->m_detachedIndex = int(m_detachedConnections.size());
+  m_detachedConnections.push_back(connection);
+}
+
+void Graph::eraseDetachedConnection(Connection * connection)
+{
+  // swap with the last entry and pop, patching the moved entry's index
+  Connection * last = m_detachedConnections.back();
+  m_detachedConnections[connection->m_detachedIndex] = last;
+  last->m_detachedIndex = connection->m_detachedIndex;
+  m_detachedConnections.pop_back();
+  connection->m_detachedIndex = -1;
+}
+
+void Graph::materializeNode(Node * node)
+{
+  node->m_virtualized = false;
+  node->m_materializedIndex = int(m_materializedNodes.size());
+  m_materializedNodes.push_back(node);
+  node->setVisible(true);
+}
+
+void Graph::virtualizeNode(Node * node)
+{
+  // swap with the last entry and pop, patching the moved entry's index
+  Node * last = m_materializedNodes.back();
+  m_materializedNodes[node->m_materializedIndex] = last;
+  last->m_materializedIndex = node->m_materializedIndex;
+  m_materializedNodes.pop_back();
+
+  node->m_virtualized = true;
+  node->m_materializedIndex = -1;
+  node->setVisible(false);
+  // give the node's pixmaps back to the cache budget
+  node->markCacheDirty(CachingEffect::Dirty_All);
+}
+
+void Graph::setConnectionVirtualized(Connection * connection, bool state)
+{
+  if(connection->m_virtualized == state)
+    return;
+  connection->m_virtualized = state;
+  connection->setVisible(!state);
+  if(!state)
+    markConnectionDirty(connection);
+}
+
 void Graph::setGraphContextMenuCallback(Graph::GraphContextMenuCallback callback, void * userData)
 {
   m_graphContextMenuCallback = callback;
@@ -769,19 +1346,8 @@ void Graph::paint(QPainter * painter, const QStyleOptionGraphicsItem * option, Q
 
 Node *Graph::renameNode( FTL::StrRef oldName, FTL::StrRef newName )
 {
-  std::map<FTL::StrRef, size_t>::iterator it = m_nodeMap.find( oldName );
-  if ( it != m_nodeMap.end() )
-  {
-    size_t index = it->second;
-    Node *node = m_nodes[index];
-    m_nodeMap.erase( it );
+  Node *node = m_nodes.rename( oldName, newName );
+  if ( node )
     node->m_name = newName;
-    m_nodeMap.insert(
-      std::pair<FTL::StrRef, size_t>(
-        node->m_name, index
-        )
-      );
-    return node;
-  }
-  else return 0;
+  return node;
 }
@@ -20,6 +20,9 @@
 #include <FabricUI/GraphView/MainPanel.h>
 #include <FabricUI/GraphView/SidePanel.h>
 #include <FabricUI/GraphView/InfoOverlay.h>
+#include <FabricUI/GraphView/NodeRegistry.h>
+#include <FabricUI/GraphView/NodeSpatialIndex.h>
+#include <FabricUI/GraphView/NodePixmapCache.h>
 
 #if QT_VERSION > 0x040602
 # define DFG_QT_MIDDLE_MOUSE Qt::MiddleButton
@@ -79,9 +82,34 @@ namespace FabricUI
         { return node( path ); }
       Node *renameNode( FTL::StrRef oldName, FTL::StrRef newName );
 
+      // spatial queries, rects and positions are in graph coordinates
+      NodeSpatialIndex & spatialIndex() { return m_spatialIndex; }
+      NodePixmapCache & pixmapCache() { return m_pixmapCache; }
+      virtual std::vector<Node *> nodesIntersecting(QRectF rect);
+      virtual std::vector<Node *> nodesContainedIn(QRectF rect);
+      // the top most node under pos, or NULL
+      virtual Node * nodeAt(QPointF pos);
+      // the united bounds of the nodes, all of them if nodes is empty
+      virtual QRectF nodesBounds(const std::vector<Node *> & nodes);
+
+      // the selected nodes, in the order they got selected
       virtual std::vector<Node *> selectedNodes() const;
+      size_t selectedNodeCount() const { return m_selectionCount; }
+      // these go through updateSelection, so nodeSelected / nodeDeselected
+      // still fire per node that changed
       virtual void selectAllNodes();
-      void clearSelection() const;
+      void clearSelection();
+      // replaces the selection, emitting the per node signals and a single
+      // selectionChanged.  returns false if the selection did not change.
+      bool setSelection(const std::vector<Node *> & nodes);
+      // selects and deselects the nodes, restyles the connections attached
+      // to them once, then emits Node::selectionChanged and nodeSelected /
+      // nodeDeselected per changed node and a single selectionChanged.
+      // returns false if no node changed.
+      bool updateSelection(
+        const std::vector<Node *> & toSelect,
+        const std::vector<Node *> & toDeselect
+        );
 
       // ports
       virtual std::vector<Port *> ports() const;
@@ -93,6 +121,35 @@ namespace FabricUI
       virtual bool isConnected(const ConnectionTarget * target) const;
       virtual void updateColorForConnections(const ConnectionTarget * target) const;
 
+      // connection paths are rebuilt once per event loop pass, for the
+      // connections whose end points moved since the previous pass
+      void markConnectionDirty(Connection * connection);
+      void markConnectionsDirty(ConnectionTarget * target);
+      void markConnectionsDirty(Node * node);
+      // the connections ending on the side panels, which move relative
+      // to the canvas when it is panned, zoomed or resized
+      void markSidePanelConnectionsDirty(SidePanel * sidePanel = NULL);
+      // restyles the connections of a node whose selection changed
+      void updateConnectionsSelection(Node * node);
+
+      // virtualization: nodes outside of the main panel (plus
+      // GraphConfig::virtualizationMargin) are hidden, so the scene neither
+      // paints nor hit tests them, and their cached pixmaps are released.
+      // connections between two hidden nodes are hidden as well, unless
+      // the segment between the nodes crosses the view.  the nodes and
+      // connections themselves stay alive, so the model API is unchanged.
+      // hidden items also stay in the scene and its BSP index and keep their
+      // memory: virtualization saves painting, path building and pixmap
+      // cache budget, not scene size.
+      // the visible set is recomputed once per event loop pass after the
+      // canvas or a node moved, looking only at the nodes found in the
+      // spatial index and the connections of nodes that changed state,
+      // plus the connections between two hidden nodes when the view moved.
+      // pass a node that moved or got resized, so its connections are
+      // tested again while it is hidden
+      void markVirtualizationDirty(Node * movedNode = NULL);
+      size_t materializedNodeCount() const { return m_materializedNodes.size(); }
+
       // hotkeys
       virtual void defineHotkey(Qt::Key key, Qt::KeyboardModifier modifiers, QString name);
 
@@ -134,6 +191,43 @@ namespace FabricUI
       virtual bool removeConnection(Connection * connection, bool quiet = false);
       virtual void resetMouseGrabber();
 
+      // bulk construction, used when a whole exec is (re)built.  While
+      // building, scene indexing is suspended and per connection work
+      // (duplicate checks, paths, pin layouts) is deferred until the
+      // outermost endBulkBuild, which performs it once for all items.
+      void beginBulkBuild(
+        size_t nodeCountHint = 0,
+        size_t connectionCountHint = 0
+        );
+      void endBulkBuild();
+      bool isBulkBuilding() const { return m_bulkBuildCount > 0; }
+
+      class BulkBuildBracket
+      {
+      public:
+
+        BulkBuildBracket(
+          Graph *graph,
+          size_t nodeCountHint = 0,
+          size_t connectionCountHint = 0
+          )
+          : m_graph( graph )
+        {
+          if ( m_graph )
+            m_graph->beginBulkBuild( nodeCountHint, connectionCountHint );
+        }
+
+        ~BulkBuildBracket()
+        {
+          if ( m_graph )
+            m_graph->endBulkBuild();
+        }
+
+      private:
+
+        Graph *m_graph;
+      };
+
       void updateOverlays(float width, float height);
       void setupBackgroundOverlay(QPointF pos, QString filePath);
       void setCentralOverlayText(QString text);
@@ -147,6 +241,13 @@ namespace FabricUI
         FabricUI::GraphView::SidePanel *sidePanel
         );
       void onBubbleEditRequested(FabricUI::GraphView::Node * node);
+      void updateDirtyConnections();
+      void updateVirtualization();
+
+    private slots:
+
+      void onNodeGeometryChanged();
+      void onSidePanelScrolled();
 
     signals:
 
@@ -155,6 +256,7 @@ namespace FabricUI
       void nodeRemoved(FabricUI::GraphView::Node * node);
       void nodeSelected(FabricUI::GraphView::Node * node);
       void nodeDeselected(FabricUI::GraphView::Node * node);
+      void selectionChanged();
       void nodeMoved(FabricUI::GraphView::Node * node, QPointF pos);
       void nodeInspectRequested(FabricUI::GraphView::Node *);
       void nodeEditRequested(FabricUI::GraphView::Node *);
@@ -167,6 +269,25 @@ namespace FabricUI
 
     private:
 
+      Connection * addBulkConnection(ConnectionTarget * src, ConnectionTarget * dst, bool quiet);
+      // keep m_connections and the adjacency lists of the targets in sync
+      void insertConnection(Connection * connection);
+      void eraseConnection(Connection * connection);
+      // keep m_selection in sync with Node::setSelected
+      void insertSelection(Node * node);
+      void eraseSelection(Node * node);
+      // keep m_materializedNodes in sync with Node::m_virtualized
+      void materializeNode(Node * node);
+      void virtualizeNode(Node * node);
+      void setConnectionVirtualized(Connection * connection, bool state);
+      // queue connections for the next virtualization pass
+      void markVirtualizationCandidate(Connection * connection);
+      void markVirtualizationCandidates(ConnectionTarget * target);
+      void markVirtualizationCandidates(Node * node);
+      void updateConnectionVirtualization(Connection * connection, QRectF const & viewRect);
+      // keep m_detachedConnections in sync with Connection::m_detachedIndex
+      void insertDetachedConnection(Connection * connection);
+      void eraseDetachedConnection(Connection * connection);
 
       struct Hotkey
       {
@@ -191,9 +312,26 @@ namespace FabricUI
 
       GraphConfig m_config;
       Controller * m_controller;
-      std::vector<Node *> m_nodes;
-      std::map<FTL::StrRef, size_t> m_nodeMap;
+      NodeRegistry m_nodes;
+      NodeSpatialIndex m_spatialIndex;
+      NodePixmapCache m_pixmapCache;
+      // selected nodes in selection order, deselected nodes leave a NULL
+      // slot behind until more than half of the slots are empty
+      std::vector<Node *> m_selection;
+      size_t m_selectionCount;
       std::vector<Connection *> m_connections;
+      std::vector<Connection *> m_dirtyConnections;
+      bool m_dirtyConnectionsScheduled;
+      // the nodes currently shown, in no particular order
+      std::vector<Node *> m_materializedNodes;
+      unsigned m_virtualizationStamp;
+      bool m_virtualizationScheduled;
+      // the view rect of the last virtualization pass
+      QRectF m_virtualizationViewRect;
+      std::vector<Connection *> m_virtualizationCandidates;
+      // the connections between two virtualized nodes, shown only while
+      // the segment between their nodes crosses the view
+      std::vector<Connection *> m_detachedConnections;
       MouseGrabber * m_mouseGrabber;
       MainPanel * m_mainPanel;
       SidePanel * m_leftPanel;
@@ -220,6 +358,9 @@ namespace FabricUI
       double m_nodeZValue;
       double m_backdropZValue;
       double m_connectionZValue;
+      unsigned m_bulkBuildCount;
+      size_t m_bulkFirstConnection;
+      QGraphicsScene::ItemIndexMethod m_bulkItemIndexMethod;
 
     };
 
@@ -51,6 +51,7 @@ GraphConfig::GraphConfig()
   nodeSpaceBelowPorts = 4.0f;
   nodePinSpacing = 8.0f;
   nodePinStretch = 16.0f;
+  nodePixmapCacheBudget = 64 * 1024 * 1024;
   nodeShadowEnabled = true;
   nodeShadowColor = QColor(0, 0, 0, 75);
   nodeShadowOffset = QPointF(2.5, 2.5);
@@ -109,6 +110,15 @@ GraphConfig::GraphConfig()
   mouseWheelZoomRate = 0.0f; // disable zoom for now 0.0005f;
   mouseWheelZoomRate = 0.0005f;
 
+  lodThresholdNoDetails = 0.5f;
+  lodThresholdFlat = 0.3f;
+  lodThresholdDots = 0.12f;
+
+  virtualizationEnabled = true;
+  virtualizationMargin = 256.0f;
+
+  canvasPersistDelay = 500;
+
   backDropNodeAlpha = 0.45f;
   nodeBubbleMinWidth = 30.0;
   nodeBubbleMinHeight = 13.0;
@@ -67,6 +67,8 @@ namespace FabricUI
       float nodeSpaceBelowPorts;
       float nodePinSpacing;
       float nodePinStretch;
+      // byte budget of the zoom bucketed pixmaps the nodes are drawn from
+      size_t nodePixmapCacheBudget;
       bool nodeShadowEnabled;
       QColor nodeShadowColor;
       QPointF nodeShadowOffset;
@@ -104,6 +106,23 @@ namespace FabricUI
       float mouseGrabberRadius;
       float mouseWheelZoomRate;
 
+      // canvas zoom thresholds of the level of detail tiers, see
+      // MainPanel::LODTier.  a threshold of 0 disables its tier.
+      float lodThresholdNoDetails;
+      float lodThresholdFlat;
+      float lodThresholdDots;
+
+      // nodes further than the margin (in view pixels) outside of the main
+      // panel are taken out of the scene's painting and hit testing, see
+      // Graph::updateVirtualization.
+      bool virtualizationEnabled;
+      float virtualizationMargin;
+
+      // milliseconds without canvas pan or zoom changes after which the
+      // controller persists the canvas state, see
+      // Controller::flushCanvasState.
+      int canvasPersistDelay;
+
       float backDropNodeAlpha;
       float nodeBubbleMinWidth;
       float nodeBubbleMinHeight;
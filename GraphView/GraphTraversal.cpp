@@ -0,0 +1,118 @@
+// Copyright 2010-2015 Fabric Software Inc. All rights reserved.
+
+#include <FabricUI/GraphView/GraphTraversal.h>
+#include <FabricUI/GraphView/Connection.h>
+#include <FabricUI/GraphView/Node.h>
+#include <FabricUI/GraphView/Pin.h>
+
+#include <algorithm>
+
+using namespace FabricUI::GraphView;
+
+GraphTraversal::GraphTraversal(Direction direction, int maxDepth, Order order)
+  : m_direction(direction)
+  , m_maxDepth(maxDepth)
+  , m_order(order)
+{
+}
+
+bool GraphTraversal::VisitPrecedes(Visit const & a, Visit const & b)
+{
+  return a.connection->m_graphIndex < b.connection->m_graphIndex;
+}
+
+int GraphTraversal::indexOf(Node * node) const
+{
+  std::map<Node *, size_t>::const_iterator it = m_indices.find(node);
+  if(it == m_indices.end())
+    return -1;
+  return (int)it->second;
+}
+
+void GraphTraversal::traverse(std::vector<Node *> const & roots)
+{
+  m_nodes.clear();
+  m_depths.clear();
+  m_edges.clear();
+  m_indices.clear();
+
+  for(size_t i=0;i<roots.size();i++)
+  {
+    if(!m_indices.insert(std::pair<Node *, size_t>(roots[i], m_nodes.size())).second)
+      continue;
+    m_nodes.push_back(roots[i]);
+    m_depths.push_back(0);
+  }
+
+  // m_nodes doubles as the queue
+  std::vector<Visit> visits;
+  for(size_t i=0;i<m_nodes.size();i++)
+  {
+    Node * node = m_nodes[i];
+    visits.clear();
+    for(unsigned int k=0;k<node->pinCount();k++)
+    {
+      Pin * pin = node->pin(k);
+      if(m_direction & Direction_Upstream)
+      {
+        std::vector<Connection *> const & connections = pin->inConnections();
+        for(size_t j=0;j<connections.size();j++)
+        {
+          Visit visit = { connections[j], true };
+          visits.push_back(visit);
+        }
+      }
+      if(m_direction & Direction_Downstream)
+      {
+        std::vector<Connection *> const & connections = pin->outConnections();
+        for(size_t j=0;j<connections.size();j++)
+        {
+          Visit visit = { connections[j], false };
+          visits.push_back(visit);
+        }
+      }
+    }
+
+    // only the node's own connections get sorted, not the whole graph
+    if(m_order == Order_Connections)
+      std::stable_sort(visits.begin(), visits.end(), VisitPrecedes);
+    for(size_t j=0;j<visits.size();j++)
+      visitConnection(i, visits[j].connection, visits[j].upstream);
+  }
+}
+
+void GraphTraversal::visitConnection(size_t from, Connection * connection, bool upstream)
+{
+  ConnectionTarget * target = upstream ? connection->src() : connection->dst();
+  if(!target || target->targetType() != TargetType_Pin)
+    return;
+  Node * node = ((Pin *)target)->node();
+
+  size_t to;
+  std::map<Node *, size_t>::iterator it = m_indices.find(node);
+  if(it != m_indices.end())
+    to = it->second;
+  else
+  {
+    int depth = m_depths[from] + 1;
+    if(m_maxDepth >= 0 && depth > m_maxDepth)
+      return;
+    to = m_nodes.size();
+    m_indices.insert(std::pair<Node *, size_t>(node, to));
+    m_nodes.push_back(node);
+    m_depths.push_back(depth);
+  }
+
+  if(to == from)
+    return;
+  // when going both ways each connection is seen from both of its ends,
+  // keep it from the end that was visited first
+  if(m_direction == Direction_Both && to < from)
+    return;
+
+  Edge edge;
+  edge.from = from;
+  edge.to = to;
+  edge.connection = connection;
+  m_edges.push_back(edge);
+}
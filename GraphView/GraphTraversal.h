@@ -0,0 +1,95 @@
+// Copyright 2010-2015 Fabric Software Inc. All rights reserved.
+
+#ifndef __UI_GraphView_GraphTraversal__
+#define __UI_GraphView_GraphTraversal__
+
+#include <map>
+#include <vector>
+
+namespace FabricUI
+{
+
+  namespace GraphView
+  {
+    // forward declarations
+    class Connection;
+    class Node;
+
+    // Breadth-first traversal of the nodes reachable from a set of root
+    // nodes through the connections between their pins.  Each node only
+    // looks at its own pins' connections, so a traversal costs
+    // O(visited pins + visited connections) rather than a scan of the
+    // whole graph per node.
+    class GraphTraversal
+    {
+    public:
+
+      enum Direction
+      {
+        Direction_Upstream = 1,
+        Direction_Downstream = 2,
+        Direction_Both = Direction_Upstream | Direction_Downstream
+      };
+
+      // the order in which the neighbors of a node are visited
+      enum Order
+      {
+        Order_Pins,       // by pin, then by connection on the pin
+        Order_Connections // in the order of Graph::connections()
+      };
+
+      // an edge between two visited nodes, oriented away from the roots
+      // and given as indices into nodes()
+      struct Edge
+      {
+        size_t from;
+        size_t to;
+        Connection * connection;
+      };
+
+      // a negative maxDepth means no limit
+      GraphTraversal(Direction direction, int maxDepth = -1, Order order = Order_Pins);
+
+      // visits the roots, then their neighbors in the traversal's order,
+      // and so on
+      void traverse(std::vector<Node *> const & roots);
+
+      // the visited nodes, in visiting order starting with the roots
+      std::vector<Node *> const & nodes() const
+        { return m_nodes; }
+      // the number of hops between each visited node and the roots
+      std::vector<int> const & depths() const
+        { return m_depths; }
+      // every connection between two visited nodes, in visiting order
+      std::vector<Edge> const & edges() const
+        { return m_edges; }
+
+      // returns -1 if node was not visited
+      int indexOf(Node * node) const;
+
+    private:
+
+      struct Visit
+      {
+        Connection * connection;
+        bool upstream;
+      };
+
+      static bool VisitPrecedes(Visit const & a, Visit const & b);
+
+      void visitConnection(size_t from, Connection * connection, bool upstream);
+
+      Direction m_direction;
+      int m_maxDepth;
+      Order m_order;
+      std::vector<Node *> m_nodes;
+      std::vector<int> m_depths;
+      std::vector<Edge> m_edges;
+      std::map<Node *, size_t> m_indices;
+    };
+
+  };
+
+};
+
+#endif // __UI_GraphView_GraphTraversal__
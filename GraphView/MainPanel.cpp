@@ -14,6 +14,7 @@
 #include <FabricUI/GraphView/CachingEffect.h>
 
 #include <math.h>
+#include <set>
 
 using namespace FabricUI::GraphView;
 
@@ -28,6 +29,8 @@ MainPanel::MainPanel(Graph * parent)
   m_graph = parent;
   m_mouseWheelZoomState = 1.0;
   m_mouseWheelZoomRate = m_graph->config().mouseWheelZoomRate;
+  m_lodTier = LODTier_Full;
+  updateLODTier();
 
   setSizePolicy(QSizePolicy(QSizePolicy::Expanding, QSizePolicy::Expanding));
 
@@ -98,12 +101,32 @@ void MainPanel::setCanvasZoom(float state, bool quiet)
     m_itemGroup->setScale(state);
   }
 
+  updateLODTier();
+  m_graph->markSidePanelConnectionsDirty();
+  m_graph->markVirtualizationDirty();
   update();
 
   if(!quiet)
     emit canvasZoomChanged(m_mouseWheelZoomState);
 }
 
+void MainPanel::updateLODTier()
+{
+  const GraphConfig & config = m_graph->config();
+  float zoom = m_mouseWheelZoomState;
+  if(zoom < config.lodThresholdDots)
+    m_lodTier = LODTier_Dots;
+  else if(zoom < config.lodThresholdFlat)
+    m_lodTier = LODTier_Flat;
+  else if(zoom < config.lodThresholdNoDetails)
+    m_lodTier = LODTier_NoDetails;
+  else
+    m_lodTier = LODTier_Full;
+
+  // pixmaps drawn at another tier are kept for when it comes back
+  m_graph->pixmapCache().setVariant(int(m_lodTier));
+}
+
 QPointF MainPanel::canvasPan() const
 {
   return m_itemGroup->pos();
@@ -112,6 +135,8 @@ QPointF MainPanel::canvasPan() const
 void MainPanel::setCanvasPan(QPointF pos, bool quiet)
 {
   m_itemGroup->setPos(pos);
+  m_graph->markSidePanelConnectionsDirty();
+  m_graph->markVirtualizationDirty();
 
   if(!quiet)
     emit canvasPanChanged(pos);
@@ -187,27 +212,35 @@ void MainPanel::mouseMoveEvent(QGraphicsSceneMouseEvent * event)
     QPointF dragPoint = mapToItem(m_itemGroup, mapFromScene( event->scenePos() ) );
     m_selectionRect->setDragPoint(dragPoint);
 
-    if(!event->modifiers().testFlag(Qt::ControlModifier) && !event->modifiers().testFlag(Qt::ShiftModifier))
-      m_graph->controller()->clearSelection();
-    else
+    // the selection was cleared on press unless a modifier was held, so
+    // only the nodes entering or leaving the rectangle since the previous
+    // move need to change, and they are applied as a single batch.
+    std::vector<Node*> hits = m_graph->nodesIntersecting(m_selectionRect->geometry());
+    std::set<Node*> hitSet(hits.begin(), hits.end());
+
+    std::vector<Node*> toSelect;
+    std::vector<Node*> toDeselect;
+    std::vector<Node*> ongoingSelection;
+    for(size_t i=0;i<m_ongoingSelection.size();i++)
     {
-      for(size_t i=0;i<m_ongoingSelection.size();i++)
-        m_graph->controller()->selectNode(m_ongoingSelection[i], false);
+      Node * node = m_ongoingSelection[i];
+      if(hitSet.find(node) == hitSet.end())
+        toDeselect.push_back(node);
+      else
+        ongoingSelection.push_back(node);
     }
-
-    m_ongoingSelection.clear();
-    std::vector<Node*> nodes = m_graph->nodes();
-    for(size_t i=0;i<nodes.size();i++)
+    for(size_t i=0;i<hits.size();i++)
     {
-      if(m_selectionRect->collidesWithItem(nodes[i]))
+      if(!hits[i]->selected())
       {
-        if(!nodes[i]->selected())
-        {
-          m_graph->controller()->selectNode(nodes[i], true);
-          m_ongoingSelection.push_back(nodes[i]);
-        }
+        toSelect.push_back(hits[i]);
+        ongoingSelection.push_back(hits[i]);
       }
     }
+    m_ongoingSelection.swap(ongoingSelection);
+
+    if(toSelect.size() > 0 || toDeselect.size() > 0)
+      m_graph->controller()->selectNodes(toSelect, toDeselect);
     m_draggingSelRect = true;
   }
   else if(m_manipulationMode == ManipulationMode_Pan)
@@ -254,6 +287,7 @@ void MainPanel::mouseReleaseEvent(QGraphicsSceneMouseEvent * event)
   {
     setCursor(Qt::ArrowCursor);
     m_manipulationMode = ManipulationMode_None;
+    m_graph->controller()->flushCanvasState();
   }
   else
     QGraphicsWidget::mouseMoveEvent(event);
@@ -324,6 +358,7 @@ void MainPanel::paint(QPainter * painter, const QStyleOptionGraphicsItem * optio
 void MainPanel::resizeEvent(QGraphicsSceneResizeEvent * event)
 {
   QGraphicsWidget::resizeEvent(event);
+  m_graph->markVirtualizationDirty();
   if(m_graph->sidePanel(PortType_Input))
     emit m_graph->sidePanel(PortType_Input)->scrolled();
   if(m_graph->sidePanel(PortType_Output))
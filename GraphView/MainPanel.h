@@ -32,6 +32,17 @@ namespace FabricUI
         ManipulationMode_Zoom
       };
 
+      // how much of the graph gets painted, from the canvas zoom and the
+      // GraphConfig::lodThreshold* values.  switching tiers only changes
+      // what the items paint, no item is created or destroyed.
+      enum LODTier
+      {
+        LODTier_Full,
+        LODTier_NoDetails, // no pin labels and header buttons
+        LODTier_Flat,      // flat node rectangles with their title only
+        LODTier_Dots       // nodes as dots, connections as straight lines
+      };
+
       MainPanel(Graph * parent);
       virtual ~MainPanel() {}
 
@@ -42,6 +53,7 @@ namespace FabricUI
 
       float canvasZoom() const;
       QPointF canvasPan() const;
+      LODTier lodTier() const { return m_lodTier; }
  
       float mouseWheelZoomRate() const;
       void setMouseWheelZoomRate(float rate);
@@ -78,6 +90,7 @@ namespace FabricUI
         float zoomFactor,
         QPointF zoomCenter
         );
+      void updateLODTier();
 
 #if (QT_VERSION < QT_VERSION_CHECK(4,7,0))
       virtual void updateGeometry();
@@ -94,6 +107,7 @@ namespace FabricUI
       float m_mouseWheelZoomRate;
       float m_mouseAltZoomState;
       float m_mouseWheelZoomState;
+      LODTier m_lodTier;
       ManipulationMode m_manipulationMode;
       QGraphicsWidget * m_itemGroup;
       bool m_draggingSelRect;
@@ -0,0 +1,140 @@
+// Copyright 2010-2015 Fabric Software Inc. All rights reserved.
+
+#include <FabricUI/GraphView/NameIndex.h>
+#include <FabricUI/Util/StrHash.h>
+
+using namespace FabricUI;
+using namespace FabricUI::GraphView;
+
+NameIndex::NameIndex()
+  : m_count( 0 )
+{
+}
+
+void NameIndex::clear()
+{
+  m_entries.clear();
+  m_count = 0;
+}
+
+void NameIndex::reserve( size_t count )
+{
+  // keep the load factor at or below one half
+  size_t capacity = m_entries.empty() ? 16 : m_entries.size();
+  while ( capacity < 2 * count )
+    capacity *= 2;
+  if ( capacity > m_entries.size() )
+    rehash( capacity );
+}
+
+void NameIndex::rehash( size_t capacity )
+{
+  std::vector<Entry> entries( capacity );
+  entries.swap( m_entries );
+
+  size_t mask = m_entries.size() - 1;
+  for ( size_t i = 0; i < entries.size(); ++i )
+  {
+    Entry &entry = entries[i];
+    if ( !entry.used )
+      continue;
+    size_t slot = entry.hash & mask;
+    while ( m_entries[slot].used )
+      slot = ( slot + 1 ) & mask;
+    Entry &newEntry = m_entries[slot];
+    newEntry.name.swap( entry.name );
+    newEntry.value = entry.value;
+    newEntry.hash = entry.hash;
+    newEntry.used = true;
+  }
+}
+
+size_t NameIndex::findEntry( FTL::StrRef name, uint32_t hash ) const
+{
+  if ( m_entries.empty() )
+    return size_t( -1 );
+
+  size_t mask = m_entries.size() - 1;
+  for ( size_t slot = hash & mask; ; slot = ( slot + 1 ) & mask )
+  {
+    Entry const &entry = m_entries[slot];
+    if ( !entry.used )
+      return size_t( -1 );
+    if ( entry.hash == hash
+      && FTL::StrRef( entry.name.data(), entry.name.size() ) == name )
+      return slot;
+  }
+}
+
+size_t const *NameIndex::find( FTL::StrRef name ) const
+{
+  size_t slot = findEntry( name, Util::HashStr( name ) );
+  if ( slot == size_t( -1 ) )
+    return 0;
+  return &m_entries[slot].value;
+}
+
+size_t *NameIndex::find( FTL::StrRef name )
+{
+  size_t slot = findEntry( name, Util::HashStr( name ) );
+  if ( slot == size_t( -1 ) )
+    return 0;
+  return &m_entries[slot].value;
+}
+
+bool NameIndex::insert( FTL::StrRef name, size_t value )
+{
+  uint32_t hash = Util::HashStr( name );
+  if ( findEntry( name, hash ) != size_t( -1 ) )
+    return false;
+
+  reserve( m_count + 1 );
+
+  size_t mask = m_entries.size() - 1;
+  size_t slot = hash & mask;
+  while ( m_entries[slot].used )
+    slot = ( slot + 1 ) & mask;
+  Entry &entry = m_entries[slot];
+  entry.name.assign( name.data(), name.size() );
+  entry.value = value;
+  entry.hash = hash;
+  entry.used = true;
+  ++m_count;
+  return true;
+}
+
+bool NameIndex::erase( FTL::StrRef name )
+{
+  size_t slot = findEntry( name, Util::HashStr( name ) );
+  if ( slot == size_t( -1 ) )
+    return false;
+
+  // backward shift deletion: pull up the following entries of the
+  // cluster that would no longer be reachable, so no tombstones are
+  // needed
+  size_t mask = m_entries.size() - 1;
+  size_t hole = slot;
+  for ( size_t next = ( hole + 1 ) & mask;
+    m_entries[next].used; next = ( next + 1 ) & mask )
+  {
+    size_t home = m_entries[next].hash & mask;
+    // move next into the hole if its home is not within (hole, next]
+    bool reachable = hole <= next
+      ? ( home > hole && home <= next )
+      : ( home > hole || home <= next );
+    if ( reachable )
+      continue;
+    Entry &holeEntry = m_entries[hole];
+    Entry &nextEntry = m_entries[next];
+    holeEntry.name.swap( nextEntry.name );
+    holeEntry.value = nextEntry.value;
+    holeEntry.hash = nextEntry.hash;
+    hole = next;
+  }
+
+  Entry &entry = m_entries[hole];
+  entry.name.clear();
+  entry.used = false;
+  --m_count;
+  return true;
+}
@@ -0,0 +1,67 @@
+// Copyright 2010-2015 Fabric Software Inc. All rights reserved.
+
+#ifndef __UI_GraphView_NameIndex__
+#define __UI_GraphView_NameIndex__
+
+#include <FTL/StrRef.h>
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace FabricUI
+{
+
+  namespace GraphView
+  {
+
+    // Hash table from a name to an index, using open addressing with
+    // linear probing.  The names are copied into the table, so they do
+    // not depend on the lifetime of the object they name.
+    class NameIndex
+    {
+    public:
+
+      NameIndex();
+
+      size_t size() const
+        { return m_count; }
+      bool empty() const
+        { return m_count == 0; }
+
+      void clear();
+      void reserve( size_t count );
+
+      // returns NULL if name is not in the index
+      size_t const *find( FTL::StrRef name ) const;
+      size_t *find( FTL::StrRef name );
+
+      // returns false if name is already in the index
+      bool insert( FTL::StrRef name, size_t value );
+      // returns false if name is not in the index
+      bool erase( FTL::StrRef name );
+
+    private:
+
+      struct Entry
+      {
+        std::string name;
+        size_t value;
+        uint32_t hash;
+        bool used;
+
+        Entry() : value( 0 ), hash( 0 ), used( false ) {}
+      };
+
+      size_t findEntry( FTL::StrRef name, uint32_t hash ) const;
+      void rehash( size_t capacity );
+
+      std::vector<Entry> m_entries;
+      size_t m_count;
+    };
+
+  };
+
+};
+
+#endif // __UI_GraphView_NameIndex__
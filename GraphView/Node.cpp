@@ -6,6 +6,7 @@
 #include <FabricUI/GraphView/NodeRectangle.h>
 #include <FabricUI/GraphView/NodeBubble.h>
 #include <FabricUI/GraphView/Graph.h>
+#include <FabricUI/GraphView/GraphTraversal.h>
 
 #include <QtGui/QGraphicsLinearLayout>
 #include <QtGui/QGraphicsSceneMouseEvent>
@@ -101,6 +102,10 @@ Node::Node(
   m_pinsWidget->setLayout(m_pinsLayout);
 
   m_selected = false;
+  m_selectionIndex = -1;
+  m_virtualized = false;
+  m_materializedIndex = -1;
+  m_virtualizationStamp = 0;
   m_dragging = 0;
 
   // setup the drop shadow
@@ -114,7 +119,7 @@ Node::Node(
   }
 
   // setup caching
-  m_cache = new CachingEffect(this);
+  m_cache = new CachingEffect(this, &m_graph->pixmapCache());
   this->setGraphicsEffect(m_cache);
   
   m_bubble = new GraphView::NodeBubble( graph(), this, graph()->config() );
@@ -176,6 +181,7 @@ void Node::setTitle( FTL::CStrRef title )
     m_header->setTitle( QSTRING_FROM_FTL_UTF8(titleToSet) );
     m_header->labelWidget()->setItalic(m_titleSuffix.length() > 0);
   }
+  markCacheDirty(CachingEffect::Dirty_Title);
 }
 
 void Node::setTitleSuffix( FTL::CStrRef titleSuffix )
@@ -202,6 +208,7 @@ void Node::setColorAsGradient(QColor a, QColor b)
     m_defaultPen.setBrush(m_colorB.darker());
   if ( m_mainWidget )
     m_mainWidget->update();
+  markCacheDirty(CachingEffect::Dirty_Color);
 }
 
 QColor Node::titleColor() const
@@ -214,6 +221,7 @@ void Node::setTitleColor(QColor col)
   m_titleColor = col;
   if(m_header)
     m_header->setColor(m_titleColor.lighter());
+  markCacheDirty(CachingEffect::Dirty_Color);
 }
 
 QColor Node::fontColor() const
@@ -233,6 +241,7 @@ void Node::setFontColor(QColor col)
   {
     m_pins[i]->labelWidget()->setColor(m_fontColor, m_pins[i]->labelWidget()->highlightColor());
   }
+  markCacheDirty(CachingEffect::Dirty_Color);
 }
 
 QPen Node::defaultPen() const
@@ -290,6 +299,7 @@ void Node::setCollapsedState(Node::CollapseState state)
   emit collapsedStateChanged(this, m_collapsedState);
   m_header->setHeaderButtonState("node_collapse", (int)m_collapsedState);
   updatePinLayout();
+  markCacheDirty(CachingEffect::Dirty_Style);
   update();
 }
 
@@ -303,6 +313,10 @@ void Node::setSelected(bool state, bool quiet)
   if(state == m_selected)
     return;
   m_selected = state;
+  if(m_selected)
+    m_graph->insertSelection(this);
+  else
+    m_graph->eraseSelection(this);
   if(m_header)
   {
     m_header->setHighlighted(m_selected);
@@ -310,12 +324,15 @@ void Node::setSelected(bool state, bool quiet)
   }
   if(!quiet)
   {
+    m_graph->updateConnectionsSelection(this);
     emit selectionChanged(this, m_selected);
     if(m_selected)
       emit m_graph->nodeSelected(this);
     else
       emit m_graph->nodeDeselected(this);
+    emit m_graph->selectionChanged();
   }
+  markCacheDirty(CachingEffect::Dirty_Selection);
   update();
 }
 
@@ -333,6 +350,7 @@ void Node::setError(QString text)
 {
   m_errorText = text;
   setToolTip(text);
+  markCacheDirty(CachingEffect::Dirty_Style);
   update();
 }
 
@@ -366,6 +384,9 @@ QPointF Node::topLeftGraphPos() const
 void Node::setTopLeftGraphPos(QPointF pos, bool quiet)
 {
   setTransform(QTransform::fromTranslate(pos.x(), pos.y()), false);
+  m_graph->spatialIndex().markDirty(this);
+  m_graph->markConnectionsDirty(this);
+  m_graph->markVirtualizationDirty(this);
   if(!quiet)
   {
     emit positionChanged(this, graphPos());
@@ -388,13 +409,8 @@ QPointF Node::centralPosToTopLeftPos(QPointF pos) const
 Pin * Node::addPin(Pin * pin, bool quiet)
 {
   // todo: we need a method to update the layout based on the collapsed state.....
-  for(size_t i=0;i<m_pins.size();i++)
-  {
-    if(m_pins[i] == pin)
-      return NULL;
-    if(m_pins[i]->name() == pin->name())
-      return NULL;
-  }
+  if(!m_pinNames.insert(pin->name(), m_pins.size()))
+    return NULL;
 
   pin->setIndex((int)m_pins.size());
   m_pins.push_back(pin);
@@ -407,19 +423,18 @@ Pin * Node::addPin(Pin * pin, bool quiet)
 
 bool Node::removePin(Pin * pin, bool quiet)
 {
-  size_t index = m_pins.size();
-  for(size_t i=0;i<m_pins.size();i++)
-  {
-    if(m_pins[i] == pin)
-    {
-      index = i;
-      break;
-    }
-  }
-  if(index == m_pins.size())
+  size_t const *indexPtr = m_pinNames.find(pin->name());
+  if(!indexPtr || m_pins[*indexPtr] != pin)
     return false;
 
+  size_t index = *indexPtr;
+  m_pinNames.erase(pin->name());
   m_pins.erase(m_pins.begin() + index);
+  for(size_t i=index;i<m_pins.size();i++)
+  {
+    m_pins[i]->setIndex((int)i);
+    *m_pinNames.find(m_pins[i]->name()) = i;
+  }
   updatePinLayout();
   if(!quiet)
     emit pinRemoved(this, pin);
@@ -442,30 +457,29 @@ void Node::reorderPins(QStringList names)
     pins[i]->setIndex(i);
   }
   m_pins = pins;
+  m_pinNames.clear();
+  m_pinNames.reserve(m_pins.size());
+  for(size_t i=0;i<m_pins.size();i++)
+    m_pinNames.insert(m_pins[i]->name(), i);
   updatePinLayout();
   update();
 }
 
 std::vector<Node*> Node::upStreamNodes(bool sortForPins, std::vector<Node*> rootNodes)
 {
-  int maxCol = 0;
-
-  std::map<Node*, Node*> visitedNodes;
-  std::vector<Node*> nodes;
-
   if(rootNodes.size() == 0)
-  {
-    visitedNodes.insert(std::pair<Node*, Node*>(this, this));
-    nodes.push_back(this);
-  }
-  else
-  {
-    for(size_t i=0;i<rootNodes.size();i++)
-    {
-      visitedNodes.insert(std::pair<Node*, Node*>(rootNodes[i], rootNodes[i]));
-      nodes.push_back(rootNodes[i]);
-    }
-  }
+    rootNodes.push_back(this);
+
+  // sortForPins visits the producers by pin, otherwise in the order of
+  // the graph's connections
+  GraphTraversal traversal(
+    GraphTraversal::Direction_Upstream,
+    -1,
+    sortForPins ? GraphTraversal::Order_Pins : GraphTraversal::Order_Connections
+    );
+  traversal.traverse(rootNodes);
+  std::vector<Node*> const & nodes = traversal.nodes();
+  std::vector<GraphTraversal::Edge> const & edges = traversal.edges();
 
   for(size_t i=0;i<nodes.size();i++)
   {
@@ -473,52 +487,52 @@ std::vector<Node*> Node::upStreamNodes(bool sortForPins, std::vector<Node*> root
       nodes[i]->setCol(0);
   }
 
-  std::vector<Connection*> connections = graph()->connections();
+  // longest path layering: a node sits one column left of the
+  // furthest of its consumers.  Nodes are processed once all their
+  // consumers are (Kahn's algorithm), which makes this linear in the
+  // number of edges.
+  std::vector<size_t> pendingConsumers(nodes.size(), 0);
+  std::vector<size_t> firstEdge(nodes.size() + 1, 0);
+  for(size_t i=0;i<edges.size();i++)
+  {
+    pendingConsumers[edges[i].to]++;
+    firstEdge[edges[i].from + 1]++;
+  }
   for(size_t i=0;i<nodes.size();i++)
+    firstEdge[i + 1] += firstEdge[i];
+  std::vector<size_t> producers(edges.size());
+  std::vector<size_t> fill(firstEdge.begin(), firstEdge.end() - 1);
+  for(size_t i=0;i<edges.size();i++)
+    producers[fill[edges[i].from]++] = edges[i].to;
+
+  std::vector<size_t> ready;
+  for(size_t i=0;i<nodes.size();i++)
+  {
+    if(pendingConsumers[i] == 0)
+      ready.push_back(i);
+  }
+  for(size_t r=0;r<ready.size();r++)
   {
-    for(size_t k=0;k<nodes[i]->m_pins.size();k++)
+    Node * consumer = nodes[ready[r]];
+    for(size_t e=firstEdge[ready[r]];e<firstEdge[ready[r] + 1];e++)
     {
-      for(size_t j=0;j<connections.size();j++)
-      {
-        ConnectionTarget * dst = connections[j]->dst();
-        ConnectionTarget * src = connections[j]->src();
-        if(!dst || !src)
-          continue;
-        if(dst->targetType() != TargetType_Pin || src->targetType() != TargetType_Pin)
-          continue;
-
-        Pin * dstPin = (Pin*)dst;
-        Pin * srcPin = (Pin*)src;
-        Node * dstNode = dstPin->node();
-        Node * srcNode = srcPin->node();
-
-        if(dstNode != nodes[i])
-          continue;
-        if(visitedNodes.find(srcNode) != visitedNodes.end())
-          continue;
-        if(sortForPins && dstPin != nodes[i]->m_pins[k])
-          continue;
-
-        if(srcNode->col() < nodes[i]->col() + 1)
-          srcNode->setCol(nodes[i]->col() + 1);
-        if(srcNode->col() > maxCol)
-          maxCol = srcNode->col();
-
-        visitedNodes.insert(std::pair<Node*, Node*>(srcNode, srcNode));
-        nodes.push_back(srcNode);
-      }
-
-      if(!sortForPins)
-        break;
+      size_t producerIndex = producers[e];
+      Node * producer = nodes[producerIndex];
+      if(producer->col() < consumer->col() + 1)
+        producer->setCol(consumer->col() + 1);
+      if(--pendingConsumers[producerIndex] == 0)
+        ready.push_back(producerIndex);
     }
   }
 
-  std::vector<int> rows(maxCol+1);
-  for(int i=0; i<maxCol; i++)
+  int maxCol = 0;
+  for(size_t i=0;i<nodes.size();i++)
   {
-    rows[i] = 0;
+    if(nodes[i]->col() > maxCol)
+      maxCol = nodes[i]->col();
   }
 
+  std::vector<int> rows(maxCol+1, 0);
   for(size_t i=0;i<nodes.size();i++)
   {
     nodes[i]->setRow(rows[nodes[i]->col()]);
@@ -548,6 +562,13 @@ void Node::setCol(int i)
   m_col = i;
 }
 
+void Node::markCacheDirty(unsigned int flags)
+{
+  // the node's own setters run before the effect exists
+  if(m_cache)
+    m_cache->markDirty(flags);
+}
+
 void Node::setAlwaysShowDaisyChainPorts(bool state)
 {
   if(m_alwaysShowDaisyChainPorts == state)
@@ -568,11 +589,9 @@ Pin * Node::pin(unsigned int index)
 
 Pin * Node::pin(FTL::StrRef name)
 {
-  for(unsigned int i=0;i<m_pins.size();i++)
-  {
-    if(name == m_pins[i]->name())
-      return m_pins[i];
-  }
+  size_t const *index = m_pinNames.find(name);
+  if(index)
+    return m_pins[*index];
   return NULL;
 }
 
@@ -628,21 +647,11 @@ bool Node::onMousePress(Qt::MouseButton button, Qt::KeyboardModifiers modifiers,
     m_dragButton = button;
     m_mouseDownPos = scenePos;
 
-    Node * hitNode = this;
-
     // apparently qt doesn't cast again on right
     // mouse button, so contextual menus are off.
-    std::vector<Node *> nodes = graph()->nodes();
-    for(size_t i=0;i<nodes.size();i++)
-    {
-      QPointF pos = nodes[i]->mapFromScene(scenePos);
-      if(nodes[i]->rect().contains(pos))
-      {
-        if(nodes[i]->zValue() < hitNode->zValue())
-          continue;
-        hitNode = nodes[i];
-      }
-    }
+    Node * hitNode = graph()->nodeAt(graph()->itemGroup()->mapFromScene(scenePos));
+    if(!hitNode || hitNode->zValue() < zValue())
+      hitNode = this;
 
     bool clearSelection = true;
     if(button == DFG_QT_MIDDLE_MOUSE)
@@ -703,6 +712,10 @@ bool Node::onMousePress(Qt::MouseButton button, Qt::KeyboardModifiers modifiers,
         );
     }
 
+    m_nodesToMoveOrigins.resize(m_nodesToMove.size());
+    for(size_t i=0;i<m_nodesToMove.size();i++)
+      m_nodesToMoveOrigins[i] = m_nodesToMove[i]->topLeftGraphPos();
+
     if(button == Qt::RightButton)
     {
       QMenu * menu = graph()->getNodeContextMenu(hitNode);
@@ -725,14 +738,13 @@ bool Node::onMouseMove(Qt::MouseButton button, Qt::KeyboardModifiers modifiers,
   {
     m_dragging = 2;
 
-    QPointF delta = scenePos - lastScenePos;
+    // the nodes are only moved locally while dragging, the controller
+    // records the whole move once the mouse is released
+    QPointF delta = scenePos - m_mouseDownPos;
     delta *= 1.0f / graph()->mainPanel()->canvasZoom();
 
-    m_graph->controller()->gvcDoMoveNodes(
-      m_nodesToMove,
-      delta,
-      false // allowUndo
-      );
+    for(size_t i=0;i<m_nodesToMove.size();i++)
+      m_nodesToMove[i]->setTopLeftGraphPos(m_nodesToMoveOrigins[i] + delta);
 
     return true;
   }
@@ -744,25 +756,29 @@ bool Node::onMouseRelease(Qt::MouseButton button, Qt::KeyboardModifiers modifier
 {
   if ( m_dragging == 2 )
   {
-    if(!selected())
-      emit positionChanged(this, graphPos());
-    else
+    QPointF delta = scenePos - m_mouseDownPos;
+    delta *= 1.0f / graph()->mainPanel()->canvasZoom();
+
+    if(m_nodesToMove.size() > 0 && !delta.isNull())
     {
-      m_graph->controller()->gvcDoMoveNodes(
-        m_nodesToMove,
-        m_mouseDownPos - lastScenePos,
-        false // allowUndo
-        );
+      // back to where the drag started, so the controller records the
+      // move of all the nodes as a single undoable edit from there
+      for(size_t i=0;i<m_nodesToMove.size();i++)
+        m_nodesToMove[i]->setTopLeftGraphPos(m_nodesToMoveOrigins[i]);
 
       m_graph->controller()->gvcDoMoveNodes(
         m_nodesToMove,
-        scenePos - m_mouseDownPos,
+        delta,
         true // allowUndo
         );
     }
 
+    if(!selected())
+      emit positionChanged(this, graphPos());
+
     m_dragging = 0;
     m_nodesToMove.clear();
+    m_nodesToMoveOrigins.clear();
 
     return true;
   }
@@ -844,6 +860,8 @@ void Node::updatePinLayout()
   {
     m_pins[i]->setDaisyChainCircleVisible(m_alwaysShowDaisyChainPorts);
   }
+
+  markCacheDirty(CachingEffect::Dirty_Pins);
 }
 
 #if (QT_VERSION < QT_VERSION_CHECK(4,7,0))
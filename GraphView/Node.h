@@ -15,6 +15,8 @@
 #include <FabricUI/GraphView/Pin.h>
 #include <FabricUI/GraphView/GraphicItemTypes.h>
 #include <FabricUI/GraphView/CachingEffect.h>
+#include <FabricUI/GraphView/NameIndex.h>
+#include <FabricUI/GraphView/NodeSpatialIndex.h>
 
 namespace FabricUI
 {
@@ -34,6 +36,7 @@ namespace FabricUI
       friend class NodeRectangle;
       friend class NodeBubble;
       friend class NodeHeaderButton;
+      friend class NodeSpatialIndex;
 
     public:
 
@@ -91,6 +94,9 @@ namespace FabricUI
       
       virtual bool selected() const;
 
+      // true while the node is off screen, see Graph::updateVirtualization
+      bool isVirtualized() const { return m_virtualized; }
+
       virtual CollapseState collapsedState() const;
       virtual void setCollapsedState(CollapseState state);
       virtual void toggleCollapsedState();
@@ -133,6 +139,9 @@ namespace FabricUI
 
       virtual void setAlwaysShowDaisyChainPorts(bool state);
 
+      // drops the cached pixmaps of the node, see CachingEffect::DirtyFlag
+      void markCacheDirty(unsigned int flags);
+
       QGraphicsWidget * mainWidget();
       QGraphicsWidget * pinsWidget();
 
@@ -195,16 +204,27 @@ namespace FabricUI
       QGraphicsWidget * m_pinsWidget;
       QGraphicsLinearLayout * m_pinsLayout;
       bool m_selected;
+      // position in the graph's selection, -1 if not selected
+      int m_selectionIndex;
       int m_dragging;
       Qt::MouseButton m_dragButton;
       QPointF m_mouseDownPos;
       std::vector<Node *> m_nodesToMove;
+      // the positions of m_nodesToMove when the drag started
+      std::vector<QPointF> m_nodesToMoveOrigins;
 
       std::vector<Pin*> m_pins;
+      // pin name to position in m_pins
+      NameIndex m_pinNames;
       CachingEffect * m_cache;
       int m_row;
       int m_col;
       bool m_alwaysShowDaisyChainPorts;
+      NodeSpatialIndex::Entry m_spatialEntry;
+      bool m_virtualized;
+      // position in the graph's materialized nodes, -1 if virtualized
+      int m_materializedIndex;
+      unsigned m_virtualizationStamp;
     };
 
 
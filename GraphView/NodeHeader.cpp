@@ -81,6 +81,7 @@ const Node * NodeHeader::node() const
 void NodeHeader::setTitle(QString const &title)
 {
   m_title->setText(title);
+  node()->markCacheDirty(CachingEffect::Dirty_Title);
 }
 
 bool NodeHeader::highlighted() const
@@ -91,6 +92,7 @@ bool NodeHeader::highlighted() const
 void NodeHeader::setHighlighted(bool state)
 {
   m_title->setHighlighted(state);
+  node()->markCacheDirty(CachingEffect::Dirty_Selection);
 }
 
 std::string NodeHeader::path() const
@@ -142,17 +144,19 @@ void NodeHeader::setColor(QColor col)
     m_inCircle->setColor(col);
   if(m_outCircle)
     m_outCircle->setColor(col);
+  node()->markCacheDirty(CachingEffect::Dirty_Color);
 }
 
 bool NodeHeader::areCirclesVisible() const
 {
-  return m_outCircle->isVisible();
+  return m_outCircle->isVisibleTo(this);
 }
 
 void NodeHeader::setCirclesVisible(bool visible)
 {
   m_inCircle->setVisible(visible);
   m_outCircle->setVisible(visible);
+  node()->markCacheDirty(CachingEffect::Dirty_Style);
 }
 
 void NodeHeader::addHeaderButton(QString name, QStringList icons, int state)
@@ -174,6 +178,7 @@ void NodeHeader::setHeaderButtonState(QString name, int state)
     if(m_buttons[i]->name() == name)
       m_buttons[i]->setState(state);
   }
+  node()->markCacheDirty(CachingEffect::Dirty_Style);
 }
 
 void NodeHeader::onHeaderButtonTriggered(FabricUI::GraphView::NodeHeaderButton * button)
@@ -181,6 +181,9 @@ void NodeHeaderButton::mouseReleaseEvent(QGraphicsSceneMouseEvent * event)
 
 void NodeHeaderButton::paint(QPainter * painter, const QStyleOptionGraphicsItem * option, QWidget * widget)
 {
+  if(m_nodeHeader->graph()->mainPanel()->lodTier() >= MainPanel::LODTier_NoDetails)
+    return;
+
 #ifdef FABRICUI_TIMERS
   Util::TimerPtr timer = Util::Timer::getTimer("FabricUI::NodeHeaderButton");
   timer->resume();
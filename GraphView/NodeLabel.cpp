@@ -23,4 +23,10 @@ NodeLabel::NodeLabel(
     font
     )
 {
+  m_header = parent;
+}
+
+bool NodeLabel::shouldPaintText() const
+{
+  return m_header->graph()->mainPanel()->lodTier() < MainPanel::LODTier_Dots;
 }
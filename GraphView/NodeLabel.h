@@ -27,6 +27,12 @@ namespace FabricUI
         QFont font
         );
 
+      virtual bool shouldPaintText() const;
+
+    private:
+
+      NodeHeader * m_header;
+
     };
 
   };
@@ -0,0 +1,128 @@
+// Copyright 2010-2015 Fabric Software Inc. All rights reserved.
+
+#include <FabricUI/GraphView/NodePixmapCache.h>
+
+#include <math.h>
+
+using namespace FabricUI::GraphView;
+
+NodePixmapCache::NodePixmapCache(size_t budget)
+{
+  m_budget = budget;
+  m_usedBytes = 0;
+  m_variant = 0;
+  m_hits = 0;
+  m_misses = 0;
+  m_evictions = 0;
+}
+
+void NodePixmapCache::setBudget(size_t budget)
+{
+  m_budget = budget;
+  evict(m_lru.end());
+}
+
+int NodePixmapCache::Bucket(float scale)
+{
+  if(scale <= 0.0f)
+    return s_minBucket;
+  // scale = mantissa * 2^exponent with mantissa in [0.5, 1)
+  int exponent = 0;
+  double mantissa = frexp(double(scale), &exponent);
+  int bucket = mantissa > 0.5 ? exponent : exponent - 1;
+  if(bucket < s_minBucket)
+    bucket = s_minBucket;
+  return bucket;
+}
+
+float NodePixmapCache::BucketScale(int bucket)
+{
+  return float(ldexp(1.0, bucket));
+}
+
+NodePixmapCache::Entry const * NodePixmapCache::find(void const * owner, int bucket)
+{
+  SlotMap::iterator it = m_entries.find(Key(owner, bucket, m_variant));
+  if(it == m_entries.end())
+  {
+    m_misses++;
+    return NULL;
+  }
+  m_hits++;
+  m_lru.splice(m_lru.begin(), m_lru, it->second);
+  return &it->second->entry;
+}
+
+NodePixmapCache::Entry const * NodePixmapCache::insert(
+  void const * owner,
+  int bucket,
+  QPixmap const & pixmap,
+  QPointF offset,
+  float scale
+  )
+{
+  Key key(owner, bucket, m_variant);
+  SlotMap::iterator it = m_entries.find(key);
+  if(it != m_entries.end())
+    erase(it);
+
+  m_lru.push_front(Slot(key));
+  SlotList::iterator slot = m_lru.begin();
+  slot->entry.pixmap = pixmap;
+  slot->entry.offset = offset;
+  slot->entry.scale = scale;
+  slot->bytes = BytesOf(pixmap);
+  m_usedBytes += slot->bytes;
+  m_entries.insert(std::make_pair(key, slot));
+
+  // the new entry is kept even if it exceeds the budget on its own,
+  // it is about to be drawn
+  evict(slot);
+  return &slot->entry;
+}
+
+void NodePixmapCache::invalidate(void const * owner)
+{
+  SlotMap::iterator it = m_entries.lower_bound(Key(owner, s_minBucket - 1, -0x7fffffff));
+  while(it != m_entries.end() && it->first.owner == owner)
+    erase(it++);
+}
+
+void NodePixmapCache::clear()
+{
+  m_entries.clear();
+  m_lru.clear();
+  m_usedBytes = 0;
+}
+
+void NodePixmapCache::resetCounters()
+{
+  m_hits = 0;
+  m_misses = 0;
+  m_evictions = 0;
+}
+
+size_t NodePixmapCache::BytesOf(QPixmap const & pixmap)
+{
+  return size_t(pixmap.width()) * size_t(pixmap.height()) * size_t(pixmap.depth() / 8);
+}
+
+void NodePixmapCache::evict(SlotList::iterator keep)
+{
+  while(m_usedBytes > m_budget && m_lru.size() > 0)
+  {
+    SlotList::iterator last = m_lru.end();
+    --last;
+    if(last == keep)
+      break;
+    erase(m_entries.find(last->key));
+    m_evictions++;
+  }
+}
+
+void NodePixmapCache::erase(SlotMap::iterator it)
+{
+  m_usedBytes -= it->second->bytes;
+  m_lru.erase(it->second);
+  m_entries.erase(it);
+}
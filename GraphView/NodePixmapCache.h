@@ -0,0 +1,130 @@
+// Copyright 2010-2015 Fabric Software Inc. All rights reserved.
+
+#ifndef __UI_GraphView_NodePixmapCache__
+#define __UI_GraphView_NodePixmapCache__
+
+#include <QtGui/QPixmap>
+#include <QtCore/QPointF>
+
+#include <list>
+#include <map>
+
+namespace FabricUI
+{
+
+  namespace GraphView
+  {
+
+    // Pixmaps of rendered nodes, one per owner and power-of-two scale
+    // bucket, shared by all the nodes of a graph under a byte budget.  The
+    // least recently drawn pixmaps are evicted first.  Entries are only
+    // dropped explicitly by their owner, moving or zooming does not
+    // invalidate them.
+    class NodePixmapCache
+    {
+    public:
+
+      struct Entry
+      {
+        QPixmap pixmap;
+        // logical position of the pixmap's top left corner
+        QPointF offset;
+        // pixels per logical unit
+        float scale;
+      };
+
+      // the smallest bucket is 1/32, below that pixmaps are scaled down
+      static const int s_minBucket = -5;
+
+      NodePixmapCache(size_t budget = 64 * 1024 * 1024);
+      ~NodePixmapCache() {}
+
+      size_t budget() const { return m_budget; }
+      void setBudget(size_t budget);
+      size_t usedBytes() const { return m_usedBytes; }
+      size_t entryCount() const { return m_entries.size(); }
+
+      // the entries are also keyed by a variant, eg. the level of detail
+      // the pixmaps were drawn at
+      int variant() const { return m_variant; }
+      void setVariant(int variant) { m_variant = variant; }
+
+      // the bucket whose scale is the smallest power of two greater or
+      // equal to scale, clamped to s_minBucket
+      static int Bucket(float scale);
+      static float BucketScale(int bucket);
+
+      // returns NULL on a miss, a hit becomes the most recent entry
+      Entry const * find(void const * owner, int bucket);
+      Entry const * insert(
+        void const * owner,
+        int bucket,
+        QPixmap const & pixmap,
+        QPointF offset,
+        float scale
+        );
+      void invalidate(void const * owner);
+      void clear();
+
+      size_t hits() const { return m_hits; }
+      size_t misses() const { return m_misses; }
+      size_t evictions() const { return m_evictions; }
+      void resetCounters();
+
+    private:
+
+      struct Key
+      {
+        void const * owner;
+        int bucket;
+        int variant;
+
+        Key(void const * owner, int bucket, int variant)
+        {
+          this->owner = owner;
+          this->bucket = bucket;
+          this->variant = variant;
+        }
+
+        bool operator < (const Key & other) const
+        {
+          if(owner != other.owner)
+            return owner < other.owner;
+          if(bucket != other.bucket)
+            return bucket < other.bucket;
+          return variant < other.variant;
+        }
+      };
+
+      struct Slot
+      {
+        Key key;
+        Entry entry;
+        size_t bytes;
+
+        Slot(Key const & key) : key(key), bytes(0) {}
+      };
+
+      typedef std::list<Slot> SlotList;
+      typedef std::map<Key, SlotList::iterator> SlotMap;
+
+      static size_t BytesOf(QPixmap const & pixmap);
+      void evict(SlotList::iterator keep);
+      void erase(SlotMap::iterator it);
+
+      size_t m_budget;
+      size_t m_usedBytes;
+      int m_variant;
+      // most recently used first
+      SlotList m_lru;
+      SlotMap m_entries;
+      size_t m_hits;
+      size_t m_misses;
+      size_t m_evictions;
+    };
+
+  };
+
+};
+
+#endif // __UI_GraphView_NodePixmapCache__
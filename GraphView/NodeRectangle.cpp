@@ -10,6 +10,8 @@
 #include <QtGui/QStyleOptionGraphicsItem>
 #include <QtCore/QDebug>
 
+#include <algorithm>
+
 #ifdef FABRICUI_TIMERS
   #include <Util/Timer.h>
 #endif
@@ -40,6 +42,36 @@ void NodeRectangle::paint(QPainter * painter, const QStyleOptionGraphicsItem * o
   float nodeWidthReduction = m_node->graph()->config().nodeWidthReduction * 0.5;
   rect.adjust(nodeWidthReduction, standardPen.width() * 0.5f, -nodeWidthReduction, -standardPen.width() * 0.5f);
 
+  MainPanel::LODTier lodTier = m_node->graph()->mainPanel()->lodTier();
+  if(lodTier == MainPanel::LODTier_Dots && !m_node->isBackDropNode())
+  {
+    // a dot centered on the node, so it stays visible when zoomed out
+    float radius = 0.5f * std::min(rect.width(), rect.height());
+    painter->setPen(standardPen);
+    painter->setBrush(m_node->m_colorA);
+    painter->drawEllipse(rect.center(), radius, radius);
+#ifdef FABRICUI_TIMERS
+    timer->pause();
+#endif
+    QGraphicsWidget::paint(painter, option, widget);
+    return;
+  }
+  if(lodTier >= MainPanel::LODTier_Flat)
+  {
+    // flat fills without gradient, rounded corners or clipping
+    QRectF labelRect(rect.left(), rect.top(), rect.width(), m_node->m_header->size().height());
+    painter->fillRect(rect, m_node->m_colorA);
+    painter->fillRect(labelRect, m_node->m_titleColor);
+    painter->setPen(standardPen);
+    painter->setBrush(Qt::NoBrush);
+    painter->drawRect(rect);
+#ifdef FABRICUI_TIMERS
+    timer->pause();
+#endif
+    QGraphicsWidget::paint(painter, option, widget);
+    return;
+  }
+
   QLinearGradient gradient(0.5, 0.0, 0.5, 1.0);
   gradient.setCoordinateMode(QGradient::ObjectBoundingMode);
   gradient.setColorAt(0.0, m_node->m_colorA);
@@ -0,0 +1,117 @@
+// Copyright 2010-2015 Fabric Software Inc. All rights reserved.
+
+#include <FabricUI/GraphView/NodeRegistry.h>
+
+using namespace FabricUI::GraphView;
+
+NodeRegistry::NodeRegistry()
+  : m_first( NoSlot )
+  , m_last( NoSlot )
+  , m_free( NoSlot )
+{
+}
+
+void NodeRegistry::reserve( size_t count )
+{
+  m_slots.reserve( count );
+  m_names.reserve( count );
+}
+
+NodeRegistry::Handle NodeRegistry::insert( FTL::StrRef name, Node *node )
+{
+  uint32_t slotIndex = m_free;
+  if ( slotIndex != NoSlot )
+    m_free = m_slots[slotIndex].next;
+  else
+  {
+    slotIndex = uint32_t( m_slots.size() );
+    Slot slot;
+    slot.node = 0;
+    slot.generation = 0;
+    m_slots.push_back( slot );
+  }
+
+  if ( !m_names.insert( name, slotIndex ) )
+  {
+    m_slots[slotIndex].next = m_free;
+    m_free = slotIndex;
+    return Handle();
+  }
+
+  Slot &slot = m_slots[slotIndex];
+  slot.node = node;
+  slot.prev = m_last;
+  slot.next = NoSlot;
+  if ( m_last != NoSlot )
+    m_slots[m_last].next = slotIndex;
+  else
+    m_first = slotIndex;
+  m_last = slotIndex;
+
+  Handle handle;
+  handle.slot = slotIndex;
+  handle.generation = slot.generation;
+  return handle;
+}
+
+Node *NodeRegistry::erase( FTL::StrRef name )
+{
+  size_t const *slotIndexPtr = m_names.find( name );
+  if ( !slotIndexPtr )
+    return 0;
+  uint32_t slotIndex = uint32_t( *slotIndexPtr );
+  m_names.erase( name );
+
+  Slot &slot = m_slots[slotIndex];
+  if ( slot.prev != NoSlot )
+    m_slots[slot.prev].next = slot.next;
+  else
+    m_first = slot.next;
+  if ( slot.next != NoSlot )
+    m_slots[slot.next].prev = slot.prev;
+  else
+    m_last = slot.prev;
+
+  Node *node = slot.node;
+  slot.node = 0;
+  ++slot.generation;
+  slot.next = m_free;
+  m_free = slotIndex;
+  return node;
+}
+
+Node *NodeRegistry::rename( FTL::StrRef oldName, FTL::StrRef newName )
+{
+  size_t const *slotIndexPtr = m_names.find( oldName );
+  if ( !slotIndexPtr )
+    return 0;
+  size_t slotIndex = *slotIndexPtr;
+  if ( oldName == newName )
+    return m_slots[slotIndex].node;
+  if ( !m_names.insert( newName, slotIndex ) )
+    return 0;
+  m_names.erase( oldName );
+  return m_slots[slotIndex].node;
+}
+
+NodeRegistry::Handle NodeRegistry::find( FTL::StrRef name ) const
+{
+  Handle handle;
+  size_t const *slotIndexPtr = m_names.find( name );
+  if ( slotIndexPtr )
+  {
+    handle.slot = uint32_t( *slotIndexPtr );
+    handle.generation = m_slots[handle.slot].generation;
+  }
+  return handle;
+}
+
+Node *NodeRegistry::get( Handle handle ) const
+{
+  if ( handle.slot >= m_slots.size() )
+    return 0;
+  Slot const &slot = m_slots[handle.slot];
+  if ( slot.generation != handle.generation )
+    return 0;
+  return slot.node;
+}
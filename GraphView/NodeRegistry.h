@@ -0,0 +1,111 @@
+// Copyright 2010-2015 Fabric Software Inc. All rights reserved.
+
+#ifndef __UI_GraphView_NodeRegistry__
+#define __UI_GraphView_NodeRegistry__
+
+#include <FabricUI/GraphView/NameIndex.h>
+
+#include <stdint.h>
+#include <vector>
+
+namespace FabricUI
+{
+
+  namespace GraphView
+  {
+    // forward declarations
+    class Node;
+
+    // Stores the nodes of a graph in a slot map.  Each node gets a handle
+    // made of its slot and of the slot's generation, so a handle to a
+    // removed node never resolves to a node added later in the same
+    // slot.  Nodes are also indexed by name.  Adding, removing, looking
+    // up and renaming are O(1); iteration follows the insertion order.
+    class NodeRegistry
+    {
+    public:
+
+      struct Handle
+      {
+        uint32_t slot;
+        uint32_t generation;
+
+        Handle() : slot( uint32_t( -1 ) ), generation( 0 ) {}
+        bool isValid() const
+          { return slot != uint32_t( -1 ); }
+      };
+
+      class const_iterator
+      {
+      public:
+
+        Node *operator*() const
+          { return m_registry->m_slots[m_slot].node; }
+        const_iterator &operator++()
+          { m_slot = m_registry->m_slots[m_slot].next; return *this; }
+        bool operator==( const_iterator const &other ) const
+          { return m_slot == other.m_slot; }
+        bool operator!=( const_iterator const &other ) const
+          { return m_slot != other.m_slot; }
+
+      private:
+
+        friend class NodeRegistry;
+
+        const_iterator( NodeRegistry const *registry, uint32_t slot )
+          : m_registry( registry ), m_slot( slot ) {}
+
+        NodeRegistry const *m_registry;
+        uint32_t m_slot;
+      };
+
+      NodeRegistry();
+
+      size_t size() const
+        { return m_names.size(); }
+      bool empty() const
+        { return m_names.empty(); }
+      void reserve( size_t count );
+
+      const_iterator begin() const
+        { return const_iterator( this, m_first ); }
+      const_iterator end() const
+        { return const_iterator( this, NoSlot ); }
+
+      // returns an invalid handle if the name is already taken
+      Handle insert( FTL::StrRef name, Node *node );
+      // returns the removed node, or NULL if there is no such node
+      Node *erase( FTL::StrRef name );
+      // the node keeps its handle; returns NULL if there is no node
+      // named oldName or if newName is already taken
+      Node *rename( FTL::StrRef oldName, FTL::StrRef newName );
+
+      Handle find( FTL::StrRef name ) const;
+      // returns NULL if the handle is stale
+      Node *get( Handle handle ) const;
+
+    private:
+
+      enum { NoSlot = 0xFFFFFFFFu };
+
+      struct Slot
+      {
+        Node *node;
+        uint32_t generation;
+        // insertion order list while used, free list otherwise
+        uint32_t prev;
+        uint32_t next;
+      };
+
+      std::vector<Slot> m_slots;
+      NameIndex m_names;
+      uint32_t m_first;
+      uint32_t m_last;
+      uint32_t m_free;
+    };
+
+  };
+
+};
+
+#endif // __UI_GraphView_NodeRegistry__
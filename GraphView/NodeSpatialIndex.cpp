@@ -0,0 +1,250 @@
+// Copyright 2010-2015 Fabric Software Inc. All rights reserved.
+
+#include <FabricUI/GraphView/NodeSpatialIndex.h>
+#include <FabricUI/GraphView/Node.h>
+
+#include <algorithm>
+#include <math.h>
+
+using namespace FabricUI::GraphView;
+
+NodeSpatialIndex::NodeSpatialIndex(float cellSize)
+{
+  m_cellSize = cellSize > 0.0f ? cellSize : 256.0f;
+  m_count = 0;
+  m_stamp = 0;
+}
+
+void NodeSpatialIndex::insert(Node * node)
+{
+  Entry & entry = node->m_spatialEntry;
+  if(entry.indexed)
+    return;
+  entry.indexed = true;
+  entry.x0 = entry.y0 = 0;
+  entry.x1 = entry.y1 = -1;
+  entry.dirtyIndex = -1;
+  m_count++;
+  markDirty(node);
+}
+
+void NodeSpatialIndex::remove(Node * node)
+{
+  Entry & entry = node->m_spatialEntry;
+  if(!entry.indexed)
+    return;
+
+  if(entry.dirtyIndex >= 0)
+  {
+    Node * last = m_dirty.back();
+    m_dirty[entry.dirtyIndex] = last;
+    last->m_spatialEntry.dirtyIndex = entry.dirtyIndex;
+    m_dirty.pop_back();
+    entry.dirtyIndex = -1;
+  }
+
+  removeFromCells(node, entry);
+  entry.indexed = false;
+  m_count--;
+}
+
+void NodeSpatialIndex::markDirty(Node * node)
+{
+  Entry & entry = node->m_spatialEntry;
+  if(!entry.indexed || entry.dirtyIndex >= 0)
+    return;
+  entry.dirtyIndex = int(m_dirty.size());
+  m_dirty.push_back(node);
+}
+
+void NodeSpatialIndex::clear()
+{
+  for(CellMap::iterator it = m_cells.begin(); it != m_cells.end(); it++)
+  {
+    std::vector<Node *> & cell = it->second;
+    for(size_t i=0;i<cell.size();i++)
+      cell[i]->m_spatialEntry = Entry();
+  }
+  for(size_t i=0;i<m_dirty.size();i++)
+    m_dirty[i]->m_spatialEntry = Entry();
+  m_cells.clear();
+  m_dirty.clear();
+  m_count = 0;
+}
+
+QRectF NodeSpatialIndex::bounds(const Node * node)
+{
+  const Entry & entry = node->m_spatialEntry;
+  if(!entry.indexed)
+    return node->mapRectToParent(node->boundingRect());
+  update();
+  return entry.rect;
+}
+
+QRectF NodeSpatialIndex::bounds()
+{
+  update();
+  m_stamp++;
+
+  QRectF result;
+  for(CellMap::iterator it = m_cells.begin(); it != m_cells.end(); it++)
+  {
+    std::vector<Node *> & cell = it->second;
+    for(size_t i=0;i<cell.size();i++)
+    {
+      Entry & entry = cell[i]->m_spatialEntry;
+      if(entry.stamp == m_stamp)
+        continue;
+      entry.stamp = m_stamp;
+      result = result.united(entry.rect);
+    }
+  }
+  return result;
+}
+
+void NodeSpatialIndex::intersecting(QRectF rect, std::vector<Node *> & nodes)
+{
+  query(rect, QueryMode_Intersecting, nodes);
+}
+
+void NodeSpatialIndex::contained(QRectF rect, std::vector<Node *> & nodes)
+{
+  query(rect, QueryMode_Contained, nodes);
+}
+
+void NodeSpatialIndex::at(QPointF pos, std::vector<Node *> & nodes)
+{
+  update();
+  int x = int(floorf(float(pos.x()) / m_cellSize));
+  int y = int(floorf(float(pos.y()) / m_cellSize));
+  CellMap::iterator it = m_cells.find(CellKey(x, y));
+  if(it == m_cells.end())
+    return;
+
+  // a point lies in a single cell, so there is nothing to deduplicate
+  std::vector<Node *> & cell = it->second;
+  for(size_t i=0;i<cell.size();i++)
+  {
+    if(cell[i]->m_spatialEntry.rect.contains(pos))
+      nodes.push_back(cell[i]);
+  }
+}
+
+void NodeSpatialIndex::update()
+{
+  for(size_t i=0;i<m_dirty.size();i++)
+  {
+    Node * node = m_dirty[i];
+    Entry & entry = node->m_spatialEntry;
+    entry.dirtyIndex = -1;
+    entry.rect = node->mapRectToParent(node->boundingRect());
+
+    int x0, y0, x1, y1;
+    cellRange(entry.rect, x0, y0, x1, y1);
+    if(x0 == entry.x0 && y0 == entry.y0 && x1 == entry.x1 && y1 == entry.y1)
+      continue;
+
+    removeFromCells(node, entry);
+    entry.x0 = x0;
+    entry.y0 = y0;
+    entry.x1 = x1;
+    entry.y1 = y1;
+    addToCells(node, entry);
+  }
+  m_dirty.clear();
+}
+
+void NodeSpatialIndex::query(QRectF rect, QueryMode mode, std::vector<Node *> & nodes)
+{
+  update();
+  m_stamp++;
+
+  int x0, y0, x1, y1;
+  cellRange(rect, x0, y0, x1, y1);
+
+  // a large rectangle (eg. a rubber band when zoomed out) covers mostly
+  // empty cells, walking the occupied ones is cheaper then.
+  double rangeCells = double(x1 - x0 + 1) * double(y1 - y0 + 1);
+  if(rangeCells > double(m_cells.size()))
+  {
+    for(CellMap::iterator it = m_cells.begin(); it != m_cells.end(); it++)
+    {
+      CellKey const & key = it->first;
+      if(key.first < x0 || key.first > x1 || key.second < y0 || key.second > y1)
+        continue;
+      std::vector<Node *> & cell = it->second;
+      for(size_t i=0;i<cell.size();i++)
+      {
+        if(accept(cell[i], rect, mode))
+          nodes.push_back(cell[i]);
+      }
+    }
+    return;
+  }
+
+  for(int y=y0;y<=y1;y++)
+  {
+    for(int x=x0;x<=x1;x++)
+    {
+      CellMap::iterator it = m_cells.find(CellKey(x, y));
+      if(it == m_cells.end())
+        continue;
+      std::vector<Node *> & cell = it->second;
+      for(size_t i=0;i<cell.size();i++)
+      {
+        if(accept(cell[i], rect, mode))
+          nodes.push_back(cell[i]);
+      }
+    }
+  }
+}
+
+void NodeSpatialIndex::cellRange(QRectF rect, int & x0, int & y0, int & x1, int & y1) const
+{
+  rect = rect.normalized();
+  x0 = int(floorf(float(rect.left()) / m_cellSize));
+  y0 = int(floorf(float(rect.top()) / m_cellSize));
+  x1 = int(floorf(float(rect.right()) / m_cellSize));
+  y1 = int(floorf(float(rect.bottom()) / m_cellSize));
+}
+
+void NodeSpatialIndex::addToCells(Node * node, Entry & entry)
+{
+  for(int y=entry.y0;y<=entry.y1;y++)
+  {
+    for(int x=entry.x0;x<=entry.x1;x++)
+      m_cells[CellKey(x, y)].push_back(node);
+  }
+}
+
+void NodeSpatialIndex::removeFromCells(Node * node, Entry & entry)
+{
+  for(int y=entry.y0;y<=entry.y1;y++)
+  {
+    for(int x=entry.x0;x<=entry.x1;x++)
+    {
+      CellMap::iterator it = m_cells.find(CellKey(x, y));
+      if(it == m_cells.end())
+        continue;
+      std::vector<Node *> & cell = it->second;
+      std::vector<Node *>::iterator jt = std::find(cell.begin(), cell.end(), node);
+      if(jt != cell.end())
+        cell.erase(jt);
+      if(cell.size() == 0)
+        m_cells.erase(it);
+    }
+  }
+  entry.x0 = entry.y0 = 0;
+  entry.x1 = entry.y1 = -1;
+}
+
+bool NodeSpatialIndex::accept(Node * node, QRectF const & rect, QueryMode mode)
+{
+  Entry & entry = node->m_spatialEntry;
+  if(entry.stamp == m_stamp)
+    return false;
+  entry.stamp = m_stamp;
+  if(mode == QueryMode_Contained)
+    return rect.contains(entry.rect);
+  return rect.intersects(entry.rect);
+}
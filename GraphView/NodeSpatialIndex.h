@@ -0,0 +1,95 @@
+// Copyright 2010-2015 Fabric Software Inc. All rights reserved.
+
+#ifndef __UI_GraphView_NodeSpatialIndex__
+#define __UI_GraphView_NodeSpatialIndex__
+
+#include <QtCore/QRectF>
+#include <QtCore/QPointF>
+
+#include <map>
+#include <vector>
+
+namespace FabricUI
+{
+
+  namespace GraphView
+  {
+
+    // forward declarations
+    class Node;
+
+    // A uniform grid over the graph coordinates (the coordinate system of
+    // the graph's item group) holding the bounds of every node.  Moving,
+    // resizing or collapsing a node only marks it dirty, the grid is brought
+    // up to date lazily by the next query.
+    class NodeSpatialIndex
+    {
+    public:
+
+      // per node bookkeeping, stored on the node itself
+      struct Entry
+      {
+        Entry()
+          : x0(0), y0(0), x1(-1), y1(-1)
+          , stamp(0), dirtyIndex(-1), indexed(false)
+          {}
+
+        QRectF rect;
+        // the inclusive range of cells covering rect
+        int x0, y0, x1, y1;
+        unsigned stamp;
+        int dirtyIndex;
+        bool indexed;
+      };
+
+      NodeSpatialIndex(float cellSize = 256.0f);
+
+      void insert(Node * node);
+      void remove(Node * node);
+      void markDirty(Node * node);
+      void clear();
+
+      size_t size() const { return m_count; }
+
+      // the bounds of a single node in graph coordinates
+      QRectF bounds(const Node * node);
+      // the united bounds of all nodes
+      QRectF bounds();
+
+      // appends the nodes whose bounds intersect rect
+      void intersecting(QRectF rect, std::vector<Node *> & nodes);
+      // appends the nodes whose bounds are contained in rect
+      void contained(QRectF rect, std::vector<Node *> & nodes);
+      // appends the nodes whose bounds contain pos
+      void at(QPointF pos, std::vector<Node *> & nodes);
+
+    private:
+
+      typedef std::pair<int, int> CellKey;
+      typedef std::map<CellKey, std::vector<Node *> > CellMap;
+
+      enum QueryMode
+      {
+        QueryMode_Intersecting,
+        QueryMode_Contained
+      };
+
+      void update();
+      void query(QRectF rect, QueryMode mode, std::vector<Node *> & nodes);
+      void cellRange(QRectF rect, int & x0, int & y0, int & x1, int & y1) const;
+      void addToCells(Node * node, Entry & entry);
+      void removeFromCells(Node * node, Entry & entry);
+      bool accept(Node * node, QRectF const & rect, QueryMode mode);
+
+      float m_cellSize;
+      CellMap m_cells;
+      std::vector<Node *> m_dirty;
+      size_t m_count;
+      unsigned m_stamp;
+    };
+
+  };
+
+};
+
+#endif // __UI_GraphView_NodeSpatialIndex__
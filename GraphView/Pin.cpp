@@ -139,6 +139,7 @@ void Pin::setColor(QColor color, bool quiet, bool performUpdate)
     if(!quiet)
       emit colorChanged(this, color);
   }
+  node()->markCacheDirty(CachingEffect::Dirty_Pins);
   if(performUpdate)
     update();
 }
@@ -178,19 +179,15 @@ void Pin::setDataType(FTL::CStrRef dataType)
   // automatically change the label for array pins
   if(m_label)
   {
-    if(m_dataType.length() > 2)
+    std::string labelSuffix;
+    if(m_dataType.length() > 2 && m_dataType.substr(m_dataType.length()-2) == "[]")
+      labelSuffix = "[]";
+    if(labelSuffix != m_labelSuffix)
     {
-      if(m_dataType.substr(m_dataType.length()-2) == "[]" && m_labelSuffix != "[]")
-      {
-        m_labelSuffix = "[]";
-        m_label->setText(QSTRING_FROM_STL_UTF8(m_labelCaption + m_labelSuffix));
-        return;
-      }
-    }
-    if(m_labelSuffix.length() > 0)
-    {
-      m_labelSuffix = "";
+      m_labelSuffix = labelSuffix;
       m_label->setText(QSTRING_FROM_STL_UTF8(m_labelCaption + m_labelSuffix));
+      // the label is drawn into the node's cached pixmap
+      node()->markCacheDirty(CachingEffect::Dirty_Pins);
     }
   }
 }
@@ -294,6 +291,13 @@ QPointF Pin::connectionPos(PortType pType) const
   return QPointF();
 }
 
+QVariant Pin::itemChange(GraphicsItemChange change, const QVariant & value)
+{
+  if(change == ItemPositionHasChanged || change == ItemVisibleHasChanged)
+    graph()->markConnectionsDirty(this);
+  return ConnectionTarget::itemChange(change, value);
+}
+
 void Pin::setDrawState(bool flag)
 {
   m_drawState = flag;
@@ -310,6 +314,7 @@ void Pin::setDrawState(bool flag)
     setSizePolicy(QSizePolicy(QSizePolicy::Expanding, QSizePolicy::Fixed));
   }
 
+  node()->markCacheDirty(CachingEffect::Dirty_Pins);
   update();
 }
 
@@ -324,5 +329,6 @@ void Pin::setDaisyChainCircleVisible(bool flag)
   {
     m_outCircle->setVisible(flag);
     m_outCircle->setShouldBeVisible(flag);
+    node()->markCacheDirty(CachingEffect::Dirty_Pins);
   }
 }
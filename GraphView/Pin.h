@@ -83,6 +83,10 @@ namespace FabricUI
 
       void colorChanged(Pin*, QColor);
 
+    protected:
+
+      virtual QVariant itemChange(GraphicsItemChange change, const QVariant & value);
+
     private:
 
       Node * m_node;
@@ -11,6 +11,32 @@
 
 using namespace FabricUI::GraphView;
 
+class PinCircleEllipse : public QGraphicsEllipseItem
+{
+public:
+
+  PinCircleEllipse(PinCircle * circle)
+  : QGraphicsEllipseItem(circle)
+  {
+    m_circle = circle;
+  }
+
+  virtual void paint(QPainter * painter, const QStyleOptionGraphicsItem * option, QWidget * widget)
+  {
+    // the circles of the side panel ports are not scaled by the canvas
+    ConnectionTarget * target = m_circle->target();
+    TargetType targetType = target->targetType();
+    if((targetType == TargetType_Pin || targetType == TargetType_NodeHeader)
+      && target->graph()->mainPanel()->lodTier() >= MainPanel::LODTier_Flat)
+      return;
+    QGraphicsEllipseItem::paint(painter, option, widget);
+  }
+
+private:
+
+  PinCircle * m_circle;
+};
+
 PinCircle::PinCircle(ConnectionTarget * parent, PortType portType, QColor color, bool interactiveConnectionsAllowed)
 : QGraphicsWidget(parent)
 {
@@ -29,7 +55,7 @@ PinCircle::PinCircle(ConnectionTarget * parent, PortType portType, QColor color,
   m_hoverPen = m_target->graph()->config().pinHoverPen;
   setAcceptHoverEvents(true);
 
-  m_ellipse = new QGraphicsEllipseItem(this);
+  m_ellipse = new PinCircleEllipse(this);
   m_ellipse->setPos(radius(), radius());
   m_ellipse->setRect(-radius(), -radius(), diameter(), diameter());
 
@@ -96,6 +122,12 @@ void PinCircle::setHighlighted(bool state)
     return;
   m_highlighted = state;
   setColor(m_color);
+
+  // the hovered circle is part of the node's cached pixmap
+  if(m_target->targetType() == TargetType_Pin)
+    ((Pin*)m_target)->node()->markCacheDirty(CachingEffect::Dirty_Pins);
+  else if(m_target->targetType() == TargetType_NodeHeader)
+    ((NodeHeader*)m_target)->node()->markCacheDirty(CachingEffect::Dirty_Style);
 }
 
 QPen PinCircle::defaultPen() const
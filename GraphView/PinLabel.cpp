@@ -10,4 +10,10 @@ using namespace FabricUI::GraphView;
 PinLabel::PinLabel(Pin * parent, QString text, QColor color, QColor highlightColor, QFont font)
 : TextContainer(parent, text, color, highlightColor, font)
 {
+  m_pin = parent;
+}
+
+bool PinLabel::shouldPaintText() const
+{
+  return m_pin->graph()->mainPanel()->lodTier() < MainPanel::LODTier_NoDetails;
 }
@@ -21,6 +21,12 @@ namespace FabricUI
 
       PinLabel(Pin * parent, QString text, QColor color, QColor highlightColor, QFont font);
 
+      virtual bool shouldPaintText() const;
+
+    private:
+
+      Pin * m_pin;
+
     };
 
   };
@@ -99,6 +99,8 @@ const PinCircle * Port::circle() const
 void Port::setName( FTL::CStrRef name )
 {
   bool labelUsesName = m_name == m_labelCaption;
+  if(m_sidePanel)
+    m_sidePanel->renamePort(m_name, name);
   m_name = name;
   if(labelUsesName)
     setLabel(name.c_str());
@@ -72,13 +72,8 @@ PortType SidePanel::portType() const
 
 Port * SidePanel::addPort(Port * port)
 {
-  // std::vector<Port*> ports = graph()->ports();
-  std::vector<Port*> ports = m_ports;
-  for(size_t i=0;i<ports.size();i++)
-  {
-    if(ports[i]->name() == port->name())
-      return NULL;
-  }
+  if(!m_portNames.insert(port->name(), m_ports.size()))
+    return NULL;
 
   port->setIndex(m_ports.size());
   m_ports.push_back(port);
@@ -91,22 +86,19 @@ Port * SidePanel::addPort(Port * port)
 
 bool SidePanel::removePort(Port * port)
 {
-  size_t index = m_ports.size();
-  for(size_t i=0;i<m_ports.size();i++)
-  {
-    if(m_ports[i] == port)
-    {
-      index = i;
-      break;
-    }
-  }
-  if(index == m_ports.size())
+  size_t const *indexPtr = m_portNames.find(port->name());
+  if(!indexPtr || m_ports[*indexPtr] != port)
     return false;
 
+  size_t index = *indexPtr;
+  m_portNames.erase(port->name());
   m_ports.erase(m_ports.begin() + index);
 
-  for(size_t i=0;i<m_ports.size();i++)
+  for(size_t i=index;i<m_ports.size();i++)
+  {
     m_ports[i]->setIndex(i);
+    *m_portNames.find(m_ports[i]->name()) = i;
+  }
 
   scene()->removeItem(port);
   delete(port);
@@ -127,6 +119,10 @@ void SidePanel::reorderPorts(QStringList names)
   }
 
   m_ports = ports;
+  m_portNames.clear();
+  m_portNames.reserve(m_ports.size());
+  for(size_t i=0;i<m_ports.size();i++)
+    m_portNames.insert(m_ports[i]->name(), i);
   resetLayout();
 }
 
@@ -142,14 +138,22 @@ Port * SidePanel::port(unsigned int index)
 
 Port * SidePanel::port(FTL::StrRef name)
 {
-  for(size_t i=0;i<m_ports.size();i++)
-  {
-    if(m_ports[i]->name() == name)
-      return m_ports[i];
-  }
+  size_t const *index = m_portNames.find(name);
+  if(index)
+    return m_ports[*index];
   return NULL;
 }
 
+void SidePanel::renamePort(FTL::StrRef oldName, FTL::StrRef newName)
+{
+  size_t const *index = m_portNames.find(oldName);
+  if(!index)
+    return;
+  size_t value = *index;
+  m_portNames.erase(oldName);
+  m_portNames.insert(newName, value);
+}
+
 void SidePanel::mousePressEvent(QGraphicsSceneMouseEvent * event)
 {
   if(event->button() == Qt::RightButton)
@@ -216,6 +220,7 @@ void SidePanel::paint(QPainter * painter, const QStyleOptionGraphicsItem * optio
     {
       emit m_ports[i]->positionChanged();
     }
+    m_graph->markSidePanelConnectionsDirty(this);
     m_requiresToSendSignalsForPorts = false;
   }
 }
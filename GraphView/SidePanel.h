@@ -10,6 +10,7 @@
 #include "Port.h"
 #include "ProxyPort.h"
 #include "SidePanelItemGroup.h"
+#include "NameIndex.h"
 
 namespace FabricUI
 {
@@ -25,6 +26,7 @@ namespace FabricUI
 
       friend class Graph;
       friend class MainPanel;
+      friend class Port;
 
     public:
 
@@ -71,6 +73,8 @@ namespace FabricUI
     private:
 
       void resetLayout();
+      // called by Port::setName
+      void renamePort(FTL::StrRef oldName, FTL::StrRef newName);
 
       Graph * m_graph;
       QColor m_color;
@@ -82,6 +86,8 @@ namespace FabricUI
 
       ProxyPort* m_proxyPort;
       std::vector<Port*> m_ports;
+      // port name to position in m_ports
+      NameIndex m_portNames;
     };
 
   };
@@ -6,6 +6,28 @@
 
 using namespace FabricUI::GraphView;
 
+class TextContainerTextItem : public QGraphicsSimpleTextItem
+{
+public:
+
+  TextContainerTextItem(QString const &text, TextContainer * container)
+  : QGraphicsSimpleTextItem(text, container)
+  {
+    m_container = container;
+  }
+
+  virtual void paint(QPainter * painter, const QStyleOptionGraphicsItem * option, QWidget * widget)
+  {
+    if(!m_container->shouldPaintText())
+      return;
+    QGraphicsSimpleTextItem::paint(painter, option, widget);
+  }
+
+private:
+
+  TextContainer * m_container;
+};
+
 TextContainer::TextContainer(
   QGraphicsWidget * parent,
   QString const &text,
@@ -20,7 +42,7 @@ TextContainer::TextContainer(
   m_highlightColor = hlColor;
   m_highlighted = false;
   
-  m_textItem = new QGraphicsSimpleTextItem(text, this);
+  m_textItem = new TextContainerTextItem(text, this);
   m_textItem->setPen(QPen(Qt::NoPen));
   m_textItem->setBrush(color);
   m_textItem->setFont(font);
@@ -42,6 +42,10 @@ namespace FabricUI
 
       QGraphicsSimpleTextItem * textItem();
 
+      // consulted each time the text is painted, so that subclasses
+      // can hide it depending on the level of detail
+      virtual bool shouldPaintText() const { return true; }
+
     protected:
 
       void refresh();
@@ -0,0 +1,316 @@
+// Copyright 2010-2015 Fabric Software Inc. All rights reserved.
+
+// Drives canvas pan and zoom gestures through the MainPanel and checks
+// that the controller persists the canvas state once per gesture, not
+// once per mouse move or wheel step.
+
+#include <QtCore/QEventLoop>
+#include <QtCore/QTimer>
+#include <QtGui/QApplication>
+#include <QtGui/QGraphicsSceneMouseEvent>
+#include <QtGui/QGraphicsSceneWheelEvent>
+
+#include <FabricUI/Tests/TestCheck.h>
+#include <FabricUI/GraphView/Controller.h>
+#include <FabricUI/GraphView/Graph.h>
+#include <FabricUI/GraphView/GraphViewWidget.h>
+#include <FabricUI/GraphView/MainPanel.h>
+
+#include <stdio.h>
+#include <vector>
+
+using namespace FabricUI;
+
+// a controller without a binding, recording each persistCanvasState call
+// in place of the metadata the DFG controller would write
+class CanvasTestController : public GraphView::Controller
+{
+public:
+
+  struct Write
+  {
+    bool zoomChanged;
+    float zoom;
+    bool panChanged;
+    QPointF pan;
+  };
+
+  CanvasTestController(GraphView::Graph * graph)
+    : GraphView::Controller(graph)
+  {}
+
+  virtual bool gvcDoRemoveNodes(FTL::ArrayRef<GraphView::Node *> nodes)
+    { return false; }
+  virtual bool gvcDoAddConnection(GraphView::ConnectionTarget * src, GraphView::ConnectionTarget * dst)
+    { return false; }
+  virtual bool gvcDoRemoveConnection(GraphView::ConnectionTarget * src, GraphView::ConnectionTarget * dst)
+    { return false; }
+  virtual bool gvcDoAddInstFromPreset(FTL::CStrRef presetPath, QPointF pos)
+    { return false; }
+  virtual void gvcDoAddPort(
+    FTL::CStrRef desiredPortName,
+    GraphView::PortType portType,
+    FTL::CStrRef typeSpec = FTL::CStrRef(),
+    GraphView::ConnectionTarget *connectWith = 0,
+    FTL::StrRef extDep = FTL::StrRef(),
+    FTL::CStrRef metaData = FTL::CStrRef()
+    )
+    {}
+  virtual void gvcDoSetNodeCommentExpanded(GraphView::Node *node, bool expanded)
+    {}
+  virtual void gvcDoMoveNodes(std::vector<GraphView::Node *> const &nodes, QPointF delta, bool allowUndo)
+    {}
+  virtual void gvcDoResizeBackDropNode(
+    GraphView::BackDropNode *backDropNode,
+    QPointF posDelta,
+    QSizeF sizeDelta,
+    bool allowUndo
+    )
+    {}
+
+  std::vector<Write> writes;
+
+protected:
+
+  // one write per changed value, as the DFG controller writes one
+  // metadata entry each
+  virtual unsigned int persistCanvasState(
+    bool zoomChanged,
+    float zoom,
+    bool panChanged,
+    QPointF pan
+    )
+  {
+    Write write;
+    write.zoomChanged = zoomChanged;
+    write.zoom = zoom;
+    write.panChanged = panChanged;
+    write.pan = pan;
+    writes.push_back(write);
+    return (zoomChanged ? 1 : 0) + (panChanged ? 1 : 0);
+  }
+};
+
+// a graph with its controller and (never shown) view, the canvas is
+// persisted after delay ms of idle time
+class CanvasTestScene
+{
+public:
+
+  CanvasTestScene(int delay)
+  {
+    GraphView::GraphConfig config;
+    config.useOpenGL = false;
+    config.canvasPersistDelay = delay;
+
+    m_graph = new GraphView::Graph(NULL, config);
+    m_controller = new CanvasTestController(m_graph);
+    m_graph->initialize();
+    m_view = new GraphView::GraphViewWidget(NULL, config, m_graph);
+
+    // the view is never shown, so it does not get resize events
+    m_view->setSceneRect(0, 0, 800, 600);
+    m_graph->setGeometry(0, 0, 800, 600);
+  }
+
+  ~CanvasTestScene()
+  {
+    QGraphicsScene * scene = m_view->scene();
+    delete m_view;
+    // the scene owns the graph
+    delete scene;
+    delete m_controller;
+  }
+
+  GraphView::Graph * graph() { return m_graph; }
+  GraphView::MainPanel * mainPanel() { return m_graph->mainPanel(); }
+  CanvasTestController * controller() { return m_controller; }
+
+private:
+
+  GraphView::Graph * m_graph;
+  CanvasTestController * m_controller;
+  GraphView::GraphViewWidget * m_view;
+};
+
+// runs the event loop, so the persist timer gets a chance to fire
+static void ProcessEventsFor(int ms)
+{
+  QEventLoop loop;
+  QTimer::singleShot(ms, &loop, SLOT(quit()));
+  loop.exec();
+}
+
+// an alt + mouse drag on the main panel, alt + left pans and alt + right
+// zooms
+static void MouseDrag(
+  GraphView::MainPanel * mainPanel,
+  CanvasTestController * controller,
+  Qt::MouseButton button,
+  int moveCount,
+  std::vector<size_t> & writesDuringDrag
+  )
+{
+  QPointF pos = mainPanel->mapToScene(mainPanel->boundingRect().center());
+  QGraphicsSceneMouseEvent press(QEvent::GraphicsSceneMousePress);
+  press.setButton(button);
+  press.setButtons(button);
+  press.setModifiers(Qt::AltModifier);
+  press.setScenePos(pos);
+  press.setLastScenePos(pos);
+  mainPanel->mousePressEvent(&press);
+
+  for(int i=0;i<moveCount;i++)
+  {
+    QGraphicsSceneMouseEvent move(QEvent::GraphicsSceneMouseMove);
+    move.setButtons(button);
+    move.setModifiers(Qt::AltModifier);
+    move.setLastScenePos(pos);
+    pos += QPointF(3, 2);
+    move.setScenePos(pos);
+    mainPanel->mouseMoveEvent(&move);
+    writesDuringDrag.push_back(controller->writes.size());
+  }
+
+  QGraphicsSceneMouseEvent release(QEvent::GraphicsSceneMouseRelease);
+  release.setButton(button);
+  release.setModifiers(Qt::AltModifier);
+  release.setScenePos(pos);
+  release.setLastScenePos(pos);
+  mainPanel->mouseReleaseEvent(&release);
+}
+
+static void TestMousePan()
+{
+  // a long delay, only the release may persist the pan
+  CanvasTestScene scene(60000);
+  CanvasTestController * controller = scene.controller();
+
+  std::vector<size_t> writesDuringDrag;
+  MouseDrag(scene.mainPanel(), controller, Qt::LeftButton, 50, writesDuringDrag);
+  for(size_t i=0;i<writesDuringDrag.size();i++)
+    FABRICUI_CHECK(writesDuringDrag[i] == 0);
+
+  FABRICUI_CHECK(controller->canvasChangeCount() == 50);
+  FABRICUI_CHECK(!controller->hasPendingCanvasState());
+  if(FABRICUI_CHECK(controller->writes.size() == 1))
+  {
+    CanvasTestController::Write const &write = controller->writes[0];
+    FABRICUI_CHECK(write.panChanged);
+    FABRICUI_CHECK(!write.zoomChanged);
+    FABRICUI_CHECK(write.pan == scene.mainPanel()->canvasPan());
+    FABRICUI_CHECK(write.pan != QPointF(0, 0));
+  }
+  FABRICUI_CHECK(controller->canvasWriteCount() == 1);
+
+  // a second gesture is persisted on its own
+  controller->resetCanvasCounters();
+  writesDuringDrag.clear();
+  MouseDrag(scene.mainPanel(), controller, Qt::LeftButton, 10, writesDuringDrag);
+  FABRICUI_CHECK(controller->writes.size() == 2);
+  FABRICUI_CHECK(controller->canvasWriteCount() == 1);
+
+  // nothing is left for the timer
+  controller->flushCanvasState();
+  FABRICUI_CHECK(controller->writes.size() == 2);
+}
+
+static void TestMouseZoom()
+{
+  CanvasTestScene scene(60000);
+  CanvasTestController * controller = scene.controller();
+
+  std::vector<size_t> writesDuringDrag;
+  MouseDrag(scene.mainPanel(), controller, Qt::RightButton, 20, writesDuringDrag);
+  for(size_t i=0;i<writesDuringDrag.size();i++)
+    FABRICUI_CHECK(writesDuringDrag[i] == 0);
+
+  // zooming about the mouse pans as well, both go out in the same write
+  if(FABRICUI_CHECK(controller->writes.size() == 1))
+  {
+    CanvasTestController::Write const &write = controller->writes[0];
+    FABRICUI_CHECK(write.zoomChanged);
+    FABRICUI_CHECK(write.panChanged);
+    FABRICUI_CHECK(write.zoom == scene.mainPanel()->canvasZoom());
+    FABRICUI_CHECK(write.zoom != 1.0f);
+  }
+  FABRICUI_CHECK(controller->canvasWriteCount() == 2);
+}
+
+static void TestWheelZoom()
+{
+  // the wheel has no release, the state is persisted once it goes idle
+  CanvasTestScene scene(20);
+  CanvasTestController * controller = scene.controller();
+  GraphView::MainPanel * mainPanel = scene.mainPanel();
+
+  QPointF pos = mainPanel->mapToScene(mainPanel->boundingRect().center());
+  for(int i=0;i<5;i++)
+  {
+    QGraphicsSceneWheelEvent wheel(QEvent::GraphicsSceneWheel);
+    wheel.setDelta(120);
+    wheel.setOrientation(Qt::Vertical);
+    wheel.setScenePos(pos);
+    mainPanel->wheelEvent(&wheel);
+  }
+  FABRICUI_CHECK(controller->writes.size() == 0);
+  FABRICUI_CHECK(controller->hasPendingCanvasState());
+
+  ProcessEventsFor(200);
+  if(FABRICUI_CHECK(controller->writes.size() == 1))
+  {
+    CanvasTestController::Write const &write = controller->writes[0];
+    FABRICUI_CHECK(write.zoomChanged);
+    FABRICUI_CHECK(write.zoom == mainPanel->canvasZoom());
+  }
+  FABRICUI_CHECK(!controller->hasPendingCanvasState());
+
+  // the timer does not fire again without further changes
+  ProcessEventsFor(100);
+  FABRICUI_CHECK(controller->writes.size() == 1);
+}
+
+static void TestFlush()
+{
+  CanvasTestScene scene(60000);
+  CanvasTestController * controller = scene.controller();
+
+  // nothing pending, nothing written
+  controller->flushCanvasState();
+  FABRICUI_CHECK(controller->writes.size() == 0);
+
+  // the last value of each kind wins
+  controller->zoomCanvas(1.5f);
+  controller->zoomCanvas(2.0f);
+  controller->panCanvas(QPointF(10, 20));
+  controller->flushCanvasState();
+  if(FABRICUI_CHECK(controller->writes.size() == 1))
+  {
+    CanvasTestController::Write const &write = controller->writes[0];
+    FABRICUI_CHECK(write.zoomChanged);
+    FABRICUI_CHECK(write.zoom == 2.0f);
+    FABRICUI_CHECK(write.panChanged);
+    FABRICUI_CHECK(write.pan == QPointF(10, 20));
+  }
+  FABRICUI_CHECK(controller->canvasChangeCount() == 3);
+  FABRICUI_CHECK(controller->canvasWriteCount() == 2);
+}
+
+int main(int argc, char ** argv)
+{
+  QApplication::setGraphicsSystem("raster");
+  QApplication app(argc, argv);
+
+  TestMousePan();
+  TestMouseZoom();
+  TestWheelZoom();
+  TestFlush();
+
+  if(FabricUI::Tests::FailureCount() > 0)
+  {
+    fprintf(stderr, "CanvasStateTest: %d checks failed\n", FabricUI::Tests::FailureCount());
+    return 1;
+  }
+  printf("CanvasStateTest: passed\n");
+  return 0;
+}
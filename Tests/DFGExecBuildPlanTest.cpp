@@ -0,0 +1,463 @@
+// Copyright 2010-2015 Fabric Software Inc. All rights reserved.
+
+// Drives DFGExecBuildPlan and DFGNotificationRouter::applyBuildPlan from
+// a fixture description and a fake DFGExecBuildSource, so no Core client
+// or binding is needed.  Plans are resolved on the GUI thread and, as
+// the router does for large descriptions, on a worker thread.
+
+#include <QtCore/QThread>
+#include <QtCore/QtConcurrentRun>
+#include <QtGui/QApplication>
+
+#include <FabricUI/Tests/TestCheck.h>
+#include <FabricUI/GraphView/Graph.h>
+#include <FabricUI/GraphView/GraphViewWidget.h>
+#include <FabricUI/GraphView/MainPanel.h>
+#include <FabricUI/GraphView/Node.h>
+#include <FabricUI/GraphView/Pin.h>
+#include <FabricUI/GraphView/SidePanel.h>
+#include <FabricUI/DFG/DFGController.h>
+#include <FabricUI/DFG/DFGExecBuildPlan.h>
+#include <FabricUI/DFG/DFGNotificationRouter.h>
+
+#include <map>
+#include <string>
+
+using namespace FabricUI;
+
+// answers the plan's queries from maps, keyed "kind/path/key"
+class FakeBuildSource : public DFG::DFGExecBuildSource
+{
+public:
+
+  FakeBuildSource()
+    : portMetadataQueryCount(0)
+    , queryThread(NULL)
+  {}
+
+  virtual FabricCore::DFGNodeType getNodeType(FTL::CStrRef nodeName)
+  {
+    queryThread = QThread::currentThread();
+    std::map<std::string, FabricCore::DFGNodeType>::const_iterator it =
+      nodeTypes.find(std::string(nodeName.data(), nodeName.size()));
+    if(it == nodeTypes.end())
+      return FabricCore::DFGNodeType_Inst;
+    return it->second;
+  }
+
+  virtual bool instExecIsPreset(FTL::CStrRef nodeName)
+  {
+    return lookup("preset", nodeName, "") == "true";
+  }
+
+  virtual std::string getRefVarPath(FTL::CStrRef nodeName)
+  {
+    return lookup("varPath", nodeName, "");
+  }
+
+  virtual std::string getNodeMetadata(FTL::CStrRef nodeName, FTL::CStrRef key)
+  {
+    return lookup("node", nodeName, key);
+  }
+
+  virtual std::string getInstExecMetadata(FTL::CStrRef nodeName, FTL::CStrRef key)
+  {
+    return lookup("instExec", nodeName, key);
+  }
+
+  virtual std::string getInstExecPortMetadata(
+    FTL::CStrRef nodeName,
+    FTL::CStrRef portName,
+    FTL::CStrRef key
+    )
+  {
+    ++portMetadataQueryCount;
+    std::string path(nodeName.data(), nodeName.size());
+    path += '.';
+    path.append(portName.data(), portName.size());
+    return lookup("instExecPort", path, key);
+  }
+
+  virtual std::string getExecPortMetadata(FTL::CStrRef portName, FTL::CStrRef key)
+  {
+    ++portMetadataQueryCount;
+    return lookup("execPort", portName, key);
+  }
+
+  // the plan takes the rest from the description
+  virtual FabricCore::DFGExecType getExecType()
+    { return FabricCore::DFGExecType_Graph; }
+  virtual std::string getInstExecTitle(FTL::CStrRef nodeName)
+    { return std::string(); }
+  virtual unsigned getExecPortCount()
+    { return 0; }
+  virtual std::string getExecPortName(unsigned index)
+    { return std::string(); }
+  virtual FabricCore::DFGPortType getExecPortType(unsigned index)
+    { return FabricCore::DFGPortType_In; }
+  virtual unsigned getInstExecPortCount(FTL::CStrRef nodeName)
+    { return 0; }
+  virtual std::string getInstExecPortName(FTL::CStrRef nodeName, unsigned index)
+    { return std::string(); }
+
+  void set(char const * kind, char const * path, char const * key, char const * value)
+  {
+    values[makeKey(kind, path, key)] = value;
+  }
+
+  std::map<std::string, FabricCore::DFGNodeType> nodeTypes;
+  std::map<std::string, std::string> values;
+  unsigned int portMetadataQueryCount;
+  // the thread of the last getNodeType call
+  QThread * queryThread;
+
+private:
+
+  static std::string makeKey(FTL::StrRef kind, FTL::StrRef path, FTL::StrRef key)
+  {
+    std::string result(kind.data(), kind.size());
+    result += '/';
+    result.append(path.data(), path.size());
+    result += '/';
+    result.append(key.data(), key.size());
+    return result;
+  }
+
+  std::string lookup(FTL::StrRef kind, FTL::StrRef path, FTL::StrRef key) const
+  {
+    std::map<std::string, std::string>::const_iterator it =
+      values.find(makeKey(kind, path, key));
+    if(it == values.end())
+      return std::string();
+    return it->second;
+  }
+};
+
+static char const * const s_graphDesc =
+  "{"
+  "\"objectType\": \"Graph\","
+  "\"ports\": ["
+  "  {\"name\": \"a\", \"execPortType\": \"In\", \"type\": \"Scalar\"},"
+  "  {\"name\": \"b\", \"execPortType\": \"Out\", \"type\": \"Custom\"},"
+  "  {\"name\": \"io\", \"execPortType\": \"IO\", \"type\": \"$TYPE$\"}"
+  "],"
+  "\"nodes\": ["
+  "  {\"name\": \"add\", \"ports\": ["
+  "    {\"name\": \"lhs\", \"nodePortType\": \"In\", \"type\": \"Scalar\"},"
+  "    {\"name\": \"rhs\", \"nodePortType\": \"In\", \"type\": \"Custom[]\"},"
+  "    {\"name\": \"result\", \"nodePortType\": \"Out\", \"type\": \"Scalar\"}"
+  "  ], \"metadata\": {\"uiGraphPos\": \"{\\\"x\\\": 10, \\\"y\\\": 20}\"}},"
+  "  {\"name\": \"preset\", \"execTitle\": \"Preset Title\", \"ports\": []},"
+  "  {\"name\": \"v\", \"ports\": ["
+  "    {\"name\": \"value\", \"nodePortType\": \"IO\", \"type\": \"Scalar\"}"
+  "  ]},"
+  "  {\"name\": \"g\", \"ports\": ["
+  "    {\"name\": \"value\", \"nodePortType\": \"Out\", \"type\": \"Scalar\"}"
+  "  ]},"
+  "  {\"name\": \"bd\", \"ports\": [],"
+  "    \"metadata\": {\"uiTitle\": \"Notes\"}}"
+  "],"
+  "\"connections\": {"
+  "  \"a\": [\"add.lhs\"],"
+  "  \"add.result\": [\"b\"]"
+  "},"
+  "\"metadata\": {\"uiGraphZoom\": \"{\\\"value\\\": 2}\"}"
+  "}";
+
+static void SetUpSource(FakeBuildSource & source)
+{
+  source.nodeTypes["add"] = FabricCore::DFGNodeType_Inst;
+  source.nodeTypes["preset"] = FabricCore::DFGNodeType_Inst;
+  source.nodeTypes["v"] = FabricCore::DFGNodeType_Var;
+  source.nodeTypes["g"] = FabricCore::DFGNodeType_Get;
+  source.nodeTypes["bd"] = FabricCore::DFGNodeType_User;
+  source.set("preset", "preset", "", "true");
+  source.set("varPath", "g", "", "v");
+  source.set("instExec", "add", "uiNodeColor", "{\"r\": 10, \"g\": 20, \"b\": 30}");
+  source.set("node", "bd", "uiNodeColor", "{\"r\": 40, \"g\": 50, \"b\": 60}");
+  source.set("execPort", "b", "uiColor", "{\"r\": 1, \"g\": 2, \"b\": 3}");
+  source.set("instExecPort", "add.rhs", "uiColor", "{\"r\": 4, \"g\": 5, \"b\": 6}");
+}
+
+static QSharedPointer<DFG::DFGExecBuildPlan> BuildPlan(
+  QSharedPointer<FakeBuildSource> source,
+  char const * desc,
+  DFG::DFGExecBuildToken token = DFG::DFGExecBuildToken()
+  )
+{
+  DFG::DFGConfig config;
+  return DFG::DFGExecBuildPlan::Build(
+    source,
+    desc,
+    config.getColorTypes(),
+    token
+    );
+}
+
+static DFG::DFGExecBuildPlan::Node const * FindNode(
+  DFG::DFGExecBuildPlan const & plan,
+  char const * name
+  )
+{
+  for(size_t i=0;i<plan.nodes().size();i++)
+  {
+    if(plan.nodes()[i].name == name)
+      return &plan.nodes()[i];
+  }
+  return NULL;
+}
+
+static void TestResolve()
+{
+  QSharedPointer<FakeBuildSource> source(new FakeBuildSource);
+  SetUpSource(*source);
+
+  QSharedPointer<DFG::DFGExecBuildPlan> plan = BuildPlan(source, s_graphDesc);
+  if(!FABRICUI_CHECK(plan))
+    return;
+
+  FABRICUI_CHECK(plan->isGraph());
+
+  // only the ports of types without a registered color are looked up
+  FABRICUI_CHECK(source->portMetadataQueryCount == 2);
+  FABRICUI_CHECK(plan->ports().size() == 3);
+  if(plan->ports().size() == 3)
+  {
+    FABRICUI_CHECK(plan->ports()[0].name == "a");
+    FABRICUI_CHECK(plan->ports()[0].portType == "In");
+    FABRICUI_CHECK(plan->ports()[0].uiColor.empty());
+    FABRICUI_CHECK(plan->ports()[1].uiColor == "{\"r\": 1, \"g\": 2, \"b\": 3}");
+    FABRICUI_CHECK(plan->ports()[2].uiColor.empty());
+  }
+
+  FABRICUI_CHECK(plan->nodes().size() == 5);
+
+  DFG::DFGExecBuildPlan::Node const * add = FindNode(*plan, "add");
+  if(FABRICUI_CHECK(add))
+  {
+    FABRICUI_CHECK(add->type == FabricCore::DFGNodeType_Inst);
+    FABRICUI_CHECK(add->title == "add");
+    FABRICUI_CHECK(add->titleSuffixAsterisk);
+    FABRICUI_CHECK(add->pins.size() == 3);
+    if(add->pins.size() == 3)
+    {
+      FABRICUI_CHECK(add->pins[1].name == "rhs");
+      FABRICUI_CHECK(add->pins[1].dataType == "Custom[]");
+      FABRICUI_CHECK(add->pins[1].uiColor == "{\"r\": 4, \"g\": 5, \"b\": 6}");
+      FABRICUI_CHECK(add->pins[2].portType == "Out");
+    }
+    // the inst exec's metadata comes before the node's own
+    FABRICUI_CHECK(add->metadata.size() == 2);
+    if(add->metadata.size() == 2)
+    {
+      FABRICUI_CHECK(add->metadata[0].key == "uiNodeColor");
+      FABRICUI_CHECK(add->metadata[1].key == "uiGraphPos");
+    }
+  }
+
+  DFG::DFGExecBuildPlan::Node const * preset = FindNode(*plan, "preset");
+  if(FABRICUI_CHECK(preset))
+  {
+    FABRICUI_CHECK(preset->title == "Preset Title");
+    FABRICUI_CHECK(!preset->titleSuffixAsterisk);
+  }
+
+  DFG::DFGExecBuildPlan::Node const * v = FindNode(*plan, "v");
+  if(FABRICUI_CHECK(v))
+    FABRICUI_CHECK(v->title == "v");
+
+  DFG::DFGExecBuildPlan::Node const * g = FindNode(*plan, "g");
+  if(FABRICUI_CHECK(g))
+    FABRICUI_CHECK(g->title == "get v");
+
+  DFG::DFGExecBuildPlan::Node const * bd = FindNode(*plan, "bd");
+  if(FABRICUI_CHECK(bd))
+  {
+    FABRICUI_CHECK(bd->type == FabricCore::DFGNodeType_User);
+    FABRICUI_CHECK(bd->metadata.size() == 2);
+    if(bd->metadata.size() == 2)
+    {
+      FABRICUI_CHECK(bd->metadata[0].key == "uiNodeColor");
+      FABRICUI_CHECK(bd->metadata[1].key == "uiTitle");
+    }
+  }
+
+  FABRICUI_CHECK(plan->connections().size() == 2);
+  for(size_t i=0;i<plan->connections().size();i++)
+  {
+    DFG::DFGExecBuildPlan::Connection const & connection =
+      plan->connections()[i];
+    FABRICUI_CHECK(
+      (connection.srcPath == "a" && connection.dstPath == "add.lhs")
+      || (connection.srcPath == "add.result" && connection.dstPath == "b")
+      );
+  }
+
+  FABRICUI_CHECK(plan->metadata().size() == 1);
+  if(plan->metadata().size() == 1)
+    FABRICUI_CHECK(plan->metadata()[0].key == "uiGraphZoom");
+}
+
+static void TestFunc()
+{
+  QSharedPointer<FakeBuildSource> source(new FakeBuildSource);
+  QSharedPointer<DFG::DFGExecBuildPlan> plan = BuildPlan(
+    source,
+    "{\"objectType\": \"Func\", \"ports\": ["
+    "{\"name\": \"x\", \"execPortType\": \"In\", \"type\": \"Scalar\"}]}"
+    );
+  if(!FABRICUI_CHECK(plan))
+    return;
+  FABRICUI_CHECK(!plan->isGraph());
+  FABRICUI_CHECK(plan->ports().size() == 1);
+  FABRICUI_CHECK(plan->nodes().empty());
+  FABRICUI_CHECK(plan->connections().empty());
+}
+
+static void TestFailures()
+{
+  QSharedPointer<FakeBuildSource> source(new FakeBuildSource);
+  SetUpSource(*source);
+
+  // malformed descriptions give no plan
+  FABRICUI_CHECK(!BuildPlan(source, "{\"objectType\": \"Graph\", \"ports\": ["));
+
+  // neither do cancelled ones
+  DFG::DFGExecBuildToken token;
+  token.cancel();
+  FABRICUI_CHECK(!BuildPlan(source, s_graphDesc, token));
+}
+
+static void TestWorkerThread()
+{
+  QSharedPointer<FakeBuildSource> source(new FakeBuildSource);
+  SetUpSource(*source);
+
+  // the router's call for descriptions over the async threshold
+  DFG::DFGConfig config;
+  QFuture< QSharedPointer<DFG::DFGExecBuildPlan> > future =
+    QtConcurrent::run(
+      &DFG::DFGExecBuildPlan::Build,
+      QSharedPointer<DFG::DFGExecBuildSource>(source),
+      std::string(s_graphDesc),
+      config.getColorTypes(),
+      DFG::DFGExecBuildToken()
+      );
+  QSharedPointer<DFG::DFGExecBuildPlan> plan = future.result();
+  if(!FABRICUI_CHECK(plan))
+    return;
+
+  FABRICUI_CHECK(source->queryThread != NULL);
+  FABRICUI_CHECK(source->queryThread != QThread::currentThread());
+  FABRICUI_CHECK(plan->nodes().size() == 5);
+  FABRICUI_CHECK(plan->connections().size() == 2);
+
+  // a plan cancelled while it is being resolved gives no plan
+  DFG::DFGExecBuildToken token;
+  token.cancel();
+  future = QtConcurrent::run(
+    &DFG::DFGExecBuildPlan::Build,
+    QSharedPointer<DFG::DFGExecBuildSource>(source),
+    std::string(s_graphDesc),
+    config.getColorTypes(),
+    token
+    );
+  FABRICUI_CHECK(!future.result());
+}
+
+static void TestApply()
+{
+  QSharedPointer<FakeBuildSource> source(new FakeBuildSource);
+  SetUpSource(*source);
+  QSharedPointer<DFG::DFGExecBuildPlan> plan = BuildPlan(source, s_graphDesc);
+  if(!FABRICUI_CHECK(plan))
+    return;
+
+  DFG::DFGConfig config;
+  config.graphConfig.useOpenGL = false;
+
+  // a controller without a binding or exec, the plan needs neither
+  GraphView::Graph * graph = new GraphView::Graph(NULL, config.graphConfig);
+  FabricCore::Client client;
+  DFG::DFGController * controller =
+    new DFG::DFGController(graph, NULL, client, NULL, NULL, false);
+  graph->initialize();
+  // the canvas zoom is applied through the (never shown) view
+  GraphView::GraphViewWidget * view =
+    new GraphView::GraphViewWidget(NULL, config.graphConfig, graph);
+  DFG::DFGNotificationRouter * router =
+    new DFG::DFGNotificationRouter(controller, config);
+
+  router->applyBuildPlan(*plan);
+
+  FABRICUI_CHECK(graph->nodes().size() == 5);
+
+  // a is an input of the exec, so it feeds the graph from the left
+  GraphView::SidePanel * outputPanel = graph->sidePanel(GraphView::PortType_Output);
+  GraphView::SidePanel * inputPanel = graph->sidePanel(GraphView::PortType_Input);
+  if(FABRICUI_CHECK(outputPanel && inputPanel))
+  {
+    FABRICUI_CHECK(outputPanel->portCount() == 2);
+    FABRICUI_CHECK(inputPanel->portCount() == 2);
+    GraphView::Port * b = inputPanel->port("b");
+    if(FABRICUI_CHECK(b))
+      FABRICUI_CHECK(b->color() == QColor(1, 2, 3));
+  }
+
+  // a -> add.lhs, add.result -> b, and io passing through
+  FABRICUI_CHECK(graph->connections().size() == 3);
+
+  GraphView::Node * add = graph->node("add");
+  if(FABRICUI_CHECK(add))
+  {
+    FABRICUI_CHECK(add->pinCount() == 3);
+    FABRICUI_CHECK(add->topLeftGraphPos() == QPointF(10, 20));
+    GraphView::Pin * lhs = add->pin("lhs");
+    if(FABRICUI_CHECK(lhs))
+      FABRICUI_CHECK(lhs->color() == config.getColorForDataType("Scalar"));
+    GraphView::Pin * rhs = add->pin("rhs");
+    if(FABRICUI_CHECK(rhs))
+      FABRICUI_CHECK(rhs->color() == QColor(4, 5, 6));
+  }
+
+  GraphView::Node * preset = graph->node("preset");
+  if(FABRICUI_CHECK(preset))
+    FABRICUI_CHECK(preset->title() == "Preset Title");
+
+  GraphView::Node * g = graph->node("g");
+  if(FABRICUI_CHECK(g))
+    FABRICUI_CHECK(g->title() == "get v");
+
+  GraphView::Node * bd = graph->node("bd");
+  if(FABRICUI_CHECK(bd))
+    FABRICUI_CHECK(bd->isBackDropNode());
+
+  FABRICUI_CHECK(graph->mainPanel()->canvasZoom() == 2.0f);
+
+  delete router;
+  QGraphicsScene * scene = view->scene();
+  delete view;
+  // the scene owns the graph
+  delete scene;
+  delete controller;
+}
+
+int main(int argc, char ** argv)
+{
+  QApplication::setGraphicsSystem("raster");
+  QApplication app(argc, argv);
+
+  TestResolve();
+  TestFunc();
+  TestFailures();
+  TestWorkerThread();
+  TestApply();
+
+  if(FabricUI::Tests::FailureCount() > 0)
+  {
+    fprintf(stderr, "DFGExecBuildPlanTest: %d checks failed\n", FabricUI::Tests::FailureCount());
+    return 1;
+  }
+  printf("DFGExecBuildPlanTest: passed\n");
+  return 0;
+}
@@ -0,0 +1,280 @@
+// Copyright 2010-2015 Fabric Software Inc. All rights reserved.
+
+// Records notifications handled by a DFGNotificationRouter answering from
+// a scripted DFGExecBuildSource, then plays the recording back with
+// DFGNotificationPlayer into a second router that has nothing but the
+// recording, and checks that both build the same graph.  No Core client
+// or binding is needed.
+
+#include <QtCore/QDir>
+#include <QtCore/QFile>
+#include <QtGui/QApplication>
+
+#include <FabricUI/Tests/TestCheck.h>
+#include <FabricUI/GraphView/Graph.h>
+#include <FabricUI/GraphView/GraphViewWidget.h>
+#include <FabricUI/GraphView/Node.h>
+#include <FabricUI/GraphView/Port.h>
+#include <FabricUI/GraphView/SidePanel.h>
+#include <FabricUI/DFG/DFGController.h>
+#include <FabricUI/DFG/DFGNotificationPlayer.h>
+#include <FabricUI/DFG/DFGNotificationRecorder.h>
+#include <FabricUI/DFG/DFGNotificationRouter.h>
+
+#include <map>
+#include <set>
+#include <string>
+#include <string.h>
+
+using namespace FabricUI;
+
+// answers the router's queries from maps the test edits as it goes, the
+// way the exec would change under the notifications
+class ScriptedSource : public DFG::DFGExecBuildSource
+{
+public:
+
+  virtual FabricCore::DFGExecType getExecType()
+    { return FabricCore::DFGExecType_Graph; }
+
+  virtual FabricCore::DFGNodeType getNodeType(FTL::CStrRef nodeName)
+  {
+    std::map<std::string, FabricCore::DFGNodeType>::const_iterator it =
+      nodeTypes.find(std::string(nodeName.data(), nodeName.size()));
+    if(it == nodeTypes.end())
+      return FabricCore::DFGNodeType_User;
+    return it->second;
+  }
+
+  virtual bool instExecIsPreset(FTL::CStrRef nodeName)
+    { return presets.count(std::string(nodeName.data(), nodeName.size())) > 0; }
+  virtual std::string getRefVarPath(FTL::CStrRef nodeName)
+    { return std::string(); }
+  virtual std::string getNodeMetadata(FTL::CStrRef nodeName, FTL::CStrRef key)
+    { return std::string(); }
+  virtual std::string getInstExecMetadata(FTL::CStrRef nodeName, FTL::CStrRef key)
+    { return std::string(); }
+  virtual std::string getInstExecPortMetadata(
+    FTL::CStrRef nodeName,
+    FTL::CStrRef portName,
+    FTL::CStrRef key
+    )
+    { return std::string(); }
+
+  virtual std::string getExecPortMetadata(FTL::CStrRef portName, FTL::CStrRef key)
+  {
+    if(portName == FTL_STR("b") && key == FTL_STR("uiColor"))
+      return "{\"r\": 1, \"g\": 2, \"b\": 3}";
+    return std::string();
+  }
+
+  virtual std::string getInstExecTitle(FTL::CStrRef nodeName)
+    { return "Preset Title"; }
+  virtual unsigned getExecPortCount()
+    { return 0; }
+  virtual std::string getExecPortName(unsigned index)
+    { return std::string(); }
+  virtual FabricCore::DFGPortType getExecPortType(unsigned index)
+    { return FabricCore::DFGPortType_In; }
+  virtual unsigned getInstExecPortCount(FTL::CStrRef nodeName)
+    { return 0; }
+  virtual std::string getInstExecPortName(FTL::CStrRef nodeName, unsigned index)
+    { return std::string(); }
+
+  std::map<std::string, FabricCore::DFGNodeType> nodeTypes;
+  std::set<std::string> presets;
+};
+
+static char const * const s_graphDesc =
+  "{"
+  "\"objectType\": \"Graph\","
+  "\"ports\": ["
+  "  {\"name\": \"a\", \"execPortType\": \"In\", \"type\": \"Scalar\"},"
+  "  {\"name\": \"b\", \"execPortType\": \"Out\", \"type\": \"Custom\"}"
+  "],"
+  "\"nodes\": ["
+  "  {\"name\": \"add\", \"ports\": ["
+  "    {\"name\": \"lhs\", \"nodePortType\": \"In\", \"type\": \"Scalar\"},"
+  "    {\"name\": \"result\", \"nodePortType\": \"Out\", \"type\": \"Scalar\"}"
+  "  ]}"
+  "],"
+  "\"connections\": {"
+  "  \"a\": [\"add.lhs\"]"
+  "}"
+  "}";
+
+// a graph with its DFG controller, (never shown) view and router, with
+// neither binding nor exec
+class ReplayTestScene
+{
+public:
+
+  ReplayTestScene(DFG::DFGNotificationRecorder * recorder)
+  {
+    DFG::DFGConfig config;
+    config.graphConfig.useOpenGL = false;
+
+    m_graph = new GraphView::Graph(NULL, config.graphConfig);
+    m_controller =
+      new DFG::DFGController(m_graph, NULL, m_client, NULL, NULL, false);
+    m_graph->initialize();
+    // the canvas zoom is applied through the view
+    m_view = new GraphView::GraphViewWidget(NULL, config.graphConfig, m_graph);
+    m_controller->setNotificationRecorder(recorder);
+    m_router = new DFG::DFGNotificationRouter(m_controller, config);
+  }
+
+  ~ReplayTestScene()
+  {
+    delete m_router;
+    QGraphicsScene * scene = m_view->scene();
+    delete m_view;
+    // the scene owns the graph
+    delete scene;
+    delete m_controller;
+  }
+
+  GraphView::Graph * graph() { return m_graph; }
+  DFG::DFGNotificationRouter * router() { return m_router; }
+
+private:
+
+  FabricCore::Client m_client;
+  GraphView::Graph * m_graph;
+  DFG::DFGController * m_controller;
+  GraphView::GraphViewWidget * m_view;
+  DFG::DFGNotificationRouter * m_router;
+};
+
+// what the core callback does with a notification
+static void Notify(
+  DFG::DFGNotificationRecorder & recorder,
+  DFG::DFGNotificationRouter * router,
+  char const * json
+  )
+{
+  recorder.record(json);
+  router->replayNotification(json);
+}
+
+static std::string TempPath(char const * name)
+{
+  return QDir::temp().filePath(name).toLocal8Bit().constData();
+}
+
+// the node's title as shown, with its suffix
+static std::string FullTitle(GraphView::Graph * graph, char const * nodeName)
+{
+  GraphView::Node * node = graph->node(nodeName);
+  if(!node)
+    return std::string();
+  FTL::CStrRef title = node->title();
+  FTL::CStrRef suffix = node->titleSuffix();
+  return std::string(title.data(), title.size())
+    + std::string(suffix.data(), suffix.size());
+}
+
+static void CheckGraph(GraphView::Graph * graph)
+{
+  FABRICUI_CHECK(graph->nodes().size() == 2);
+  FABRICUI_CHECK(!graph->node("add"));
+  FABRICUI_CHECK(FullTitle(graph, "sum") == "sum *");
+  // inserted as a preset, then split from it
+  FABRICUI_CHECK(FullTitle(graph, "preset") == "preset *");
+  // a -> sum.lhs, a -> preset.x
+  FABRICUI_CHECK(graph->connections().size() == 2);
+
+  GraphView::SidePanel * inputPanel = graph->sidePanel(GraphView::PortType_Input);
+  if(FABRICUI_CHECK(inputPanel))
+  {
+    GraphView::Port * b = inputPanel->port("b");
+    if(FABRICUI_CHECK(b))
+      FABRICUI_CHECK(b->color() == QColor(1, 2, 3));
+  }
+}
+
+static void TestRoundTrip()
+{
+  std::string recordingPath = TempPath("DFGNotificationReplayTest.txt");
+  std::string replayPath = TempPath("DFGNotificationReplayTest.replay.txt");
+
+  DFG::DFGNotificationRecorder recorder;
+  if(!FABRICUI_CHECK(recorder.open(recordingPath.c_str())))
+    return;
+
+  {
+    ReplayTestScene scene(&recorder);
+    DFG::DFGNotificationRouter * router = scene.router();
+
+    QSharedPointer<ScriptedSource> source(new ScriptedSource);
+    source->nodeTypes["add"] = FabricCore::DFGNodeType_Inst;
+    source->nodeTypes["sum"] = FabricCore::DFGNodeType_Inst;
+    source->nodeTypes["preset"] = FabricCore::DFGNodeType_Inst;
+    source->presets.insert("preset");
+    router->setExecSource(source);
+    router->buildGraphFromDesc(s_graphDesc);
+
+    Notify(recorder, router,
+      "{\"desc\": \"nodeInserted\", \"nodeName\": \"preset\", \"nodeDesc\": {"
+      "\"name\": \"preset\", \"execTitle\": \"Preset Title\", \"ports\": ["
+      "{\"name\": \"x\", \"nodePortType\": \"In\", \"type\": \"Scalar\"}]}}"
+      );
+    Notify(recorder, router,
+      "{\"desc\": \"portsConnected\", \"srcPath\": \"a\", \"dstPath\": \"preset.x\"}"
+      );
+    router->flushNotifications();
+    FABRICUI_CHECK(FullTitle(scene.graph(), "preset") == "Preset Title");
+
+    // the same query answers differently once the exec changed
+    source->presets.erase("preset");
+    Notify(recorder, router,
+      "{\"desc\": \"instExecEditWouldSplitFromPresetMayHaveChanged\", \"instName\": \"preset\"}"
+      );
+    Notify(recorder, router,
+      "{\"desc\": \"nodeRenamed\", \"oldNodeName\": \"add\", \"newNodeName\": \"sum\"}"
+      );
+    router->flushNotifications();
+
+    CheckGraph(scene.graph());
+  }
+  recorder.close();
+
+  DFG::DFGNotificationPlayer player;
+  if(!FABRICUI_CHECK(player.load(recordingPath.c_str())))
+    return;
+  FABRICUI_CHECK(player.notifications().size() == 4);
+  FABRICUI_CHECK(player.execPaths().size() == 1);
+
+  // the replaying controller has a recorder too, which must get nothing
+  // but the exec the router starts on
+  DFG::DFGNotificationRecorder replayRecorder;
+  if(!FABRICUI_CHECK(replayRecorder.open(replayPath.c_str())))
+    return;
+  {
+    ReplayTestScene scene(&replayRecorder);
+    player.replay(scene.router());
+    FABRICUI_CHECK(!scene.router()->isReplaying());
+    CheckGraph(scene.graph());
+  }
+  replayRecorder.close();
+  FABRICUI_CHECK(QFile(replayPath.c_str()).size() == qint64(strlen("# exec \n")));
+
+  QFile::remove(recordingPath.c_str());
+  QFile::remove(replayPath.c_str());
+}
+
+int main(int argc, char ** argv)
+{
+  QApplication::setGraphicsSystem("raster");
+  QApplication app(argc, argv);
+
+  TestRoundTrip();
+
+  if(FabricUI::Tests::FailureCount() > 0)
+  {
+    fprintf(stderr, "DFGNotificationReplayTest: %d checks failed\n", FabricUI::Tests::FailureCount());
+    return 1;
+  }
+  printf("DFGNotificationReplayTest: passed\n");
+  return 0;
+}
@@ -0,0 +1,43 @@
+// Copyright 2010-2015 Fabric Software Inc. All rights reserved.
+
+#ifndef __UI_Tests_TestCheck__
+#define __UI_Tests_TestCheck__
+
+#include <stdio.h>
+
+namespace FabricUI
+{
+
+  namespace Tests
+  {
+
+    // the number of failed checks so far, the test's exit code
+    inline int &FailureCount()
+    {
+      static int failureCount = 0;
+      return failureCount;
+    }
+
+    inline bool Check(
+      bool condition,
+      char const *expr,
+      char const *file,
+      int line
+      )
+    {
+      if(!condition)
+      {
+        fprintf(stderr, "%s:%d: check failed: %s\n", file, line, expr);
+        ++FailureCount();
+      }
+      return condition;
+    }
+
+  };
+
+};
+
+#define FABRICUI_CHECK(condition) \
+  FabricUI::Tests::Check((condition), #condition, __FILE__, __LINE__)
+
+#endif // __UI_Tests_TestCheck__
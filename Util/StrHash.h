@@ -0,0 +1,30 @@
+/*
+ *  Copyright 2010-2015 Fabric Software Inc. All rights reserved.
+ */
+
+#ifndef _FABRICUI_UTIL_STRHASH_H
+#define _FABRICUI_UTIL_STRHASH_H
+
+#include <FTL/StrRef.h>
+
+#include <stdint.h>
+
+namespace FabricUI
+{
+  namespace Util
+  {
+    // FNV-1a, shared by the string keyed hash tables and caches
+    inline uint32_t HashStr( FTL::StrRef str )
+    {
+      uint32_t hash = 2166136261u;
+      for ( size_t i = 0; i < str.size(); ++i )
+      {
+        hash ^= uint8_t( str.data()[i] );
+        hash *= 16777619u;
+      }
+      return hash;
+    }
+  }
+}
+
+#endif //_FABRICUI_UTIL_STRHASH_H